@@ -1,7 +1,30 @@
 #include "assignment5.hpp"
+#include "benchmarks.hpp"
+#include "course_stream.hpp"
+#include "embedded_program.hpp"
+#include "flight_simulation.hpp"
+#include "frustum_culling.hpp"
+#include "frame_constants.hpp"
+#include "instanced_batch.hpp"
 #include "interpolation.hpp"
-
-#include "parametric_shapes.hpp"
+#include "lod.hpp"
+
+#include "mesh_builder.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_optimizer.hpp"
+#include "mesh_upload.hpp"
+#include "procedural_shapes.hpp"
+#include "profiler.hpp"
+#include "render_queue.hpp"
+#include "replay.hpp"
+#include "ring_collision.hpp"
+#include "skybox.hpp"
+#include "swept_tube.hpp"
+#include "texture_compression.hpp"
+#include "texture_loader.hpp"
+#include "thread_pool.hpp"
+#include "uniform_cache.hpp"
+#include "vertex_format.hpp"
 
 #include "config.hpp"
 #include "core/Bonobo.h"
@@ -14,10 +37,19 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <tinyfiledialogs.h>
+#include <algorithm>
+#include <chrono>
 #include <clocale>
+#include <cstdio>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 
 #include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 edaf80::Assignment5::Assignment5(WindowManager& windowManager) :
 	mCamera(0.5f * glm::half_pi<float>(),
@@ -41,8 +73,18 @@ edaf80::Assignment5::~Assignment5()
 }
 
 void
-edaf80::Assignment5::run()
+edaf80::Assignment5::run(run_options const& options)
 {
+	auto const run_start = std::chrono::high_resolution_clock::now();
+
+	auto replay_input = replay::recording();
+	auto const is_replaying = !options.replay_path.empty();
+	if (is_replaying && !replay::load(options.replay_path, replay_input))
+		return;
+	std::size_t replay_tick = 0u;
+	auto recorded_input = replay::recording();
+	auto frame_timings = std::vector<replay::frame_timing>();
+
 	// Set up the camera
 	mCamera.mWorld.SetTranslate(glm::vec3(0.0f, 0.0f, 6.0f));
 	mCamera.mMouseSensitivity = 0.003f;
@@ -88,14 +130,6 @@ edaf80::Assignment5::run()
 
 
 
-	GLuint Skybox_shader = 0u;
-	program_manager.CreateAndRegisterProgram("skybox",
-		{ { ShaderType::vertex, "EDAF80/skybox.vert" },
-		  { ShaderType::fragment, "EDAF80/skybox.frag" } },
-		Skybox_shader);
-	if (Skybox_shader == 0u)
-		LogError("Failed to load skybox shader");
-
 	GLuint phong_shader = 0u;
 	program_manager.CreateAndRegisterProgram("phong",
 		{ { ShaderType::vertex, "EDAF80/phong.vert" },
@@ -106,9 +140,26 @@ edaf80::Assignment5::run()
 
 
 
+	// Uniform locations are only looked up once per program; programs
+	// declaring the FrameConstants block read those values from a
+	// uniform buffer updated once per frame instead.
+	UniformCache uniforms;
+	auto const use_normal_mapping_uniform = uniforms.declare("use_normal_mapping");
+	auto const light_position_uniform = uniforms.declare("light_position");
+	auto const camera_position_uniform = uniforms.declare("camera_position");
+	auto const ambient_uniform = uniforms.declare("ambient");
+	auto const diffuse_uniform = uniforms.declare("diffuse");
+	auto const specular_uniform = uniforms.declare("specular");
+	auto const shininess_uniform = uniforms.declare("shininess");
+	auto const frame_constants_block = uniforms.declare_block(frame_constants::block_name, frame_constants::binding);
+	auto const procedural_uniforms = procedural_shapes::declare_uniforms(uniforms);
+	UniformBuffer frame_constants_buffer(frame_constants::binding, sizeof(frame_constants));
+
 	auto light_position = glm::vec3(-2.0f, 4.0f, 2.0f);
-	auto const set_uniforms = [&light_position](GLuint program) {
-		glUniform3fv(glGetUniformLocation(program, "light_position"), 1, glm::value_ptr(light_position));
+	auto const set_uniforms = [&uniforms, light_position_uniform, frame_constants_block, &light_position](GLuint program) {
+		if (uniforms.bind_block(program, frame_constants_block))
+			return;
+		glUniform3fv(uniforms.get_location(program, light_position_uniform), 1, glm::value_ptr(light_position));
 	};
 
 	bool use_normal_mapping = false;
@@ -118,37 +169,91 @@ edaf80::Assignment5::run()
 	auto diffuse = glm::vec3(0.7f, 0.2f, 0.4f);
 	auto specular = glm::vec3(1.0f, 1.0f, 1.0f);
 	auto shininess = 10.0f;
-	auto const phong_set_uniforms = [&use_normal_mapping, &light_position, &camera_position, &ambient, &diffuse, &specular, &shininess](GLuint program) {
-		glUniform1i(glGetUniformLocation(program, "use_normal_mapping"), use_normal_mapping ? 1 : 0);
-		glUniform3fv(glGetUniformLocation(program, "light_position"), 1, glm::value_ptr(light_position));
-		glUniform3fv(glGetUniformLocation(program, "camera_position"), 1, glm::value_ptr(camera_position));
-		glUniform3fv(glGetUniformLocation(program, "ambient"), 1, glm::value_ptr(ambient));
-		glUniform3fv(glGetUniformLocation(program, "diffuse"), 1, glm::value_ptr(diffuse));
-		glUniform3fv(glGetUniformLocation(program, "specular"), 1, glm::value_ptr(specular));
-		glUniform1f(glGetUniformLocation(program, "shininess"), shininess);
+	auto const phong_set_uniforms = [&](GLuint program) {
+		if (uniforms.bind_block(program, frame_constants_block))
+			return;
+		glUniform1i(uniforms.get_location(program, use_normal_mapping_uniform), use_normal_mapping ? 1 : 0);
+		glUniform3fv(uniforms.get_location(program, light_position_uniform), 1, glm::value_ptr(light_position));
+		glUniform3fv(uniforms.get_location(program, camera_position_uniform), 1, glm::value_ptr(camera_position));
+		glUniform3fv(uniforms.get_location(program, ambient_uniform), 1, glm::value_ptr(ambient));
+		glUniform3fv(uniforms.get_location(program, diffuse_uniform), 1, glm::value_ptr(diffuse));
+		glUniform3fv(uniforms.get_location(program, specular_uniform), 1, glm::value_ptr(specular));
+		glUniform1f(uniforms.get_location(program, shininess_uniform), shininess);
 	};
 
-	std::string texture_path = config::resources_path("textures/");
-	auto demo_diffuse_texture = bonobo::loadTexture2D(texture_path + "cobblestone_floor_08_diff_2k.jpg");
-	auto demo_specular_map = bonobo::loadTexture2D(texture_path + "cobblestone_floor_08_rough_2k.jpg");
-	auto demo_normal_map = bonobo::loadTexture2D(texture_path + "cobblestone_floor_08_nor_2k.jpg");
+	// The images are decoded in the background while the rest is set up,
+	// and uploaded by the render loop; placeholders are shown until then.
+	ThreadPool texture_decoders;
+	TextureLoader textures(options.synchronous_textures ? nullptr : &texture_decoders);
+	// The KTX files written by --compress-textures are used instead of
+	// the JPEGs when present.
+	auto const image_path = [](std::string const& path) {
+		return texture_compression::find_compressed(config::resources_path(path));
+	};
+	auto demo_diffuse_texture = textures.load_2d(image_path("textures/cobblestone_floor_08_diff_2k.jpg"));
+	auto demo_specular_map = textures.load_2d(image_path("textures/cobblestone_floor_08_rough_2k.jpg"));
+	auto demo_normal_map = textures.load_2d(image_path("textures/cobblestone_floor_08_nor_2k.jpg"),
+	                                        glm::vec4(0.5f, 0.5f, 1.0f, 1.0f));
+	auto skybox_cubemap_id = textures.load_cube_map(image_path("cubemaps/LarnacaCastle/posx.jpg"),
+		image_path("cubemaps/LarnacaCastle/negx.jpg"),
+		image_path("cubemaps/LarnacaCastle/posy.jpg"),
+		image_path("cubemaps/LarnacaCastle/negy.jpg"),
+		image_path("cubemaps/LarnacaCastle/posz.jpg"),
+		image_path("cubemaps/LarnacaCastle/negz.jpg"));
 
 	//
 	// Set up the two spheres used.
 	//
-	auto skybox_shape = parametric_shapes::createSphere(200.0f, 100u, 100u);
-	if (skybox_shape.vao == 0u) {
-		LogError("Failed to retrieve the mesh for the skybox");
-		return;
-	}
+	// The meshes are looked up in the on-disk cache first; they only get
+	// generated, or parsed, on a cold start.
+	auto const meshes_setup_start = std::chrono::high_resolution_clock::now();
+	// Kept next to the resources, like the compressed textures, so that it
+	// does not depend on where the program is started from.
+	MeshCache mesh_cache(config::resources_path("mesh_cache"));
+	auto const get_cached_mesh = [&mesh_cache](std::string const& key, std::function<bonobo::mesh_data (mesh_upload::mesh_format&)> const& create,
+	                                           mesh_upload::mesh_format* format = nullptr) {
+		auto formats = std::vector<mesh_upload::mesh_format>();
+		auto const meshes = mesh_cache.get_or_create(key, [&create](std::vector<mesh_upload::mesh_format>& created_formats) {
+			created_formats.resize(1u);
+			return std::vector<bonobo::mesh_data>{ create(created_formats.front()) };
+		}, &formats);
+		if (format != nullptr && !formats.empty())
+			*format = formats.front();
+		return meshes.empty() ? bonobo::mesh_data() : meshes.front();
+	};
 
-	auto torus_shape = parametric_shapes::createTorus(2, 1, 100, 100);
-	if (torus_shape.vao == 0u)
-	{
-		LogError("Failed to retrive mesh for torus");
+	// The skybox is a single triangle covering the screen, drawn on the
+	// far plane once everything else is; neither it nor the tori have
+	// vertex or index buffers, only an empty VAO.
+	auto const skybox_shape = skybox::make_mesh();
+	GLuint const skybox_shader = embedded_program::create("Skybox", skybox::vertex_shader, skybox::fragment_shader);
+	if (skybox_shader == 0u)
+		LogError("Failed to load the skybox shader");
+
+	// The tori are generated by the vertex shader out of their
+	// dimensions and split counts, with a chain of levels of detail from
+	// 100x100 splits down to 11x11 ones.
+	lod::chain torus_lod;
+	auto torus_shapes = std::vector<procedural_shapes::shape>();
+	torus_lod.bounding_radius = 2.0f + 1.0f;
+	for (auto const split_count : lod::halve_split_counts(100u)) {
+		torus_shapes.push_back(procedural_shapes::make_torus(2.0f, 1.0f, split_count, split_count));
+		torus_lod.formats.emplace_back();
+		torus_lod.levels.push_back(procedural_shapes::make_mesh(torus_shapes.back(), &torus_lod.formats.back()));
+		torus_lod.triangles_nb.push_back(procedural_shapes::get_triangles_nb(torus_shapes.back()));
 	}
 
-	auto paper_plane_shape = bonobo::loadObjects(config::resources_path("models/paper_airplane.obj"));
+	auto const paper_plane_path = config::resources_path("models/paper_airplane.obj");
+	auto paper_plane_shape = mesh_cache.get_or_create(MeshCache::make_file_key("loadObjects", paper_plane_path),
+	                                                  [&paper_plane_path](std::vector<mesh_upload::mesh_format>& formats) {
+		auto shapes = bonobo::loadObjects(paper_plane_path);
+		formats.resize(shapes.size());
+		for (std::size_t i = 0u; i < shapes.size(); ++i) {
+			mesh_optimizer::optimize(shapes[i], "Paper airplane");
+			formats[i].bounds = mesh_upload::read_bounds(shapes[i]);
+		}
+		return shapes;
+	});
 
 	if (paper_plane_shape.empty())
 	{
@@ -156,26 +261,35 @@ edaf80::Assignment5::run()
 		return;
 	}
 
-	Node ship;
+	// Everything in the scene is drawn through a render queue: opaque
+	// items front to back, so that hidden fragments fail the depth test
+	// before being shaded, and the skybox last.
+	RenderQueue render_queue;
+	RenderItem ship;
 	auto const& plane_front = paper_plane_shape.front();
 
-	Node skybox;
-	Node Tori[9];
-
+	RenderItem skybox_item;
 
 
-	auto skybox_cubemap_id = bonobo::loadTextureCubeMap(config::resources_path("cubemaps/LarnacaCastle/posx.jpg"),
-		config::resources_path("cubemaps/LarnacaCastle/negx.jpg"),
-		config::resources_path("cubemaps/LarnacaCastle/posy.jpg"),
-		config::resources_path("cubemaps/LarnacaCastle/negy.jpg"),
-		config::resources_path("cubemaps/LarnacaCastle/posz.jpg"),
-		config::resources_path("cubemaps/LarnacaCastle/negz.jpg"));
 
-	skybox.set_geometry(skybox_shape);
-	skybox.set_program(&Skybox_shader, set_uniforms);
-	skybox.add_texture("skybox_cube_map", skybox_cubemap_id, GL_TEXTURE_CUBE_MAP);
+	skybox_item.set_name("skybox");
+	skybox_item.set_geometry(skybox_shape);
+	skybox_item.set_program(&skybox_shader);
+	skybox_item.add_texture("skybox_cube_map", skybox_cubemap_id, GL_TEXTURE_CUBE_MAP);
+	skybox_item.set_pass(RenderItem::pass::background);
 
-	ship.set_geometry(parametric_shapes::createSphere(0.0005f, 10u, 10u));
+	ship.set_name("ship");
+	mesh_upload::mesh_format ship_format;
+	// The ship is drawn by the render queue, so its indices can be 16 bits
+	// wide; the planar layout keeps the binormals phong reads.
+	auto const ship_shape = get_cached_mesh(MeshCache::make_key("buildSphere", 0.0005f, 10u, 10u, "optimized", "automatic indices"),
+	                                        [](mesh_upload::mesh_format& format) {
+		auto ship_mesh = mesh_builder::buildSphere(0.0005f, 10u, 10u);
+		mesh_optimizer::optimize(ship_mesh, "Ship sphere");
+		vertex_format::log_memory_report("Ship sphere", ship_mesh);
+		return mesh_upload::upload(ship_mesh, mesh_upload::upload_options(), &format);
+	}, &ship_format);
+	ship.set_geometry(ship_shape, ship_format);
 	ship.set_program(&phong_shader, phong_set_uniforms);
 	//ship.get_transform().Scale(0.2f);
 	//ship.set_program(&fallback_shader, set_uniforms);
@@ -183,38 +297,113 @@ edaf80::Assignment5::run()
 	ship.add_texture("specular_texture", demo_specular_map, GL_TEXTURE_2D);
 	ship.add_texture("normal_map", demo_normal_map, GL_TEXTURE_2D);
 
-	std::array<glm::vec3, 9> control_point_locations = {
-	glm::vec3(1.0f,  1.8f,  2.0f),
-	glm::vec3(0.0f,  0.0f,  -12.0f),
-	glm::vec3(1.0f,  1.8f,  -22.0f),
-	glm::vec3(2.0f,  0.0f,  -32.0f),
-	glm::vec3(1.0f,  1.8f,  -42.0f),
-	glm::vec3(-0.5f, 0.0f,  -52.0f),
-	glm::vec3(-3.0f, 1.8f, -62.0f),
-	glm::vec3(-1.0f, 0.0f, -72.0f),
-	glm::vec3(0.0f, 1.8f, -82.0f)
+	// The ship moves and collides in fixed ticks; the frames only render
+	// the state interpolated between the last two of them. The course is
+	// streamed ahead of it, and never ends.
+	flight::ship_state ship_start;
+	ship_start.position = ship.get_transform().GetTranslation();
+	CourseStream stream(ship_start.position);
+	FlightSimulation simulation(stream.make_course(), ship_start);
+	auto const tori_nb = stream.get_parameters().pool_size;
+
+	// Each ring of the course is drawn by a slot of a fixed pool of tori;
+	// the slot of a dropped ring is recycled for the one replacing it.
+	// Level 0 is kept while a torus covers at least 400 pixels, i.e. about
+	// 12 pixels per edge around its major circle. Bounding spheres are
+	// only updated when a slot is recycled, and tested four at a time
+	// every frame, before picking levels of detail.
+	auto const torus_lod_thresholds = lod::make_thresholds(static_cast<unsigned int>(torus_lod.levels.size()), 400.0f);
+	auto torus_lod_selectors = std::vector<LodSelector>(tori_nb);
+	auto tori_transforms = std::vector<glm::mat4>(tori_nb);
+	frustum_culling::SphereSet tori_spheres;
+	for (std::size_t slot = 0u; slot < tori_nb; ++slot)
+		tori_spheres.add(frustum_culling::sphere());
+	auto tori_visible = std::vector<std::uint8_t>();
+	// Visible slots and their distances, to instance them front to back.
+	auto tori_order = std::vector<std::pair<float, std::size_t>>();
+	// Distance of the nearest instance of each batch, for the render
+	// queue to sort the batches against the other items.
+	auto torus_near_distances = std::vector<float>(torus_lod.levels.size());
+	auto const place_torus = [&](std::size_t const ring_index) {
+		auto const& ring = simulation.get_course().get_ring(ring_index);
+		auto const slot = stream.get_slot(ring_index);
+		torus_lod_selectors[slot] = LodSelector(torus_lod_thresholds);
+		tori_transforms[slot] = course_stream::get_model_to_world(ring);
+		auto sphere = frustum_culling::sphere{ ring.center, torus_lod.bounding_radius };
+		if (!torus_lod.formats.front().bounds.is_empty())
+			sphere = frustum_culling::transform_bounds(torus_lod.formats.front().bounds, tori_transforms[slot]);
+		tori_spheres.set(slot, sphere);
+	};
+	for (auto i = simulation.get_course().get_first_ring(); i < simulation.get_course().get_rings_nb(); ++i)
+		place_torus(i);
+
+	// A thin tube follows the track the rings are placed on; only the
+	// segments appended to the track get uploaded as the course streams.
+	SweptTube course_tube;
+	course_tube.update(stream.get_track());
+	RenderItem course_tube_item;
+	course_tube_item.set_name("course tube");
+	course_tube_item.set_geometry(course_tube.get_mesh(), course_tube.get_format());
+	course_tube_item.set_program(&normal_shader, set_uniforms);
+
+	auto const stream_course = [&]() {
+		PROFILE_ZONE("course streaming");
+		auto& course = simulation.get_course();
+		auto const appended_nb = stream.update(course);
+		for (auto i = course.get_rings_nb() - appended_nb; i < course.get_rings_nb(); ++i)
+			place_torus(i);
+		if (appended_nb > 0u) {
+			course_tube.update(stream.get_track());
+			course_tube_item.set_geometry(course_tube.get_mesh(), course_tube.get_format());
+		}
 	};
 
-	for (int i = 0; i < 9; i++)
-	{
-		Tori[i].set_geometry(torus_shape);
-		Tori[i].set_program(&normal_shader, set_uniforms);
-		Tori[i].get_transform().SetTranslate(control_point_locations[i]);
-		Tori[i].get_transform().RotateX(glm::half_pi<float>());
+	// All tori using the same level of detail are drawn with one
+	// instanced call, whatever their number.
+	GLuint const instanced_normal_shader = embedded_program::create("Normal (instanced, procedural)",
+	                                                                procedural_shapes::instanced_normal_vertex_shader,
+	                                                                InstancedBatch::normal_fragment_shader);
+	if (instanced_normal_shader == 0u)
+		LogError("Failed to load the instanced normal shader");
+	auto torus_batches = std::vector<InstancedBatch>(torus_lod.levels.size());
+	auto torus_items = std::vector<RenderItem>(torus_lod.levels.size());
+	for (std::size_t level = 0u; level < torus_lod.levels.size(); ++level) {
+		auto const set_torus_uniforms = [&uniforms, procedural_uniforms, &torus_shapes, level](GLuint program) {
+			procedural_shapes::set_uniforms(uniforms, procedural_uniforms, program, torus_shapes[level]);
+		};
+		torus_batches[level].set_geometry(torus_lod.levels[level], torus_lod.formats[level]);
+		torus_batches[level].set_program(&instanced_normal_shader, set_torus_uniforms);
+		torus_items[level].set_name("tori");
+		torus_items[level].set_geometry(torus_lod.levels[level], torus_lod.formats[level]);
+		torus_items[level].set_program(&instanced_normal_shader, set_torus_uniforms);
 	}
 
-	auto demo_shape = parametric_shapes::createSphere(1.5f, 40u, 40u);
+	// Built here rather than by parametric_shapes::createSphere(), so that
+	// the upload fills in its bounds, without which it cannot be culled.
+	mesh_upload::mesh_format demo_format;
+	auto demo_shape = get_cached_mesh(MeshCache::make_key("buildSphere", 1.5f, 40u, 40u, "node"),
+	                                  [](mesh_upload::mesh_format& format) {
+		return mesh_upload::upload(mesh_builder::buildSphere(1.5f, 40u, 40u),
+		                           mesh_upload::node_upload_options(), &format);
+	}, &demo_format);
 	if (demo_shape.vao == 0u) {
 		LogError("Failed to retrieve the mesh for the demo sphere");
 		return;
 	}
 
+	auto const meshes_setup_time = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - meshes_setup_start);
+	LogInfo("Meshes set up in %.3f ms (%s cache: %u hits, %u misses)",
+	        meshes_setup_time.count(),
+	        mesh_cache.get_misses_nb() == 0u ? "warm" : "cold",
+	        mesh_cache.get_hits_nb(), mesh_cache.get_misses_nb());
+
 
 
 
 	glClearDepthf(1.0f);
 	glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 	glEnable(GL_DEPTH_TEST);
+	mesh_upload::enable_primitive_restart();
 
 
 	auto lastTime = std::chrono::high_resolution_clock::now();
@@ -224,17 +413,31 @@ edaf80::Assignment5::run()
 	auto polygon_mode = bonobo::polygon_mode_t::fill;
 	bool show_logs = true;
 	bool show_gui = true;
+	bool show_profiler = false;
 	bool shader_reload_failed = false;
 	bool show_basis = false;
 	float basis_thickness_scale = 1.0f;
 	float basis_length_scale = 1.0f;
 
 	bool game_over = false;
+	bool is_first_frame = true;
+	bool are_textures_loaded = textures.is_done();
+
+	// Samples per pixel of the default framebuffer, to turn the samples
+	// counted by the render queue into an overdraw factor.
+	GLint framebuffer_samples = 0;
+	glGetIntegerv(GL_SAMPLES, &framebuffer_samples);
+	framebuffer_samples = std::max(framebuffer_samples, 1);
+	bool sort_front_to_back = render_queue.get_opaque_order() == RenderQueue::opaque_order::front_to_back;
 
 	changeCullMode(cull_mode);
 
 	while (!glfwWindowShouldClose(window)) {
-		while (!game_over) {
+		while (!game_over && !glfwWindowShouldClose(window)) {
+			profiler::begin_frame();
+			replay::StageClock frame_clock;
+			replay::frame_timing frame_timing;
+
 			auto const nowTime = std::chrono::high_resolution_clock::now();
 			auto const deltaTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(nowTime - lastTime);
 			lastTime = nowTime;
@@ -242,30 +445,53 @@ edaf80::Assignment5::run()
 			auto& io = ImGui::GetIO();
 			inputHandler.SetUICapture(io.WantCaptureMouse, io.WantCaptureKeyboard);
 
-			glfwPollEvents();
-			inputHandler.Advance();
-			mCamera.Update(deltaTimeUs, inputHandler);
-			ship.get_transform().Translate(ship.get_transform().GetFront() * 0.05f);
-			ship_position = ship.get_transform().GetTranslation();
-			camera_position = ship_position + ship.get_transform().GetFront() * (-0.015f);
-
-			//collision
-
-			for (int i = 0; i < 9; i++)
 			{
-				//std::cout << "ship" << ship_position << std::endl;
-				//std::cout << "torus" << control_point_locations[i] << std::endl;
-				if (abs(ship_position.z - control_point_locations[i].z) < 0.1f) {
-					//std::cout << "ship" << ship_position << std::endl;
-					//std::cout << "torus" << control_point_locations[i] << std::endl;
-					if (abs(ship_position.x - control_point_locations[i].x) >= 1 || abs(ship_position.y - control_point_locations[i].y) >= 1) {
-						//game over
-						game_over = true;
-						std::cout << "Game over" << std::endl;
-					}
+				PROFILE_ZONE("input");
+				glfwPollEvents();
+				inputHandler.Advance();
+				mCamera.Update(deltaTimeUs, inputHandler);
+			}
+
+			std::uint8_t keys = 0u;
+			if (is_replaying) {
+				if (replay_tick == replay_input.keys.size()) {
+					profiler::end_frame();
+					glfwSetWindowShouldClose(window, GLFW_TRUE);
+					break;
 				}
+				keys = replay_input.keys[replay_tick++];
+				PROFILE_ZONE("simulation");
+				simulation.tick(replay::to_controls(keys));
+				stream_course();
+				frame_timing.ticks_nb = 1u;
+			} else {
+				if (inputHandler.GetKeycodeState(GLFW_KEY_UP) & PRESSED)
+					keys |= replay::key_up;
+				if (inputHandler.GetKeycodeState(GLFW_KEY_DOWN) & PRESSED)
+					keys |= replay::key_down;
+				if (inputHandler.GetKeycodeState(GLFW_KEY_LEFT) & PRESSED)
+					keys |= replay::key_left;
+				if (inputHandler.GetKeycodeState(GLFW_KEY_RIGHT) & PRESSED)
+					keys |= replay::key_right;
+				PROFILE_ZONE("simulation");
+				frame_timing.ticks_nb = simulation.advance(deltaTimeUs, replay::to_controls(keys));
+				stream_course();
+				if (!options.record_path.empty())
+					recorded_input.keys.insert(recorded_input.keys.end(), frame_timing.ticks_nb, keys);
+			}
+			if (simulation.is_over()) {
+				auto const& last_event = simulation.get_last_event();
+				game_over = true;
+				std::cout << "Game over: " << (last_event.type == RingCourse::event::hit ? "hit" : "missed")
+				          << " ring " << last_event.ring << std::endl;
 			}
 
+			auto const ship_state = simulation.get_interpolated_state();
+			ship.get_transform().SetTranslate(ship_state.position);
+			ship.get_transform().LookTowards(ship_state.get_front(), ship_state.get_up());
+			ship_position = ship_state.position;
+			camera_position = ship_position + ship_state.get_front() * (-0.015f);
+
 			mCamera.mWorld.SetTranslate(camera_position);
 			/*mCamera.mRotation.x = -ship.get_transform().GetFront().x;
 			mCamera.mRotation.y = ship.get_transform().GetFront().y;
@@ -273,6 +499,7 @@ edaf80::Assignment5::run()
 			mCamera.mWorld.RotateY(mCamera.mRotation.x);*/
 
 			mCamera.mWorld.LookTowards(ship_position - camera_position);
+			frame_timing.simulation_ms = frame_clock.lap_ms();
 
 			//std::cout <<"ship"<< ship.get_transform().GetFront() << std::endl;
 			//std::cout <<"camera"<< mCamera.mWorld.GetFront() << std::endl;
@@ -283,6 +510,8 @@ edaf80::Assignment5::run()
 
 			if (inputHandler.GetKeycodeState(GLFW_KEY_R) & JUST_PRESSED) {
 				shader_reload_failed = !program_manager.ReloadAllPrograms();
+				uniforms.invalidate();
+				render_queue.invalidate_programs();
 				if (shader_reload_failed)
 					tinyfd_notifyPopup("Shader Program Reload Error",
 						"An error occurred while reloading shader programs; see the logs for details.\n"
@@ -293,6 +522,8 @@ edaf80::Assignment5::run()
 				show_logs = !show_logs;
 			if (inputHandler.GetKeycodeState(GLFW_KEY_F2) & JUST_RELEASED)
 				show_gui = !show_gui;
+			if (inputHandler.GetKeycodeState(GLFW_KEY_F4) & JUST_RELEASED)
+				show_profiler = !show_profiler;
 			if (inputHandler.GetKeycodeState(GLFW_KEY_F11) & JUST_RELEASED)
 				mWindowManager.ToggleFullscreenStatusForWindow(window);
 
@@ -304,41 +535,82 @@ edaf80::Assignment5::run()
 
 
 
-			if (inputHandler.GetKeycodeState(GLFW_KEY_UP) & PRESSED) {
-				ship.get_transform().RotateX(0.005);
+			mWindowManager.NewImGuiFrame();
 
+			frame_constants constants = {};
+			constants.vertex_world_to_clip = mCamera.GetWorldToClipMatrix();
+			constants.light_position = light_position;
+			constants.camera_position = camera_position;
+			constants.ambient = ambient;
+			constants.diffuse = diffuse;
+			constants.specular = specular;
+			constants.shininess = shininess;
+			constants.use_normal_mapping = use_normal_mapping ? 1 : 0;
+			frame_constants_buffer.update(constants);
+
+			if (!are_textures_loaded) {
+				PROFILE_ZONE("texture uploads");
+				textures.update();
+				are_textures_loaded = textures.is_done();
+				if (are_textures_loaded)
+					LogInfo("Textures loaded %.3f ms after the start",
+					        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - run_start).count());
 			}
 
-			if (inputHandler.GetKeycodeState(GLFW_KEY_DOWN) & PRESSED) {
-				ship.get_transform().RotateX(-0.005);
+			glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+			bonobo::changePolygonMode(polygon_mode);
 
-			}
+			// Input handling and the frame set-up are not part of any stage.
+			frame_clock.lap_ms();
+			render_queue.reset_counters();
 
-			if (inputHandler.GetKeycodeState(GLFW_KEY_LEFT) & PRESSED) {
-				ship.get_transform().RotateY(0.005);
-			}
+			skybox_item.get_transform().SetTranslate(camera_position);
+			render_queue.submit(skybox_item);
 
-			if (inputHandler.GetKeycodeState(GLFW_KEY_RIGHT) & PRESSED) {
-				ship.get_transform().RotateY(-0.005);
+			auto const view_to_clip = mCamera.GetViewToClipMatrix();
+			std::size_t tori_triangles_nb = 0u;
+			frustum_culling::statistics tori_culling;
+			{
+				PROFILE_ZONE("culling");
+				auto const frustum = frustum_culling::extract_frustum(mCamera.GetWorldToClipMatrix());
+				tori_culling = frustum_culling::cull(frustum, tori_spheres, tori_visible);
+				tori_order.clear();
+				for (std::size_t slot = 0u; slot < tori_nb; ++slot)
+					if (tori_visible[slot] != 0u)
+						tori_order.emplace_back(frustum_culling::get_near_distance(frustum, tori_spheres.get(slot)), slot);
+				std::sort(tori_order.begin(), tori_order.end());
+				for (auto& batch : torus_batches)
+					batch.clear_instances();
+				std::fill(torus_near_distances.begin(), torus_near_distances.end(), std::numeric_limits<float>::infinity());
+				for (auto const& entry : tori_order)
+				{
+					auto const slot = entry.second;
+					auto const screen_size = lod::screen_size(glm::vec3(tori_transforms[slot][3]), torus_lod.bounding_radius,
+					                                          camera_position, view_to_clip,
+					                                          static_cast<float>(framebuffer_height));
+					auto const level = std::min<std::size_t>(torus_lod_selectors[slot].select(screen_size), torus_batches.size() - 1u);
+					torus_batches[level].add_instance(tori_transforms[slot]);
+					torus_near_distances[level] = std::min(torus_near_distances[level], entry.first);
+					tori_triangles_nb += torus_lod.triangles_nb[level];
+				}
+			}
+			frame_timing.culling_ms = frame_clock.lap_ms();
+			for (std::size_t level = 0u; level < torus_batches.size(); ++level) {
+				torus_batches[level].update_instance_buffer();
+				torus_items[level].set_instances_nb(torus_batches[level].get_instances_nb());
+				torus_items[level].set_near_distance(torus_near_distances[level]);
+				render_queue.submit(torus_items[level]);
 			}
 
+			ship.get_transform().SetTranslate(ship_position);
+			render_queue.submit(ship);
+			render_queue.submit(course_tube_item);
 
-
-			mWindowManager.NewImGuiFrame();
-
-			glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-			bonobo::changePolygonMode(polygon_mode);
-
-			skybox.get_transform().SetTranslate(camera_position);
-			skybox.render(mCamera.GetWorldToClipMatrix());
-			for (int i = 0; i < 9; i++)
 			{
-				Tori[i].render(mCamera.GetWorldToClipMatrix());
+				PROFILE_GPU_ZONE("scene");
+				render_queue.flush(mCamera.GetWorldToClipMatrix());
 			}
 
-			ship.get_transform().SetTranslate(ship_position);
-			ship.render(mCamera.GetWorldToClipMatrix());
-
 
 
 			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -362,6 +634,9 @@ edaf80::Assignment5::run()
 				ImGui::Checkbox("Show basis", &show_basis);
 				ImGui::SliderFloat("Basis thickness scale", &basis_thickness_scale, 0.0f, 100.0f);
 				ImGui::SliderFloat("Basis length scale", &basis_length_scale, 0.0f, 100.0f);*/
+				ImGui::Text("Flown %.0f along the course, next ring %zu",
+				            stream.get_track().find_nearest(ship_position).distance,
+				            simulation.get_course().get_next_ring());
 				if (game_over) {
 					ImGui::Text("Game over!!!");
 				}
@@ -372,28 +647,431 @@ edaf80::Assignment5::run()
 				bonobo::renderBasis(basis_thickness_scale, basis_length_scale, mCamera.GetWorldToClipMatrix());
 
 			opened = ImGui::Begin("Render Time", nullptr, ImGuiWindowFlags_None);
-			if (opened)
+			if (opened) {
 				ImGui::Text("%.3f ms", std::chrono::duration<float, std::milli>(deltaTimeUs).count());
+				ImGui::Text("Tori: %zu triangles (%zu at full detail)",
+				            tori_triangles_nb, tori_nb * torus_lod.triangles_nb.front());
+				auto const& counters = render_queue.get_counters();
+				auto const& items_culling = render_queue.get_culling_statistics();
+				ImGui::Text("Culling: tori %zu visible, %zu culled; items %zu drawn, %zu culled",
+				            tori_culling.visible_nb, tori_culling.culled_nb,
+				            items_culling.visible_nb, items_culling.culled_nb);
+				ImGui::Text("Draw calls: %u", counters.draws);
+				ImGui::Text("Programs: %u bound, %u skipped", counters.programs_issued, counters.programs_skipped);
+				ImGui::Text("VAOs: %u bound, %u skipped", counters.vertex_arrays_issued, counters.vertex_arrays_skipped);
+				ImGui::Text("Textures: %u bound, %u skipped", counters.textures_issued, counters.textures_skipped);
+				// From a frame a few flushes back, the queries being read
+				// without waiting.
+				auto const framebuffer_samples_nb = static_cast<double>(framebuffer_width) * framebuffer_height
+				                                  * framebuffer_samples;
+				ImGui::Text("Overdraw: %.2f samples per sample",
+				            framebuffer_samples_nb > 0.0 ? render_queue.get_samples_passed() / framebuffer_samples_nb : 0.0);
+				if (ImGui::Checkbox("Sort opaque items front to back", &sort_front_to_back))
+					render_queue.set_opaque_order(sort_front_to_back ? RenderQueue::opaque_order::front_to_back
+					                                                 : RenderQueue::opaque_order::by_state);
+			}
 			ImGui::End();
 
+			if (show_profiler)
+				profiler::render_ui(&show_profiler);
+
 			if (show_logs)
 				Log::View::Render();
-			mWindowManager.RenderImGuiFrame(show_gui);
+			{
+				PROFILE_GPU_ZONE("ImGui");
+				mWindowManager.RenderImGuiFrame(show_gui);
+			}
 
-			glfwSwapBuffers(window);
+			frame_timing.submission_ms = frame_clock.lap_ms();
+
+			{
+				PROFILE_ZONE("swap");
+				glfwSwapBuffers(window);
+			}
+			if (is_first_frame) {
+				LogInfo("First frame presented %.3f ms after the start%s",
+				        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - run_start).count(),
+				        are_textures_loaded ? "" : ", with placeholder textures");
+				is_first_frame = false;
+			}
+			frame_timing.swap_ms = frame_clock.lap_ms();
+			profiler::end_frame();
+			if (!options.timings_path.empty() || is_replaying)
+				frame_timings.push_back(frame_timing);
+
+			if (is_replaying && game_over)
+				glfwSetWindowShouldClose(window, GLFW_TRUE);
 		}
+		if (!glfwWindowShouldClose(window))
+			glfwWaitEvents();
+	}
+
+	if (!options.record_path.empty() && replay::save(recorded_input, options.record_path))
+		LogInfo("Saved %zu ticks of input to \"%s\"", recorded_input.keys.size(), options.record_path.c_str());
+	if (is_replaying) {
+		auto const& ship_state = simulation.get_state();
+		std::printf("Replayed %llu of %zu ticks; ship at (%.6f, %.6f, %.6f)\n",
+		            static_cast<unsigned long long>(simulation.get_ticks_nb()), replay_input.keys.size(),
+		            ship_state.position.x, ship_state.position.y, ship_state.position.z);
+		replay::print_summary(frame_timings);
 	}
+	if (!options.timings_path.empty())
+		replay::write_timings(frame_timings, options.timings_path);
 }
 
-int main()
+bool
+edaf80::Assignment5::check_instancing()
+{
+	constexpr GLsizei width = 256;
+	constexpr GLsizei height = 256;
+	constexpr int grid_side = 8;
+
+	GLuint const program = embedded_program::create("Normal (instanced)",
+	                                                InstancedBatch::normal_vertex_shader,
+	                                                InstancedBatch::normal_fragment_shader);
+	if (program == 0u)
+		return false;
+
+	mesh_upload::mesh_format torus_format;
+	auto const torus_shape = mesh_upload::upload(mesh_builder::buildTorus(2.0f, 1.0f, 40u, 40u),
+	                                             mesh_upload::node_upload_options(vertex_format::vertex_layout::interleaved_packed,
+	                                                                              index_format::primitive_mode::triangle_strip),
+	                                             &torus_format);
+
+	GLuint framebuffer = 0u, color_renderbuffer = 0u, depth_renderbuffer = 0u;
+	glGenFramebuffers(1, &framebuffer);
+	glGenRenderbuffers(1, &color_renderbuffer);
+	glGenRenderbuffers(1, &depth_renderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth_renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0u);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_renderbuffer);
+	auto const is_framebuffer_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+	glViewport(0, 0, width, height);
+	glEnable(GL_DEPTH_TEST);
+	mesh_upload::enable_primitive_restart();
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClearDepthf(1.0f);
+
+	// A grid of tilted tori, far enough to overlap each other a little.
+	auto transforms = std::vector<glm::mat4>();
+	for (int i = 0; i < grid_side * grid_side; ++i) {
+		auto const x = static_cast<float>(i % grid_side) - 0.5f * static_cast<float>(grid_side - 1);
+		auto const y = static_cast<float>(i / grid_side) - 0.5f * static_cast<float>(grid_side - 1);
+		auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f * x, 5.0f * y, -3.0f * static_cast<float>(i % 3)));
+		transform = glm::rotate(transform, 0.3f * static_cast<float>(i), glm::vec3(1.0f, 0.5f, 0.0f));
+		transforms.push_back(transform);
+	}
+	auto const world_to_clip = glm::perspective(glm::half_pi<float>(), 1.0f, 1.0f, 200.0f)
+	                         * glm::lookAt(glm::vec3(0.0f, 0.0f, 40.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	InstancedBatch batch;
+	batch.set_geometry(torus_shape, torus_format);
+	batch.set_program(&program);
+
+	auto const read_pixels = [](){
+		auto pixels = std::vector<std::uint8_t>(4u * width * height);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		return pixels;
+	};
+
+	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+	batch.set_transforms(transforms);
+	batch.render(world_to_clip);
+	auto const instanced_pixels = read_pixels();
+
+	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+	for (auto const& transform : transforms) {
+		batch.set_transforms({ transform });
+		batch.render(world_to_clip);
+	}
+	auto const separate_pixels = read_pixels();
+
+	// A batch left with a single torus, far from the origin, which is off
+	// screen: drawn through a render queue, it must not be culled by the
+	// bounds of the mesh, around the origin.
+	auto const lone_transform = glm::translate(glm::mat4(1.0f), glm::vec3(100.0f, 0.0f, 0.0f));
+	auto const lone_world_to_clip = glm::perspective(glm::half_pi<float>(), 1.0f, 1.0f, 200.0f)
+	                              * glm::lookAt(glm::vec3(100.0f, 0.0f, 10.0f), glm::vec3(100.0f, 0.0f, 0.0f),
+	                                            glm::vec3(0.0f, 1.0f, 0.0f));
+	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+	batch.set_transforms({ lone_transform });
+	batch.render(lone_world_to_clip);
+	auto const lone_pixels = read_pixels();
+
+	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+	RenderQueue render_queue;
+	RenderItem lone_item;
+	lone_item.set_geometry(torus_shape, torus_format);
+	lone_item.set_program(&program);
+	batch.update_instance_buffer();
+	lone_item.set_instances_nb(batch.get_instances_nb());
+	render_queue.submit(lone_item);
+	render_queue.flush(lone_world_to_clip);
+	auto const queued_lone_pixels = read_pixels();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0u);
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &color_renderbuffer);
+	glDeleteRenderbuffers(1, &depth_renderbuffer);
+	glDeleteProgram(program);
+
+	std::size_t differing_pixels_nb = 0u, covered_pixels_nb = 0u;
+	for (std::size_t i = 0u; i < instanced_pixels.size(); i += 4u) {
+		if (std::memcmp(&instanced_pixels[i], &separate_pixels[i], 4u) != 0)
+			++differing_pixels_nb;
+		if (instanced_pixels[i] != 0u || instanced_pixels[i + 1u] != 0u || instanced_pixels[i + 2u] != 0u)
+			++covered_pixels_nb;
+	}
+	LogInfo("Instancing check: %d tori, %zu covered pixels, %zu differing pixels between 1 and %d draw calls",
+	        grid_side * grid_side, covered_pixels_nb, differing_pixels_nb, grid_side * grid_side);
+
+	std::size_t lone_differing_pixels_nb = 0u, lone_covered_pixels_nb = 0u;
+	for (std::size_t i = 0u; i < lone_pixels.size(); i += 4u) {
+		if (std::memcmp(&lone_pixels[i], &queued_lone_pixels[i], 4u) != 0)
+			++lone_differing_pixels_nb;
+		if (queued_lone_pixels[i] != 0u || queued_lone_pixels[i + 1u] != 0u || queued_lone_pixels[i + 2u] != 0u)
+			++lone_covered_pixels_nb;
+	}
+	LogInfo("Instancing check: a lone torus through the render queue, %zu covered pixels, %zu differing pixels",
+	        lone_covered_pixels_nb, lone_differing_pixels_nb);
+
+	return is_framebuffer_complete && covered_pixels_nb > 0u && differing_pixels_nb == 0u
+	    && lone_covered_pixels_nb > 0u && lone_differing_pixels_nb == 0u;
+}
+
+bool
+edaf80::Assignment5::check_procedural_shapes()
+{
+	GLuint const program = embedded_program::create_feedback("Procedural shapes (feedback)",
+	                                                         procedural_shapes::feedback_vertex_shader,
+	                                                         procedural_shapes::feedback_varyings, 5);
+	if (program == 0u)
+		return false;
+
+	UniformCache uniforms;
+	auto const procedural_uniforms = procedural_shapes::declare_uniforms(uniforms);
+
+	// The tori drawn by run(), and smaller shapes with different split
+	// counts along u and v, to catch the two being swapped.
+	auto const shapes = std::vector<std::pair<char const*, procedural_shapes::shape>>{
+		{ "sphere", procedural_shapes::make_sphere(200.0f, 16u, 16u) },
+		{ "sphere", procedural_shapes::make_sphere(1.5f, 7u, 12u) },
+		{ "torus", procedural_shapes::make_torus(2.0f, 1.0f, 100u, 100u) },
+		{ "torus", procedural_shapes::make_torus(2.0f, 0.5f, 5u, 9u) },
+		{ "circle ring", procedural_shapes::make_circle_ring(1.0f, 0.5f, 30u, 3u) },
+	};
+	// The CPU generators take their sines from tables accurate to 1e-5;
+	// positions are compared relative to the size of the shape.
+	constexpr float tolerance = 1.0e-4f;
+
+	GLuint vao = 0u, feedback_buffer = 0u;
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &feedback_buffer);
+	glBindVertexArray(vao);
+	glUseProgram(program);
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	bool all_match = true;
+	for (auto const& named_shape : shapes) {
+		auto const& shape = named_shape.second;
+		auto const vertices_nb = procedural_shapes::get_vertices_nb(shape);
+		auto captured = std::vector<procedural_shapes::feedback_vertex>(vertices_nb);
+		auto const size = static_cast<GLsizeiptr>(captured.size() * sizeof(procedural_shapes::feedback_vertex));
+
+		glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, feedback_buffer);
+		glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, size, nullptr, GL_STATIC_READ);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0u, feedback_buffer);
+		procedural_shapes::set_uniforms(uniforms, procedural_uniforms, program, shape);
+		// Drawn as points, every vertex is captured once and in order;
+		// a strip would be captured as separate triangles.
+		glBeginTransformFeedback(GL_POINTS);
+		glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(vertices_nb));
+		glEndTransformFeedback();
+		glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, size, captured.data());
+
+		// Every vertex of the strip against the grid vertex it stands for.
+		auto const mesh = procedural_shapes::build(shape);
+		auto const columns = shape.u_edges_nb + 1u;
+		auto const scale = procedural_shapes::get_bounds(shape).get_radius();
+		float position_error = 0.0f, direction_error = 0.0f, texcoord_error = 0.0f;
+		for (std::size_t k = 0u; k < vertices_nb; ++k) {
+			auto const grid = procedural_shapes::get_grid_vertex(shape, k);
+			auto const index = grid.y * columns + grid.x;
+			auto const& v = captured[k];
+			position_error = std::max(position_error, glm::length(v.position - mesh.vertices[index]) / scale);
+			direction_error = std::max({ direction_error,
+			                             glm::length(v.normal - mesh.normals[index]),
+			                             glm::length(v.tangent - mesh.tangents[index]),
+			                             glm::length(v.binormal - mesh.binormals[index]) });
+			texcoord_error = std::max(texcoord_error, glm::length(v.texcoord - glm::vec2(mesh.texcoords[index])));
+		}
+
+		// The strip, once split as OpenGL does and without its degenerate
+		// triangles, against the triangles of the CPU mesh; each triangle
+		// starts from its smallest index, keeping its winding.
+		auto const canonical = [](glm::uvec3 const& t) {
+			if (t.y < t.x && t.y < t.z)
+				return glm::uvec3(t.y, t.z, t.x);
+			if (t.z < t.x && t.z < t.y)
+				return glm::uvec3(t.z, t.x, t.y);
+			return t;
+		};
+		auto const is_before = [](glm::uvec3 const& a, glm::uvec3 const& b) {
+			return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+		};
+		auto strip_triangles = std::vector<glm::uvec3>();
+		auto const index_of = [&shape, columns](std::size_t const k) {
+			auto const grid = procedural_shapes::get_grid_vertex(shape, k);
+			return grid.y * columns + grid.x;
+		};
+		for (std::size_t k = 0u; k + 2u < vertices_nb; ++k) {
+			auto t = glm::uvec3(index_of(k), index_of(k + 1u), index_of(k + 2u));
+			if (t.x == t.y || t.y == t.z || t.z == t.x)
+				continue;
+			if (k % 2u == 1u)
+				std::swap(t.x, t.y);
+			strip_triangles.push_back(canonical(t));
+		}
+		auto mesh_triangles = std::vector<glm::uvec3>();
+		for (auto const& t : mesh.index_sets)
+			mesh_triangles.push_back(canonical(t));
+		std::sort(strip_triangles.begin(), strip_triangles.end(), is_before);
+		std::sort(mesh_triangles.begin(), mesh_triangles.end(), is_before);
+		auto const are_triangles_same = strip_triangles == mesh_triangles
+		                             && strip_triangles.size() == procedural_shapes::get_triangles_nb(shape);
+
+		auto const matches = are_triangles_same && position_error <= tolerance
+		                  && direction_error <= tolerance && texcoord_error <= tolerance;
+		LogInfo("Procedural %s, %u x %u cells: %zu vertices, largest errors %g (position, relative), %g (directions), %g (texcoords); triangles %s",
+		        named_shape.first, shape.u_edges_nb, shape.v_edges_nb, vertices_nb,
+		        position_error, direction_error, texcoord_error, are_triangles_same ? "identical" : "differing");
+		all_match = all_match && matches;
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	glUseProgram(0u);
+	glBindVertexArray(0u);
+	glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0u);
+	glDeleteBuffers(1, &feedback_buffer);
+	glDeleteVertexArrays(1, &vao);
+	glDeleteProgram(program);
+
+	return all_match;
+}
+
+//! \brief Convert the images run() loads to KTX files next to them.
+//!
+//! Everything is stored as BC1, normal map included: phong.frag reads z
+//! from its blue channel, which BC5 does not store.
+static bool
+compress_textures()
+{
+	std::printf("Compressing textures\n");
+	bool all_converted = true;
+	auto const convert = [&all_converted](std::string const& path, bool const flip) {
+		auto const source = config::resources_path(path);
+		auto const destination = source.substr(0u, source.find_last_of('.')) + ".ktx";
+		all_converted = texture_compression::convert(source, destination, texture_compression::format::bc1, flip)
+		             && all_converted;
+	};
+	for (auto const* const name : { "diff", "rough", "nor" })
+		convert(std::string("textures/cobblestone_floor_08_") + name + "_2k.jpg", true);
+	for (auto const* const face : { "posx", "negx", "posy", "negy", "posz", "negz" })
+		convert(std::string("cubemaps/LarnacaCastle/") + face + ".jpg", false);
+	return all_converted;
+}
+
+int main(int argc, char* argv[])
 {
 	std::setlocale(LC_ALL, "");
 
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--benchmark-meshes") == 0) {
+			benchmarks::run_mesh_generation();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--benchmark-surfaces") == 0) {
+			benchmarks::run_surface_engine();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--benchmark-collisions") == 0) {
+			benchmarks::run_ring_collision();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--benchmark-simulation") == 0) {
+			benchmarks::run_flight_simulation();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--benchmark-course") == 0) {
+			benchmarks::run_course_streaming();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--benchmark-spline") == 0) {
+			benchmarks::run_spline_track();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--benchmark-tube") == 0) {
+			benchmarks::run_swept_tube();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--benchmark-culling") == 0) {
+			benchmarks::run_frustum_culling();
+			return EXIT_SUCCESS;
+		}
+		if (std::strcmp(argv[i], "--check-collisions") == 0)
+			return benchmarks::check_ring_collision() ? EXIT_SUCCESS : EXIT_FAILURE;
+		if (std::strcmp(argv[i], "--check-texture-compression") == 0)
+			return benchmarks::check_texture_compression() ? EXIT_SUCCESS : EXIT_FAILURE;
+		if (std::strcmp(argv[i], "--compress-textures") == 0)
+			return compress_textures() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	bool check_instancing = false;
+	bool check_procedural_shapes = false;
+	bool use_null_renderer = false;
+	auto run_options = edaf80::Assignment5::run_options();
+	for (int i = 1; i < argc; ++i) {
+		check_instancing = check_instancing || std::strcmp(argv[i], "--check-instancing") == 0;
+		check_procedural_shapes = check_procedural_shapes || std::strcmp(argv[i], "--check-procedural-shapes") == 0;
+		use_null_renderer = use_null_renderer || std::strcmp(argv[i], "--null-renderer") == 0;
+		run_options.synchronous_textures = run_options.synchronous_textures || std::strcmp(argv[i], "--sync-textures") == 0;
+		if (i + 1 == argc)
+			continue;
+		if (std::strcmp(argv[i], "--record") == 0)
+			run_options.record_path = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0)
+			run_options.replay_path = argv[++i];
+		else if (std::strcmp(argv[i], "--timings") == 0)
+			run_options.timings_path = argv[++i];
+	}
+
+	// Without a renderer, nothing needs a window nor an OpenGL context.
+	if (use_null_renderer) {
+		auto input = replay::recording();
+		if (run_options.replay_path.empty()) {
+			LogError("--null-renderer needs a recording to play, given with --replay.");
+			return EXIT_FAILURE;
+		}
+		if (!replay::load(run_options.replay_path, input))
+			return EXIT_FAILURE;
+		return replay::run_headless(input, run_options.timings_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	Bonobo framework;
 
 	try {
 		edaf80::Assignment5 assignment5(framework.GetWindowManager());
-		assignment5.run();
+		if (check_instancing)
+			return assignment5.check_instancing() ? EXIT_SUCCESS : EXIT_FAILURE;
+		if (check_procedural_shapes)
+			return assignment5.check_procedural_shapes() ? EXIT_SUCCESS : EXIT_FAILURE;
+		assignment5.run(run_options);
 	}
 	catch (std::runtime_error const& e) {
 		LogError(e.what());
@@ -4,6 +4,8 @@
 #include "core/FPSCamera.h"
 #include "core/WindowManager.hpp"
 
+#include <string>
+
 
 class Window;
 
@@ -25,9 +27,46 @@ namespace edaf80
 		//! constructor, as well as the window.
 		~Assignment5();
 
+		//! \brief Options of run(), given on the command line.
+		struct run_options {
+			//! Where to save the inputs of the run, if not empty.
+			std::string record_path;
+			//! Recording to play instead of reading the keyboard, one
+			//! tick per frame, if not empty; the window closes once it
+			//! is over.
+			std::string replay_path;
+			//! Where to write the timings of every frame, if not empty.
+			std::string timings_path;
+			//! Whether to load every texture before the first frame,
+			//! instead of decoding them in the background, e.g. to
+			//! compare the startup times. Value-initialise the options
+			//! for it to default to false.
+			bool synchronous_textures;
+		};
+
 		//! \brief Contains the logic of the assignment, along with the
 		//! render loop.
-		void run();
+		void run(run_options const& options = run_options());
+
+		//! \brief Render a grid of tori once with a single instanced
+		//! draw call and once with one call per torus, and compare both
+		//! images; then do the same for a batch of a single torus, far
+		//! from the origin, drawn directly and through a RenderQueue. No
+		//! interaction is needed, so it can run on a headless machine,
+		//! e.g. under Mesa's software rasteriser.
+		//!
+		//! @return whether the images of each pair are identical and not
+		//!         empty
+		bool check_instancing();
+
+		//! \brief Capture, with transform feedback, the vertices the
+		//! procedural_shapes vertex shader generates for a few shapes,
+		//! and compare them and their triangles to the CPU generators';
+		//! like check_instancing(), it runs on a headless machine, e.g.
+		//! with LIBGL_ALWAYS_SOFTWARE=1 to get Mesa's llvmpipe.
+		//!
+		//! @return whether every shape matches
+		bool check_procedural_shapes();
 
 	private:
 		FPSCameraf     mCamera;
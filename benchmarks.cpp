@@ -0,0 +1,883 @@
+#include "benchmarks.hpp"
+
+#include "course_stream.hpp"
+#include "fast_trig.hpp"
+#include "flight_simulation.hpp"
+#include "frustum_culling.hpp"
+#include "mesh_builder.hpp"
+#include "parametric_surface.hpp"
+#include "ring_collision.hpp"
+#include "spline_track.hpp"
+#include "swept_tube.hpp"
+#include "texture_compression.hpp"
+#include "thread_pool.hpp"
+#include "vertex_format.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <random>
+#include <utility>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Best time out of `runs_nb` runs, in milliseconds.
+	double time_best_of(unsigned int const runs_nb, std::function<void ()> const& run)
+	{
+		auto best = std::chrono::duration<double, std::milli>::max();
+		for (unsigned int i = 0u; i < runs_nb; ++i) {
+			auto const start_time = std::chrono::high_resolution_clock::now();
+			run();
+			auto const end_time = std::chrono::high_resolution_clock::now();
+			best = std::min<std::chrono::duration<double, std::milli>>(best, end_time - start_time);
+		}
+		return best.count();
+	}
+
+	// Relative difference below which two generated meshes are considered
+	// the same, rounding aside.
+	constexpr float surface_tolerance = 1.0e-5f;
+
+	// Largest distance between matching vectors of `a` and `b`; infinite
+	// if their sizes differ.
+	float get_max_difference(std::vector<glm::vec3> const& a, std::vector<glm::vec3> const& b)
+	{
+		if (a.size() != b.size())
+			return std::numeric_limits<float>::infinity();
+		auto difference = 0.0f;
+		for (std::size_t i = 0u; i < a.size(); ++i)
+			difference = std::max(difference, glm::length(a[i] - b[i]));
+		return difference;
+	}
+
+	// The sphere and torus generators as they were written before
+	// parametric_surface::build() existed, kept as a baseline for it.
+	mesh_builder::cpu_mesh hand_written_sphere(float const radius,
+	                                           unsigned int const longitude_split_count,
+	                                           unsigned int const latitude_split_count)
+	{
+		auto const longitude_split_edges_count = longitude_split_count + 1u;
+		auto const latitude_split_edges_count = latitude_split_count + 1u;
+		auto const longitude_split_vertices_count = longitude_split_edges_count + 1u;
+		auto const latitude_split_vertices_count = latitude_split_edges_count + 1u;
+		auto const vertices_nb = longitude_split_vertices_count * latitude_split_vertices_count;
+
+		mesh_builder::cpu_mesh mesh;
+		mesh.vertices.resize(vertices_nb);
+		mesh.normals.resize(vertices_nb);
+		mesh.texcoords.resize(vertices_nb);
+		mesh.tangents.resize(vertices_nb);
+		mesh.binormals.resize(vertices_nb);
+
+		float const d_theta = glm::two_pi<float>() / (static_cast<float>(longitude_split_edges_count));
+		float const d_phi = glm::pi<float>() / (static_cast<float>(latitude_split_edges_count));
+		auto const theta_table = fast_trig::make_sincos_table(0.0f, d_theta, longitude_split_vertices_count);
+		auto const phi_table = fast_trig::make_sincos_table(0.0f, d_phi, latitude_split_vertices_count);
+
+		size_t index = 0u;
+		for (unsigned int i = 0u; i < latitude_split_vertices_count; ++i) {
+			float const cos_phi = phi_table.cos[i];
+			float const sin_phi = phi_table.sin[i];
+			for (unsigned int j = 0u; j < longitude_split_vertices_count; ++j) {
+				float const cos_theta = theta_table.cos[j];
+				float const sin_theta = theta_table.sin[j];
+
+				mesh.vertices[index] = glm::vec3(radius * sin_theta * sin_phi, -radius * cos_phi, radius * cos_theta * sin_phi);
+				mesh.texcoords[index] = glm::vec3(static_cast<float>(j) / (static_cast<float>(longitude_split_vertices_count)),
+				                                  static_cast<float>(i) / (static_cast<float>(latitude_split_vertices_count)),
+				                                  0.0f);
+				auto const tangent = glm::vec3(cos_theta, 0.0f, -sin_theta);
+				auto const binormal = glm::vec3(sin_theta * cos_phi, sin_phi, cos_theta * cos_phi);
+				mesh.tangents[index] = tangent;
+				mesh.binormals[index] = binormal;
+				mesh.normals[index] = glm::cross(tangent, binormal);
+				++index;
+			}
+		}
+
+		mesh.index_sets = parametric_surface::build_grid_index_sets(longitude_split_vertices_count, latitude_split_vertices_count);
+		mesh.grid_columns = longitude_split_vertices_count;
+		mesh.grid_rows = latitude_split_vertices_count;
+		return mesh;
+	}
+
+	mesh_builder::cpu_mesh hand_written_torus(float const major_radius,
+	                                          float const minor_radius,
+	                                          unsigned int const major_split_count,
+	                                          unsigned int const minor_split_count)
+	{
+		auto const major_split_edges_count = major_split_count + 1u;
+		auto const minor_split_edges_count = minor_split_count + 1u;
+		auto const major_split_vertices_count = major_split_edges_count + 1u;
+		auto const minor_split_vertices_count = minor_split_edges_count + 1u;
+		auto const vertices_nb = major_split_vertices_count * minor_split_vertices_count;
+
+		mesh_builder::cpu_mesh mesh;
+		mesh.vertices.resize(vertices_nb);
+		mesh.normals.resize(vertices_nb);
+		mesh.texcoords.resize(vertices_nb);
+		mesh.tangents.resize(vertices_nb);
+		mesh.binormals.resize(vertices_nb);
+
+		float const d_theta = glm::two_pi<float>() / (static_cast<float>(major_split_edges_count));
+		float const d_phi = glm::two_pi<float>() / (static_cast<float>(minor_split_edges_count));
+		auto const theta_table = fast_trig::make_sincos_table(0.0f, d_theta, major_split_vertices_count);
+		auto const phi_table = fast_trig::make_sincos_table(0.0f, d_phi, minor_split_vertices_count);
+
+		size_t index = 0u;
+		for (unsigned int i = 0u; i < minor_split_vertices_count; ++i) {
+			float const cos_phi = phi_table.cos[i];
+			float const sin_phi = phi_table.sin[i];
+			for (unsigned int j = 0u; j < major_split_vertices_count; ++j) {
+				float const cos_theta = theta_table.cos[j];
+				float const sin_theta = theta_table.sin[j];
+
+				mesh.vertices[index] = glm::vec3((major_radius + minor_radius * cos_theta) * cos_phi,
+				                                 -minor_radius * sin_theta,
+				                                 (major_radius + minor_radius * cos_theta) * sin_phi);
+				mesh.texcoords[index] = glm::vec3(static_cast<float>(j) / (static_cast<float>(major_split_vertices_count)),
+				                                  static_cast<float>(i) / (static_cast<float>(minor_split_vertices_count)),
+				                                  0.0f);
+				auto const tangent = glm::vec3(-sin_theta * cos_phi, -cos_theta, -sin_theta * sin_phi);
+				auto const binormal = glm::vec3(-sin_phi, 0, cos_phi);
+				mesh.tangents[index] = tangent;
+				mesh.binormals[index] = binormal;
+				mesh.normals[index] = glm::cross(tangent, binormal);
+				++index;
+			}
+		}
+
+		mesh.index_sets = parametric_surface::build_grid_index_sets(major_split_vertices_count, minor_split_vertices_count);
+		mesh.grid_columns = major_split_vertices_count;
+		mesh.grid_rows = minor_split_vertices_count;
+		return mesh;
+	}
+}
+
+void
+benchmarks::run_mesh_generation()
+{
+	struct shape {
+		char const* name;
+		std::function<mesh_builder::cpu_mesh (ThreadPool*)> build;
+	};
+	auto const shapes = std::vector<shape>{
+		{ "sphere 2000x2000", [](ThreadPool* pool){ return mesh_builder::buildSphere(200.0f, 2000u, 2000u, pool); } },
+		{ "torus 2000x2000",  [](ThreadPool* pool){ return mesh_builder::buildTorus(2.0f, 1.0f, 2000u, 2000u, pool); } }
+	};
+
+	auto const max_threads_nb = std::max(std::thread::hardware_concurrency(), 1u);
+	auto threads_nbs = std::vector<unsigned int>();
+	for (unsigned int threads_nb = 1u; threads_nb < max_threads_nb; threads_nb *= 2u)
+		threads_nbs.push_back(threads_nb);
+	threads_nbs.push_back(max_threads_nb);
+
+	std::printf("Mesh generation, best of 5 runs, %u hardware threads\n", max_threads_nb);
+
+	for (auto const& s : shapes) {
+		auto const serial_time = time_best_of(5u, [&s](){ s.build(nullptr); });
+		std::printf("  %-18s serial loops: %8.2f ms\n", s.name, serial_time);
+
+		for (auto const threads_nb : threads_nbs) {
+			ThreadPool pool(threads_nb);
+			auto const pool_time = time_best_of(5u, [&s, &pool](){ s.build(&pool); });
+			std::printf("  %-18s %3u thread(s): %8.2f ms, speed-up x%.2f\n",
+			            s.name, threads_nb, pool_time, serial_time / pool_time);
+		}
+	}
+}
+
+void
+benchmarks::run_surface_engine()
+{
+	struct shape {
+		char const* name;
+		std::function<mesh_builder::cpu_mesh ()> hand_written;
+		std::function<mesh_builder::cpu_mesh ()> engine;
+	};
+	auto const shapes = std::vector<shape>{
+		{ "sphere 2000x2000",
+		  [](){ return hand_written_sphere(200.0f, 2000u, 2000u); },
+		  [](){ return mesh_builder::buildSphere(200.0f, 2000u, 2000u); } },
+		{ "torus 2000x2000",
+		  [](){ return hand_written_torus(2.0f, 1.0f, 2000u, 2000u); },
+		  [](){ return mesh_builder::buildTorus(2.0f, 1.0f, 2000u, 2000u); } }
+	};
+
+	std::printf("Parametric surface engine against hand-written loops, single thread, best of 7 runs\n");
+
+	for (auto const& s : shapes) {
+		// Alternate between both to even out the effects of warming up.
+		auto hand_written_time = std::numeric_limits<double>::max();
+		auto engine_time = std::numeric_limits<double>::max();
+		for (unsigned int i = 0u; i < 7u; ++i) {
+			hand_written_time = std::min(hand_written_time, time_best_of(1u, [&s](){ s.hand_written(); }));
+			engine_time = std::min(engine_time, time_best_of(1u, [&s](){ s.engine(); }));
+		}
+		std::printf("  %-18s hand-written: %8.2f ms, engine: %8.2f ms, ratio x%.2f\n",
+		            s.name, hand_written_time, engine_time, hand_written_time / engine_time);
+
+		// The engine does not evaluate the terms in the same order, so the
+		// low bits may differ; positions are compared relative to the size
+		// of the shape. Texture coordinates differ on purpose, the engine
+		// running them up to 1.
+		auto const reference = s.hand_written();
+		auto const built = s.engine();
+		auto extent = 0.0f;
+		for (auto const& position : reference.vertices)
+			extent = std::max(extent, glm::length(position));
+		auto const position_difference = get_max_difference(reference.vertices, built.vertices);
+		auto const direction_difference = std::max({ get_max_difference(reference.normals, built.normals),
+		                                             get_max_difference(reference.tangents, built.tangents),
+		                                             get_max_difference(reference.binormals, built.binormals) });
+		auto const is_equal = position_difference <= surface_tolerance * extent
+		                   && direction_difference <= surface_tolerance;
+		std::printf("  %-18s largest difference: positions %g, directions %g, %s\n",
+		            "", static_cast<double>(position_difference), static_cast<double>(direction_difference),
+		            is_equal ? "equal within rounding" : "DIFFER");
+	}
+
+	std::printf("Other surfaces, 2000x2000, single thread, best of 3 runs\n");
+	auto const bezier_control_points = std::array<glm::vec3, 16>{
+		glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.5f, 0.0f), glm::vec3(2.0f, 0.5f, 0.0f), glm::vec3(3.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 0.5f, 1.0f), glm::vec3(1.0f, 1.5f, 1.0f), glm::vec3(2.0f, 1.5f, 1.0f), glm::vec3(3.0f, 0.5f, 1.0f),
+		glm::vec3(0.0f, 0.5f, 2.0f), glm::vec3(1.0f, 1.5f, 2.0f), glm::vec3(2.0f, 1.5f, 2.0f), glm::vec3(3.0f, 0.5f, 2.0f),
+		glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(1.0f, 0.5f, 3.0f), glm::vec3(2.0f, 0.5f, 3.0f), glm::vec3(3.0f, 0.0f, 3.0f)
+	};
+	auto const others = std::vector<std::pair<char const*, std::function<mesh_builder::cpu_mesh ()>>>{
+		{ "cylinder",     [](){ return mesh_builder::buildCylinder(1.0f, 2.0f, 2000u, 2000u); } },
+		{ "cone",         [](){ return mesh_builder::buildCone(1.0f, 2.0f, 2000u, 2000u); } },
+		{ "capsule",      [](){ return mesh_builder::buildCapsule(1.0f, 2.0f, 2000u, 2000u); } },
+		{ "superquadric", [](){ return mesh_builder::buildSuperquadric(glm::vec3(1.0f, 2.0f, 1.0f), 0.3f, 0.6f, 2000u, 2000u); } },
+		{ "bezier patch", [&bezier_control_points](){ return mesh_builder::buildBezierPatch(bezier_control_points, 2000u, 2000u); } }
+	};
+	for (auto const& other : others) {
+		auto const time = time_best_of(3u, [&other](){ other.second(); });
+		std::printf("  %-18s %8.2f ms\n", other.first, time);
+	}
+}
+
+void
+benchmarks::run_ring_collision()
+{
+	std::printf("Ring collision queries, grid against linear scan, best of 3 runs\n");
+
+	std::mt19937 generator(42u);
+	for (std::size_t const rings_nb : { 10u, 100u, 1000u, 10000u, 100000u }) {
+		// A course like the one of the game: rings 10 units apart along
+		// -z, randomly offset sideways.
+		std::uniform_real_distribution<float> offset(-3.0f, 3.0f);
+		auto rings = std::vector<ring_collision::ring>(rings_nb);
+		for (std::size_t i = 0u; i < rings_nb; ++i) {
+			rings[i].center = glm::vec3(offset(generator), offset(generator), -10.0f * static_cast<float>(i));
+			rings[i].axis = glm::vec3(0.0f, 0.0f, 1.0f);
+		}
+		auto const course = RingCourse(rings);
+
+		// Ship positions spread along the whole course.
+		constexpr std::size_t queries_nb = 100000u;
+		std::uniform_real_distribution<float> along(-10.0f * static_cast<float>(rings_nb), 5.0f);
+		auto queries = std::vector<glm::vec3>(queries_nb);
+		for (auto& query : queries)
+			query = glm::vec3(offset(generator), offset(generator), along(generator));
+		constexpr float ship_radius = 0.05f;
+
+		// The linear scan gets fewer queries on long courses to keep the
+		// run short; both are reported per query.
+		auto const linear_queries_nb = std::max<std::size_t>(100u, std::min<std::size_t>(queries_nb, 20000000u / rings_nb));
+
+		std::size_t linear_hits_nb = 0u;
+		auto const linear_time = time_best_of(3u, [&](){
+			linear_hits_nb = 0u;
+			for (std::size_t q = 0u; q < linear_queries_nb; ++q)
+				for (std::size_t i = 0u; i < rings_nb; ++i)
+					if (ring_collision::sweep_tube(course.get_ring(i), queries[q], queries[q], ship_radius)) {
+						++linear_hits_nb;
+						break;
+					}
+		});
+
+		std::size_t grid_hits_nb = 0u;
+		std::size_t linear_range_grid_hits_nb = 0u;
+		std::size_t candidates_total = 0u;
+		auto const grid_time = time_best_of(3u, [&](){
+			grid_hits_nb = 0u;
+			linear_range_grid_hits_nb = 0u;
+			candidates_total = 0u;
+			for (std::size_t q = 0u; q < queries_nb; ++q) {
+				std::size_t candidates_nb = 0u;
+				if (course.find_overlapping_ring(queries[q], ship_radius, &candidates_nb) != RingCourse::npos) {
+					++grid_hits_nb;
+					if (q < linear_queries_nb)
+						++linear_range_grid_hits_nb;
+				}
+				candidates_total += candidates_nb;
+			}
+		});
+
+		std::printf("  %6zu rings  linear: %10.1f ns/query, grid: %6.1f ns/query (%.2f rings tested), hits %s\n",
+		            rings_nb,
+		            1.0e6 * linear_time / static_cast<double>(linear_queries_nb),
+		            1.0e6 * grid_time / static_cast<double>(queries_nb),
+		            static_cast<double>(candidates_total) / static_cast<double>(queries_nb),
+		            linear_hits_nb == linear_range_grid_hits_nb ? "match" : "DIFFER");
+	}
+}
+
+bool
+benchmarks::check_ring_collision()
+{
+	std::printf("Swept ring collisions\n");
+
+	bool all_passed = true;
+	auto const report = [&all_passed](char const* name, bool const passed) {
+		std::printf("  %-44s %s\n", name, passed ? "ok" : "FAILED");
+		all_passed = all_passed && passed;
+	};
+
+	// Three rings 10 units apart along -z, with their hole of radius 1
+	// around the z axis.
+	auto rings = std::vector<ring_collision::ring>(3u);
+	for (std::size_t i = 0u; i < rings.size(); ++i) {
+		rings[i].center = glm::vec3(0.0f, 0.0f, -10.0f * static_cast<float>(i));
+		rings[i].axis = glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+	float const ship_radius = 0.05f;
+
+	// Runs the ship from `from` to `to` in `steps_nb` equal moves, and
+	// records every event.
+	auto const fly = [&rings, ship_radius](glm::vec3 const& from, glm::vec3 const& to, unsigned int const steps_nb) {
+		auto course = RingCourse(rings);
+		course.reset(from);
+		auto events = std::vector<RingCourse::result>();
+		auto previous = from;
+		for (unsigned int step = 1u; step <= steps_nb; ++step) {
+			auto const position = glm::mix(from, to, static_cast<float>(step) / static_cast<float>(steps_nb));
+			auto const result = course.update(previous, position, ship_radius);
+			previous = position;
+			if (result.type == RingCourse::event::none)
+				continue;
+			events.push_back(result);
+			if (result.type != RingCourse::event::passed)
+				break;
+		}
+		return events;
+	};
+	auto const is_single = [](std::vector<RingCourse::result> const& events, RingCourse::event const type, std::size_t const ring) {
+		return events.size() == 1u && events.front().type == type && events.front().ring == ring;
+	};
+
+	// Crossing the tube in one large move, where a point test only sees
+	// both ends, far from the tube.
+	report("tunnelling through the tube is a hit",
+	       is_single(fly(glm::vec3(2.0f, 0.0f, 5.0f), glm::vec3(2.0f, 0.0f, -5.0f), 1u), RingCourse::event::hit, 0u));
+
+	report("crossing outside of the ring is a miss",
+	       is_single(fly(glm::vec3(10.0f, 0.0f, 5.0f), glm::vec3(10.0f, 0.0f, -5.0f), 1u), RingCourse::event::missed, 0u));
+
+	report("going through the hole is a pass",
+	       is_single(fly(glm::vec3(0.9f, 0.0f, 5.0f), glm::vec3(0.9f, 0.0f, -5.0f), 1u), RingCourse::event::passed, 0u));
+
+	// Through all three holes in one move: the last one gets reported.
+	report("several rings passed in one move",
+	       is_single(fly(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f, 0.0f, -25.0f), 1u), RingCourse::event::passed, 2u));
+
+	// Through the hole of ring 0, then into the tube of ring 1; whatever
+	// the number of frames, the run has to end the same way.
+	auto same_outcome = true;
+	for (unsigned int const steps_nb : { 1u, 2u, 7u, 10u, 400u, 10000u }) {
+		auto const events = fly(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(2.0f, 0.0f, -15.0f), steps_nb);
+		same_outcome = same_outcome && !events.empty()
+		            && events.back().type == RingCourse::event::hit && events.back().ring == 1u;
+	}
+	report("same outcome whatever the number of frames", same_outcome);
+
+	// Random moves around one ring: the sweep has to find a contact
+	// whenever dense sampling finds one, and not much later.
+	std::mt19937 generator(7u);
+	std::uniform_real_distribution<float> coordinate(-4.0f, 4.0f);
+	constexpr unsigned int samples_nb = 4000u;
+	unsigned int disagreements_nb = 0u;
+	for (unsigned int move = 0u; move < 2000u; ++move) {
+		auto const from = glm::vec3(coordinate(generator), coordinate(generator), coordinate(generator));
+		auto const to = glm::vec3(coordinate(generator), coordinate(generator), coordinate(generator));
+
+		auto sampled_time = -1.0f;
+		for (unsigned int sample = 0u; sample <= samples_nb && sampled_time < 0.0f; ++sample) {
+			auto const t = static_cast<float>(sample) / static_cast<float>(samples_nb);
+			if (ring_collision::get_tube_distance(rings[0], glm::mix(from, to, t), ship_radius) < 0.0f)
+				sampled_time = t;
+		}
+
+		auto swept_time = 0.0f;
+		auto const is_swept_hit = ring_collision::sweep_tube(rings[0], from, to, ship_radius, &swept_time);
+		if (sampled_time >= 0.0f && (!is_swept_hit || swept_time > sampled_time))
+			++disagreements_nb;
+		if (is_swept_hit && ring_collision::get_tube_distance(rings[0], glm::mix(from, to, swept_time), ship_radius)
+		                    >= ring_collision::contact_tolerance)
+			++disagreements_nb;
+	}
+	report("sweep agrees with dense sampling", disagreements_nb == 0u);
+
+	// A long move skimming the top of the tube, where it is tangent to
+	// the circle running through the top of the tube: the distance only
+	// grows as the fourth power of the offset, so the sphere advances by
+	// steps close to the tolerance over thousands of them.
+	auto const skim = [&rings, ship_radius](float const clearance, float const slope) {
+		auto const height = rings[0].minor_radius + ship_radius + clearance;
+		auto const from = glm::vec3(rings[0].major_radius, -100.0f, height + 100.0f * slope);
+		auto const to = glm::vec3(rings[0].major_radius, 100.0f, height - 100.0f * slope);
+		auto time = -1.0f;
+		auto const is_hit = ring_collision::sweep_tube(rings[0], from, to, ship_radius, &time);
+		return std::make_pair(is_hit, time);
+	};
+	report("long graze above the tolerance is no contact", !skim(2.0e-4f, 0.0f).first);
+	// Going down slightly, it gets within the tolerance past the top.
+	auto const grazing_hit = skim(2.0e-4f, 1.0e-3f);
+	report("long graze into the tube is a contact",
+	       grazing_hit.first && std::abs(grazing_hit.second - 0.5005f) < 1.0e-4f);
+
+	return all_passed;
+}
+
+void
+benchmarks::run_flight_simulation()
+{
+	// A straight course of 1000 rings, flown through the middle.
+	auto rings = std::vector<ring_collision::ring>(1000u);
+	for (std::size_t i = 0u; i < rings.size(); ++i) {
+		rings[i].center = glm::vec3(0.0f, 0.0f, -10.0f - 10.0f * static_cast<float>(i));
+		rings[i].axis = glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+	auto const course = RingCourse(rings);
+
+	std::printf("Flight simulation, %zu rings, no rendering\n", rings.size());
+
+	// As fast as possible, one tick at a time.
+	auto simulation = FlightSimulation(course, flight::ship_state());
+	auto const start_time = std::chrono::high_resolution_clock::now();
+	while (simulation.get_course().get_next_ring() != RingCourse::npos && !simulation.is_over())
+		simulation.tick(flight::controls());
+	auto const duration = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time);
+	std::printf("  %llu ticks in %.2f ms, %.0f ticks per second (%.0fx real time)\n",
+	            static_cast<unsigned long long>(simulation.get_ticks_nb()), 1000.0 * duration.count(),
+	            static_cast<double>(simulation.get_ticks_nb()) / duration.count(),
+	            static_cast<double>(simulation.get_ticks_nb())
+	            * std::chrono::duration<double>(simulation.get_parameters().tick_duration).count() / duration.count());
+
+	// The same minute of game time, split into frames of different
+	// durations.
+	auto const total_time = std::chrono::microseconds(60000000);
+	auto const run_frames = [&course, total_time](std::function<std::chrono::microseconds ()> const& next_frame) {
+		auto frame_simulation = FlightSimulation(course, flight::ship_state());
+		auto elapsed = std::chrono::microseconds(0);
+		while (elapsed < total_time) {
+			auto const frame = std::min(next_frame(), total_time - elapsed);
+			frame_simulation.advance(frame, flight::controls());
+			elapsed += frame;
+		}
+		return frame_simulation;
+	};
+	auto const reference = run_frames([](){ return std::chrono::microseconds(16667); });
+	std::mt19937 generator(3u);
+	std::uniform_int_distribution<long long> frame_us(1000, 50000);
+	auto const frame_rates = std::vector<std::pair<char const*, std::function<std::chrono::microseconds ()>>>{
+		{ "30 Hz",           [](){ return std::chrono::microseconds(33333); } },
+		{ "144 Hz",          [](){ return std::chrono::microseconds(6944); } },
+		{ "1000 Hz",         [](){ return std::chrono::microseconds(1000); } },
+		{ "random 1-50 ms",  [&generator, &frame_us](){ return std::chrono::microseconds(frame_us(generator)); } }
+	};
+	for (auto const& frame_rate : frame_rates) {
+		auto const other = run_frames(frame_rate.second);
+		auto const same = other.get_ticks_nb() == reference.get_ticks_nb()
+		               && other.get_state().position == reference.get_state().position
+		               && other.get_course().get_next_ring() == reference.get_course().get_next_ring();
+		std::printf("  %-16s %llu ticks, next ring %zu: %s as at 60 Hz\n", frame_rate.first,
+		            static_cast<unsigned long long>(other.get_ticks_nb()), other.get_course().get_next_ring(),
+		            same ? "same state" : "DIFFERENT state");
+	}
+}
+
+void
+benchmarks::run_course_streaming()
+{
+	constexpr std::size_t rings_nb = 100000u;
+	constexpr std::size_t window_rings_nb = 10000u;
+
+	auto stream = CourseStream(glm::vec3(0.0f));
+	auto course = stream.make_course();
+	std::printf("Course streaming, %zu rings kept, %zu generated at once\n",
+	            stream.get_parameters().pool_size, stream.get_parameters().chunk_size);
+
+	// A point ship moving in straight lines from one ring centre to the
+	// next; a move of one tick of the game is far shorter.
+	auto position = glm::vec3(0.0f);
+	std::size_t passed_nb = 0u, max_kept_nb = 0u;
+	auto failure = RingCourse::result();
+	auto first_window = std::chrono::duration<double, std::milli>::zero();
+	auto last_window = first_window;
+	while (passed_nb < rings_nb && failure.type == RingCourse::event::none) {
+		auto const start_time = std::chrono::high_resolution_clock::now();
+		auto const target = course.get_ring(course.get_next_ring()).center;
+		auto const event = course.update(position, target, 0.0005f);
+		stream.update(course);
+		auto const duration = std::chrono::high_resolution_clock::now() - start_time;
+		if (passed_nb < window_rings_nb)
+			first_window += duration;
+		else if (passed_nb >= rings_nb - window_rings_nb)
+			last_window += duration;
+
+		position = target;
+		max_kept_nb = std::max(max_kept_nb, course.get_rings_nb() - course.get_first_ring());
+		if (event.type == RingCourse::event::passed)
+			++passed_nb;
+		else
+			failure = event;
+	}
+
+	if (failure.type != RingCourse::event::none)
+		std::printf("  FAILED: %s ring %zu after passing %zu\n",
+		            failure.type == RingCourse::event::hit ? "hit" : "missed", failure.ring, passed_nb);
+	else
+		std::printf("  %zu rings passed, reaching z = %.0f, at most %zu rings kept\n",
+		            passed_nb, static_cast<double>(position.z), max_kept_nb);
+	std::printf("  first %zu rings: %.3f us/ring, last %zu rings: %.3f us/ring\n",
+	            window_rings_nb, 1000.0 * first_window.count() / static_cast<double>(window_rings_nb),
+	            window_rings_nb, 1000.0 * last_window.count() / static_cast<double>(window_rings_nb));
+}
+
+void
+benchmarks::run_spline_track()
+{
+	std::printf("Spline tracks, 32 samples per segment, batches %s\n",
+	            fast_trig::is_vectorized() ? "with SSE2" : "without SIMD on this target");
+
+	std::mt19937 generator(11u);
+	std::uniform_real_distribution<float> offset(-4.0f, 4.0f);
+	for (std::size_t const segments_nb : { 10u, 1000u, 10000u }) {
+		auto control_points = std::vector<glm::vec3>(segments_nb + 3u);
+		for (std::size_t i = 0u; i < control_points.size(); ++i)
+			control_points[i] = glm::vec3(offset(generator), offset(generator), -20.0f * static_cast<float>(i));
+		auto const track = SplineTrack(control_points);
+
+		// Distance lookups at random distances, each a binary search.
+		constexpr std::size_t queries_nb = 100000u;
+		std::uniform_real_distribution<float> along(track.get_start(), track.get_end());
+		auto distances = std::vector<float>(queries_nb);
+		for (auto& distance : distances)
+			distance = along(generator);
+		auto points = std::vector<spline_track::point>(queries_nb);
+		auto const point_time = time_best_of(3u, [&](){
+			for (std::size_t i = 0u; i < queries_nb; ++i)
+				points[i] = track.get_point(distances[i]);
+		});
+
+		// Equal steps along the track should give equally spaced points.
+		auto max_step_error = 0.0f;
+		constexpr float step = 0.5f;
+		auto previous = track.get_position(0.0f);
+		for (int i = 1; static_cast<float>(i) * step < std::min(track.get_end(), 2000.0f); ++i) {
+			auto const position = track.get_position(static_cast<float>(i) * step);
+			max_step_error = std::max(max_step_error, std::abs(glm::length(position - previous) - step) / step);
+			previous = position;
+		}
+
+		// Nearest points of positions around the track, against a scan of
+		// finely sampled chords of a short stretch of it.
+		constexpr std::size_t nearest_nb = 10000u;
+		auto queries = std::vector<glm::vec3>(nearest_nb);
+		for (auto& query : queries)
+			query = track.get_position(along(generator)) + glm::vec3(offset(generator), offset(generator), offset(generator));
+		auto found = std::vector<spline_track::nearest_point>(nearest_nb);
+		auto const nearest_time = time_best_of(3u, [&](){
+			for (std::size_t i = 0u; i < nearest_nb; ++i)
+				found[i] = track.find_nearest(queries[i]);
+		});
+		std::size_t worse_nb = 0u;
+		for (std::size_t i = 0u; i < 200u; ++i) {
+			auto best = std::numeric_limits<float>::infinity();
+			for (int step_index = -800; step_index <= 800; ++step_index) {
+				auto const offset_to_track = track.get_position(found[i].distance + 0.05f * static_cast<float>(step_index))
+				                           - queries[i];
+				best = std::min(best, glm::dot(offset_to_track, offset_to_track));
+			}
+			if (std::sqrt(found[i].squared_distance) > std::sqrt(best) + 0.02f)
+				++worse_nb;
+		}
+
+		// Batches of increasing distances, as when drawing a guide rail.
+		constexpr std::size_t batch_nb = 100000u;
+		auto batch = std::vector<float>(batch_nb);
+		for (std::size_t i = 0u; i < batch_nb; ++i)
+			batch[i] = track.get_start() + (track.get_end() - track.get_start()) * static_cast<float>(i) / static_cast<float>(batch_nb);
+		auto scalar_positions = std::vector<glm::vec3>(batch_nb);
+		auto batched_positions = std::vector<glm::vec3>(batch_nb);
+		auto const scalar_time = time_best_of(3u, [&](){
+			track.get_positions_scalar(batch.data(), batch_nb, scalar_positions.data());
+		});
+		auto const batched_time = time_best_of(3u, [&](){
+			track.get_positions(batch.data(), batch_nb, batched_positions.data());
+		});
+		auto max_difference = 0.0f;
+		for (std::size_t i = 0u; i < batch_nb; ++i)
+			max_difference = std::max(max_difference, glm::length(scalar_positions[i] - batched_positions[i]));
+
+		std::printf("  %6zu segments  point: %6.1f ns, nearest: %7.1f ns (%zu of 200 farther than a dense scan by over 0.02), "
+		            "step error %.4f%%\n",
+		            segments_nb, 1.0e6 * point_time / static_cast<double>(queries_nb),
+		            1.0e6 * nearest_time / static_cast<double>(nearest_nb), worse_nb,
+		            100.0 * static_cast<double>(max_step_error));
+		std::printf("  %6s           batch of %zu: %5.1f ns/point one at a time, %5.1f ns/point batched, "
+		            "largest difference %g\n",
+		            "", batch_nb, 1.0e6 * scalar_time / static_cast<double>(batch_nb),
+		            1.0e6 * batched_time / static_cast<double>(batch_nb),
+		            static_cast<double>(max_difference));
+	}
+}
+
+void
+benchmarks::run_swept_tube()
+{
+	auto const parameters = swept_tube::parameters();
+	auto const rows = parameters.rows_per_segment;
+	std::printf("Swept tubes, %u splits around, %u rows per segment, packed vertices, best of 5 runs\n",
+	            parameters.circle_split_count, rows);
+
+	std::mt19937 generator(13u);
+	std::uniform_real_distribution<float> offset(-4.0f, 4.0f);
+	auto const segments_nb = parameters.segments_capacity;
+	auto control_points = std::vector<glm::vec3>(segments_nb + 3u);
+	for (std::size_t i = 0u; i < control_points.size(); ++i)
+		control_points[i] = glm::vec3(offset(generator), offset(generator), -20.0f * static_cast<float>(i));
+	auto const track = SplineTrack(control_points);
+	auto const first = track.get_first_segment();
+	auto const end = first + track.get_segments_nb();
+
+	// Everything at once, as re-uploading the whole tube would need.
+	auto whole = std::vector<vertex_format::packed_vertex>();
+	auto const whole_time = time_best_of(5u, [&](){
+		whole = vertex_format::pack_interleaved(swept_tube::build(track, parameters));
+	});
+	auto frames = std::vector<mesh_builder::sweep_frame>();
+	swept_tube::compute_frames(track, first, end, rows, swept_tube::make_first_frame(track.get_point(track.get_start())),
+	                           nullptr, frames);
+
+	// Only the last segment, continuing the frames of the one before, as
+	// SweptTube does when a control point is appended.
+	auto const last = end - 1u;
+	auto segment_frames = std::vector<mesh_builder::sweep_frame>();
+	auto segment = std::vector<vertex_format::packed_vertex>();
+	auto const segment_time = time_best_of(5u, [&](){
+		swept_tube::compute_frames(track, last, end, rows, frames[(last - first) * rows], nullptr, segment_frames);
+		segment = vertex_format::pack_interleaved(mesh_builder::buildSweptTube(segment_frames, parameters.radius,
+		                                                                       parameters.circle_split_count));
+	});
+	auto max_difference = 0.0f;
+	for (std::size_t i = 0u; i <= rows; ++i)
+		max_difference = std::max(max_difference, glm::length(segment_frames[i].normal - frames[(last - first) * rows + i].normal));
+
+	std::printf("  %zu segments in one piece: %7.3f ms, %zu bytes\n", segments_nb, whole_time,
+	            whole.size() * sizeof(vertex_format::packed_vertex));
+	std::printf("  last segment alone:    %7.3f ms, %zu bytes, normals within %g of the whole tube's\n", segment_time,
+	            segment.size() * sizeof(vertex_format::packed_vertex), static_cast<double>(max_difference));
+
+	// Moving a control point changes the four segments using it; their
+	// frames have to join the unchanged segment after them.
+	auto moved = track;
+	auto const index = first + segments_nb / 2u;
+	moved.set_control_point(index, moved.get_control_point(index) + glm::vec3(3.0f, 2.0f, 0.0f));
+	auto const run_first = index - 3u, run_end = index + 1u;
+	auto const& start = frames[(run_first - first) * rows];
+	auto const& target = frames[(run_end - first) * rows].normal;
+	auto uncorrected = std::vector<mesh_builder::sweep_frame>();
+	swept_tube::compute_frames(moved, run_first, run_end, rows, start, nullptr, uncorrected);
+	auto corrected = std::vector<mesh_builder::sweep_frame>();
+	auto const moved_time = time_best_of(5u, [&](){
+		swept_tube::compute_frames(moved, run_first, run_end, rows, start, &target, corrected);
+		for (auto s = run_first; s < run_end; ++s) {
+			auto const offset_in_run = static_cast<std::ptrdiff_t>((s - run_first) * rows);
+			segment_frames.assign(corrected.begin() + offset_in_run, corrected.begin() + offset_in_run + rows + 1);
+			segment = vertex_format::pack_interleaved(mesh_builder::buildSweptTube(segment_frames, parameters.radius,
+			                                                                       parameters.circle_split_count));
+		}
+	});
+	auto const get_angle = [](glm::vec3 const& a, glm::vec3 const& b) {
+		return glm::degrees(std::acos(glm::clamp(glm::dot(glm::normalize(a), glm::normalize(b)), -1.0f, 1.0f)));
+	};
+	auto max_turn = 0.0f;
+	for (std::size_t i = 1u; i < corrected.size(); ++i)
+		max_turn = std::max(max_turn, get_angle(corrected[i - 1u].normal, corrected[i].normal));
+	std::printf("  control point moved:   %7.3f ms for 4 segments; twist at the joint %.2f degrees left alone, "
+	            "%.4f once spread, largest turn between rows %.2f degrees\n",
+	            moved_time, static_cast<double>(get_angle(uncorrected.back().normal, target)),
+	            static_cast<double>(get_angle(corrected.back().normal, target)), static_cast<double>(max_turn));
+}
+
+void
+benchmarks::run_frustum_culling()
+{
+	std::printf("Frustum culling, scalar against %s, best of 5 runs\n",
+	            fast_trig::is_vectorized() ? "SSE2" : "the same scalar code (no SIMD on this target)");
+
+	// A camera at the origin looking down -z, as the game starts.
+	auto const world_to_clip = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.01f, 1000.0f)
+	                         * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	auto const frustum = frustum_culling::extract_frustum(world_to_clip);
+
+	std::mt19937 generator(7u);
+	std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> radius(0.1f, 5.0f);
+	for (std::size_t const spheres_nb : { 9u, 1000u, 100000u, 1000000u }) {
+		frustum_culling::SphereSet spheres;
+		for (std::size_t i = 0u; i < spheres_nb; ++i)
+			spheres.add({ glm::vec3(coordinate(generator), coordinate(generator), coordinate(generator)), radius(generator) });
+
+		// Small sets are culled many times over to get measurable times.
+		auto const repeats_nb = std::max<std::size_t>(1u, 1000000u / spheres_nb);
+		auto scalar_visible = std::vector<std::uint8_t>();
+		auto vectorised_visible = std::vector<std::uint8_t>();
+		frustum_culling::statistics scalar_statistics, vectorised_statistics;
+		auto const scalar_time = time_best_of(5u, [&](){
+			for (std::size_t r = 0u; r < repeats_nb; ++r)
+				scalar_statistics = frustum_culling::cull_scalar(frustum, spheres, scalar_visible);
+		});
+		auto const vectorised_time = time_best_of(5u, [&](){
+			for (std::size_t r = 0u; r < repeats_nb; ++r)
+				vectorised_statistics = frustum_culling::cull(frustum, spheres, vectorised_visible);
+		});
+
+		auto const tested_nb = static_cast<double>(spheres_nb * repeats_nb);
+		std::printf("  %7zu spheres  scalar: %5.2f ns/sphere, cull(): %5.2f ns/sphere (x%.1f), %zu visible, results %s\n",
+		            spheres_nb, 1.0e6 * scalar_time / tested_nb, 1.0e6 * vectorised_time / tested_nb,
+		            scalar_time / vectorised_time, vectorised_statistics.visible_nb,
+		            scalar_visible == vectorised_visible && scalar_statistics.visible_nb == vectorised_statistics.visible_nb
+		            ? "match" : "DIFFER");
+	}
+}
+
+bool
+benchmarks::check_texture_compression()
+{
+	using texture_compression::format;
+
+	std::printf("Texture compression\n");
+
+	bool all_passed = true;
+	auto const report = [&all_passed](char const* name, bool const passed, double const psnr = -1.0) {
+		if (psnr >= 0.0)
+			std::printf("  %-44s %s (%.2f dB)\n", name, passed ? "ok" : "FAILED", psnr);
+		else
+			std::printf("  %-44s %s\n", name, passed ? "ok" : "FAILED");
+		all_passed = all_passed && passed;
+	};
+
+	auto const make_image = [](std::uint32_t const width, std::uint32_t const height,
+	                           std::function<std::array<std::uint8_t, 4> (std::uint32_t, std::uint32_t)> const& texel) {
+		texture_compression::image image;
+		image.width = width;
+		image.height = height;
+		image.texels.reserve(static_cast<std::size_t>(width) * height * 4u);
+		for (std::uint32_t y = 0u; y < height; ++y)
+			for (std::uint32_t x = 0u; x < width; ++x)
+				for (auto const channel : texel(x, y))
+					image.texels.push_back(channel);
+		return image;
+	};
+	auto const round_trip = [](texture_compression::image const& image, format const block_format) {
+		auto const blocks = texture_compression::encode(image, block_format);
+		auto const decoded = texture_compression::decode(blocks, block_format, image.width, image.height);
+		return texture_compression::get_psnr(image, decoded, texture_compression::get_channels_nb(block_format));
+	};
+
+	// A colour representable in 5:6:5 has to come back exactly.
+	auto const solid = make_image(8u, 8u, [](std::uint32_t, std::uint32_t) {
+		return std::array<std::uint8_t, 4>{ 255u, 130u, 0u, 255u };
+	});
+	report("BC1 keeps a 5:6:5 colour exactly", std::isinf(round_trip(solid, format::bc1)));
+
+	auto const gradient = make_image(64u, 64u, [](std::uint32_t const x, std::uint32_t const y) {
+		return std::array<std::uint8_t, 4>{ static_cast<std::uint8_t>(4u * x), static_cast<std::uint8_t>(4u * y),
+		                                    static_cast<std::uint8_t>(2u * (x + y)), 255u };
+	});
+	auto psnr = round_trip(gradient, format::bc1);
+	report("BC1 on a colour gradient", psnr > 35.0, psnr);
+	psnr = round_trip(gradient, format::bc4);
+	report("BC4 on a gradient", psnr > 45.0, psnr);
+	psnr = round_trip(gradient, format::bc5);
+	report("BC5 on two gradients", psnr > 45.0, psnr);
+
+	// Noise is the worst case; the error must still be bounded.
+	std::mt19937 generator(19u);
+	std::uniform_int_distribution<int> value(0, 255);
+	auto const noise = make_image(64u, 64u, [&generator, &value](std::uint32_t, std::uint32_t) {
+		auto const grey = value(generator);
+		return std::array<std::uint8_t, 4>{ static_cast<std::uint8_t>(grey), static_cast<std::uint8_t>(255 - grey),
+		                                    static_cast<std::uint8_t>(value(generator) / 4), 255u };
+	});
+	psnr = round_trip(noise, format::bc1);
+	report("BC1 on noise", psnr > 15.0, psnr);
+
+	// Sizes that are not multiples of 4 pad the last blocks.
+	auto const odd = make_image(13u, 7u, [](std::uint32_t const x, std::uint32_t const y) {
+		auto const grey = static_cast<std::uint8_t>(12u * (x + y));
+		return std::array<std::uint8_t, 4>{ grey, grey, grey, 255u };
+	});
+	report("block count of a 13x7 image", texture_compression::encode(odd, format::bc1).size() == 4u * 2u * 8u);
+	psnr = round_trip(odd, format::bc1);
+	report("BC1 on a 13x7 image", psnr > 30.0, psnr);
+
+	auto const mipmaps = texture_compression::make_mipmaps(odd);
+	auto are_mipmaps_sized = mipmaps.size() == 4u && mipmaps.back().width == 1u && mipmaps.back().height == 1u;
+	for (std::size_t level = 1u; level < mipmaps.size(); ++level)
+		are_mipmaps_sized = are_mipmaps_sized && mipmaps[level].width == std::max(13u >> level, 1u)
+		                                      && mipmaps[level].height == std::max(7u >> level, 1u);
+	report("mipmap chain of a 13x7 image", are_mipmaps_sized);
+	auto const uniform_mipmaps = texture_compression::make_mipmaps(solid);
+	report("mipmaps of a uniform image stay uniform",
+	       uniform_mipmaps.back().texels == std::vector<std::uint8_t>(solid.texels.begin(), solid.texels.begin() + 4));
+
+	// Through a file, every level has to come back as written.
+	auto const path = std::string("texture_compression_check.ktx");
+	auto const written = texture_compression::compress(odd, format::bc5);
+	texture_compression::compressed_image read;
+	auto const is_read = texture_compression::write_ktx(written, path) && texture_compression::read_ktx(path, read);
+	report("KTX round trip", is_read && read.block_format == written.block_format
+	                         && read.width == written.width && read.height == written.height
+	                         && read.levels == written.levels);
+
+	// Headers claiming more than the file can hold are rejected before
+	// anything gets allocated from them; the words are overwritten in
+	// place, after the 12-byte identifier.
+	auto const read_with_word = [&path, &written](long const offset, std::uint32_t const value) {
+		if (!texture_compression::write_ktx(written, path))
+			return true;
+		if (auto* const file = std::fopen(path.c_str(), "r+b")) {
+			std::fseek(file, offset, SEEK_SET);
+			std::fwrite(&value, sizeof(value), 1u, file);
+			std::fclose(file);
+		}
+		texture_compression::compressed_image corrupt;
+		return texture_compression::read_ktx(path, corrupt);
+	};
+	report("KTX with too many mipmap levels rejected", !read_with_word(12 + 11 * 4, 1000000u));
+	report("KTX with oversized key-value data rejected", !read_with_word(12 + 12 * 4, 0xfffffff0u));
+	std::remove(path.c_str());
+
+	// A 2K texture, as the ones the assignment loads.
+	auto const large = make_image(2048u, 2048u, [](std::uint32_t const x, std::uint32_t const y) {
+		return std::array<std::uint8_t, 4>{ static_cast<std::uint8_t>(x ^ y), static_cast<std::uint8_t>(x), static_cast<std::uint8_t>(y), 255u };
+	});
+	auto const compress_time = time_best_of(1u, [&large](){ texture_compression::compress(large, format::bc1); });
+	std::printf("  compressing a 2048x2048 image and its mipmaps to BC1 takes %.0f ms\n", compress_time);
+
+	return all_passed;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+//! \brief CPU-only benchmarks and self-checks, runnable without a window
+//!        nor an OpenGL context; see `main()` for the command-line
+//!        switches.
+//!
+//! Results are printed to the standard output.
+namespace benchmarks
+{
+	//! \brief Time the generation of high-resolution parametric shapes
+	//!        with one thread, and then spread over increasingly larger
+	//!        thread pools.
+	void run_mesh_generation();
+
+	//! \brief Compare the shapes generated by parametric_surface::build()
+	//!        against equivalent hand-written loops, and time the other
+	//!        surfaces it provides.
+	void run_surface_engine();
+
+	//! \brief Time ring collision queries against a linear scan over all
+	//!        the rings, for increasingly longer courses.
+	void run_ring_collision();
+
+	//! \brief Check the swept ring collisions on fixed scenarios: fast
+	//!        moves that would tunnel through a point test, moves split
+	//!        into different numbers of frames, and random moves against
+	//!        dense sampling.
+	//!
+	//! @return whether every scenario gave the expected result
+	bool check_ring_collision();
+
+	//! \brief Time the flight simulation without rendering, and check
+	//!        that feeding it the same time at different frame rates
+	//!        ends in the same state.
+	void run_flight_simulation();
+
+	//! \brief Fly through a long streamed course, ring centre to ring
+	//!        centre, checking that every ring is passed and timing the
+	//!        streaming at the start and at the end of it.
+	void run_course_streaming();
+
+	//! \brief Time distance lookups, nearest-point queries and batched
+	//!        sampling of long spline tracks, and check them against
+	//!        brute-force and one-at-a-time results.
+	void run_spline_track();
+
+	//! \brief Time regenerating one segment of a swept tube against the
+	//!        whole of it, and check how a moved control point joins the
+	//!        rest of the tube.
+	void run_swept_tube();
+
+	//! \brief Time frustum culling of many bounding spheres, one at a time
+	//!        and vectorised, and check that both agree.
+	void run_frustum_culling();
+
+	//! \brief Compress synthetic images, decode them back on the CPU and
+	//!        check the error, the mipmap chains and the KTX round trip.
+	//!
+	//! @return whether every check passed
+	bool check_texture_compression();
+}
@@ -0,0 +1,116 @@
+#include "course_stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+glm::mat4
+course_stream::get_model_to_world(ring_collision::ring const& r)
+{
+	auto const y = glm::normalize(r.axis);
+	auto const reference = std::abs(y.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+	auto const x = glm::normalize(glm::cross(reference, y));
+	auto const z = glm::cross(x, y);
+	return glm::mat4(glm::vec4(x, 0.0f), glm::vec4(y, 0.0f), glm::vec4(z, 0.0f), glm::vec4(r.center, 1.0f));
+}
+
+CourseStream::CourseStream(glm::vec3 const& start, course_stream::parameters const& parameters) :
+	_parameters(parameters), _generator(parameters.seed), _track(parameters.tension)
+{
+	assert(_parameters.chunk_size > 0u && _parameters.ring_spacing > 0.0f);
+	assert(_parameters.pool_size > _parameters.kept_behind_nb + _parameters.chunk_size);
+
+	// The first segment runs straight ahead from the start.
+	auto const step = glm::vec3(0.0f, 0.0f, -_parameters.control_spacing);
+	_track.append(start - step);
+	_track.append(start);
+	_track.append(start + step);
+	_last_control_point = start + step;
+	append_control_point();
+}
+
+RingCourse
+CourseStream::make_course()
+{
+	auto rings = std::vector<ring_collision::ring>();
+	rings.reserve(_parameters.pool_size);
+	for (std::size_t i = 0u; i < _parameters.pool_size; ++i)
+		rings.push_back(generate_ring());
+	return RingCourse(std::move(rings));
+}
+
+std::size_t
+CourseStream::update(RingCourse& course)
+{
+	auto next = course.get_next_ring();
+	if (next == RingCourse::npos)
+		next = course.get_rings_nb();
+
+	std::size_t appended_nb = 0u;
+	while (next >= course.get_first_ring() + _parameters.kept_behind_nb + _parameters.chunk_size) {
+		course.drop_rings_before(course.get_first_ring() + _parameters.chunk_size);
+		_chunk.clear();
+		for (std::size_t i = 0u; i < _parameters.chunk_size; ++i)
+			_chunk.push_back(generate_ring());
+		course.append(_chunk);
+		appended_nb += _parameters.chunk_size;
+	}
+	if (appended_nb > 0u)
+		_track.drop_segments_before(get_ring_distance(course.get_first_ring()));
+	return std::min(appended_nb, course.get_rings_nb() - course.get_first_ring());
+}
+
+std::size_t
+CourseStream::get_slot(std::size_t const ring) const
+{
+	return ring % _parameters.pool_size;
+}
+
+float
+CourseStream::get_ring_distance(std::size_t const ring) const
+{
+	return static_cast<float>(ring + 1u) * _parameters.ring_spacing;
+}
+
+SplineTrack const&
+CourseStream::get_track() const
+{
+	return _track;
+}
+
+course_stream::parameters const&
+CourseStream::get_parameters() const
+{
+	return _parameters;
+}
+
+ring_collision::ring
+CourseStream::generate_ring()
+{
+	auto const distance = get_ring_distance(_generated_nb++);
+	while (_track.get_end() < distance)
+		append_control_point();
+
+	auto const p = _track.get_point(distance);
+	ring_collision::ring r;
+	r.center = p.position;
+	r.axis = p.tangent;
+	r.major_radius = _parameters.major_radius;
+	r.minor_radius = _parameters.minor_radius;
+	return r;
+}
+
+void
+CourseStream::append_control_point()
+{
+	_last_control_point += glm::vec3(_parameters.max_offset.x * get_random_offset(),
+	                                 _parameters.max_offset.y * get_random_offset(),
+	                                 -_parameters.control_spacing);
+	_track.append(_last_control_point);
+}
+
+float
+CourseStream::get_random_offset()
+{
+	return 2.0f * (static_cast<float>(_generator()) / 4294967295.0f) - 1.0f;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ring_collision.hpp"
+#include "spline_track.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+//! \brief Generation of an endless course, streamed ahead of the ship.
+namespace course_stream
+{
+	struct parameters {
+		std::uint32_t seed{1u};
+		//! Rings kept in the course at any time, and tori drawn for them.
+		std::size_t   pool_size{16u};
+		//! Rings generated, and dropped, at once.
+		std::size_t   chunk_size{4u};
+		//! Passed rings kept before dropping any, so that the ones right
+		//! behind the ship still collide.
+		std::size_t   kept_behind_nb{2u};
+		//! Distance along -z between two control points.
+		float         control_spacing{20.0f};
+		//! Distance along the spline between two rings.
+		float         ring_spacing{10.0f};
+		//! Largest offset from one control point to the next, sideways
+		//! and vertically; the course has to stay flyable at the turn
+		//! rate of the ship.
+		glm::vec2     max_offset{4.0f, 2.0f};
+		float         tension{0.5f};
+		//! Sizes of the rings; they must match the torus mesh drawn.
+		float         major_radius{2.0f};
+		float         minor_radius{1.0f};
+	};
+
+	//! \brief Transform placing a torus as created by buildTorus(), built
+	//!        around the y axis, on a ring.
+	glm::mat4 get_model_to_world(ring_collision::ring const& r);
+}
+
+//! \brief Generates the rings of a course ahead of the ship, and drops
+//!        the ones behind it, so that memory and per-frame costs stay
+//!        the same however far the ship flies.
+//!
+//! Control points are laid along -z, each randomly offset from the
+//! previous one, and rings are placed at regular distances along the
+//! SplineTrack running through them, facing along it. The course always holds `pool_size`
+//! consecutive rings; ring `i` can therefore be drawn by slot
+//! get_slot(i) of a fixed pool of tori, recycling the slot of a dropped
+//! ring for the one appended in its place.
+//!
+//! The rings only depend on the seed: a replay streams the same course
+//! as the recorded run.
+class CourseStream {
+public:
+	//! @param [in] start the position the ship starts from; the first ring
+	//!             is one ring spacing ahead of it
+	explicit CourseStream(glm::vec3 const& start,
+	                      course_stream::parameters const& parameters = course_stream::parameters());
+
+	//! \brief Generate the first `pool_size` rings.
+	RingCourse make_course();
+
+	//! \brief Once enough rings are passed, drop them from `course` and
+	//!        append as many new ones; to be called between ticks.
+	//!
+	//! @return the number of rings appended, which are the last ones of
+	//!         the course
+	std::size_t update(RingCourse& course);
+
+	//! \brief Slot of the pool drawing ring `ring`.
+	std::size_t get_slot(std::size_t ring) const;
+
+	//! \brief Distance of ring `ring` along the track.
+	float get_ring_distance(std::size_t ring) const;
+
+	//! \brief The spline the rings are placed on, covering at least the
+	//!        rings kept in the course.
+	SplineTrack const& get_track() const;
+
+	course_stream::parameters const& get_parameters() const;
+
+private:
+	ring_collision::ring generate_ring();
+	void append_control_point();
+	// Between -1 and 1, computed the same way on every standard library.
+	float get_random_offset();
+
+	course_stream::parameters         _parameters;
+	std::mt19937                      _generator;
+	SplineTrack                       _track;
+	glm::vec3                         _last_control_point{0.0f};
+	std::size_t                       _generated_nb{0u};
+	std::vector<ring_collision::ring> _chunk;
+};
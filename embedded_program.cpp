@@ -0,0 +1,86 @@
+#include "embedded_program.hpp"
+
+#include <string>
+
+namespace
+{
+	GLuint compile_shader(char const* name, GLenum const type, char const* source)
+	{
+		auto const shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint status = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+		if (status == GL_TRUE)
+			return shader;
+
+		GLint log_length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+		auto log = std::string(static_cast<std::size_t>(log_length) + 1u, '\0');
+		glGetShaderInfoLog(shader, log_length, nullptr, &log[0]);
+		LogError("Failed to compile the %s shader of \"%s\":\n%s",
+		         type == GL_VERTEX_SHADER ? "vertex" : "fragment", name, log.c_str());
+		glDeleteShader(shader);
+		return 0u;
+	}
+
+	// Return `program` if it linked, log why and delete it otherwise.
+	GLuint check_link(char const* name, GLuint const program)
+	{
+		GLint status = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if (status == GL_TRUE)
+			return program;
+
+		GLint log_length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+		auto log = std::string(static_cast<std::size_t>(log_length) + 1u, '\0');
+		glGetProgramInfoLog(program, log_length, nullptr, &log[0]);
+		LogError("Failed to link \"%s\":\n%s", name, log.c_str());
+		glDeleteProgram(program);
+		return 0u;
+	}
+}
+
+GLuint
+embedded_program::create(char const* name, char const* vertex_source, char const* fragment_source)
+{
+	auto const vertex_shader = compile_shader(name, GL_VERTEX_SHADER, vertex_source);
+	auto const fragment_shader = compile_shader(name, GL_FRAGMENT_SHADER, fragment_source);
+	if (vertex_shader == 0u || fragment_shader == 0u) {
+		glDeleteShader(vertex_shader);
+		glDeleteShader(fragment_shader);
+		return 0u;
+	}
+
+	auto const program = glCreateProgram();
+	glAttachShader(program, vertex_shader);
+	glAttachShader(program, fragment_shader);
+	glLinkProgram(program);
+	glDetachShader(program, vertex_shader);
+	glDetachShader(program, fragment_shader);
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+
+	return check_link(name, program);
+}
+
+GLuint
+embedded_program::create_feedback(char const* name, char const* vertex_source,
+                                  char const* const* varyings, GLsizei const varyings_nb)
+{
+	auto const vertex_shader = compile_shader(name, GL_VERTEX_SHADER, vertex_source);
+	if (vertex_shader == 0u)
+		return 0u;
+
+	auto const program = glCreateProgram();
+	glAttachShader(program, vertex_shader);
+	// Only taken into account by the next link.
+	glTransformFeedbackVaryings(program, varyings_nb, varyings, GL_INTERLEAVED_ATTRIBS);
+	glLinkProgram(program);
+	glDetachShader(program, vertex_shader);
+	glDeleteShader(vertex_shader);
+
+	return check_link(name, program);
+}
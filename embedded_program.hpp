@@ -0,0 +1,39 @@
+#pragma once
+
+#include "core/helpers.hpp"
+
+//! \brief Shader programs whose sources are compiled into the
+//!        executable.
+//!
+//! Used by the rendering paths added on top of the framework, whose
+//! shaders are tied to the C++ code feeding them (attribute locations,
+//! uniform blocks) rather than meant to be edited and reloaded at
+//! runtime like the ones handled by ShaderProgramManager.
+namespace embedded_program
+{
+	//! \brief Compile and link a program out of a vertex and a fragment
+	//!        shader.
+	//!
+	//! Compilation and link errors are logged along with `name`.
+	//!
+	//! @param [in] name the name used in log messages
+	//! @param [in] vertex_source the GLSL source of the vertex shader
+	//! @param [in] fragment_source the GLSL source of the fragment shader
+	//! @return the program, or 0 if it failed to compile or link
+	GLuint create(char const* name, char const* vertex_source, char const* fragment_source);
+
+	//! \brief Compile and link a program made of a vertex shader only,
+	//!        capturing some of its outputs with transform feedback.
+	//!
+	//! The outputs are interleaved, in the order given, in the buffer
+	//! bound to GL_TRANSFORM_FEEDBACK_BUFFER; draw with
+	//! GL_RASTERIZER_DISCARD enabled, as there is no fragment shader.
+	//!
+	//! @param [in] name the name used in log messages
+	//! @param [in] vertex_source the GLSL source of the vertex shader
+	//! @param [in] varyings the names of the outputs to capture
+	//! @param [in] varyings_nb the number of names in `varyings`
+	//! @return the program, or 0 if it failed to compile or link
+	GLuint create_feedback(char const* name, char const* vertex_source,
+	                       char const* const* varyings, GLsizei varyings_nb);
+}
@@ -0,0 +1,118 @@
+#include "fast_trig.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Number of 4-wide rotation steps between two re-seedings. Each step
+	// adds roughly one float epsilon of error, so this keeps the total
+	// well below fast_trig::tolerance.
+	constexpr unsigned int reseed_interval = 16u;
+}
+
+fast_trig::sincos_table
+fast_trig::make_sincos_table_scalar(float const start, float const step, unsigned int const count)
+{
+	sincos_table table;
+	table.cos.resize(count);
+	table.sin.resize(count);
+
+	float angle = start;
+	for (unsigned int i = 0u; i < count; ++i) {
+		table.cos[i] = std::cos(angle);
+		table.sin[i] = std::sin(angle);
+		angle += step;
+	}
+
+	return table;
+}
+
+#if defined(FAST_TRIG_USE_SSE2)
+
+fast_trig::sincos_table
+fast_trig::make_sincos_table(float const start, float const step, unsigned int const count)
+{
+	constexpr unsigned int lanes = 4u;
+
+	// Pad to a whole number of lanes so every store is a full one.
+	auto const padded_count = (count + lanes - 1u) / lanes * lanes;
+	sincos_table table;
+	table.cos.resize(padded_count);
+	table.sin.resize(padded_count);
+
+	auto const lanes_step = static_cast<double>(step) * lanes;
+	auto const cos_step = _mm_set1_ps(static_cast<float>(std::cos(lanes_step)));
+	auto const sin_step = _mm_set1_ps(static_cast<float>(std::sin(lanes_step)));
+
+	for (unsigned int seed = 0u; seed < padded_count; seed += lanes * reseed_interval) {
+		alignas(16) float seed_cos[lanes];
+		alignas(16) float seed_sin[lanes];
+		for (unsigned int l = 0u; l < lanes; ++l) {
+			auto const angle = static_cast<double>(start) + static_cast<double>(step) * static_cast<double>(seed + l);
+			seed_cos[l] = static_cast<float>(std::cos(angle));
+			seed_sin[l] = static_cast<float>(std::sin(angle));
+		}
+
+		auto c = _mm_load_ps(seed_cos);
+		auto s = _mm_load_ps(seed_sin);
+		auto const end = std::min(seed + lanes * reseed_interval, padded_count);
+		for (unsigned int i = seed; i < end; i += lanes) {
+			_mm_storeu_ps(table.cos.data() + i, c);
+			_mm_storeu_ps(table.sin.data() + i, s);
+
+			auto const next_c = _mm_sub_ps(_mm_mul_ps(c, cos_step), _mm_mul_ps(s, sin_step));
+			auto const next_s = _mm_add_ps(_mm_mul_ps(s, cos_step), _mm_mul_ps(c, sin_step));
+			c = next_c;
+			s = next_s;
+		}
+	}
+
+	table.cos.resize(count);
+	table.sin.resize(count);
+	return table;
+}
+
+bool
+fast_trig::is_vectorized()
+{
+	return true;
+}
+
+#else
+
+fast_trig::sincos_table
+fast_trig::make_sincos_table(float const start, float const step, unsigned int const count)
+{
+	// Unlike make_sincos_table_scalar(), recompute each angle instead of
+	// accumulating it, so the error does not grow with the count.
+	sincos_table table;
+	table.cos.resize(count);
+	table.sin.resize(count);
+	for (unsigned int i = 0u; i < count; ++i) {
+		auto const angle = static_cast<double>(start) + static_cast<double>(step) * static_cast<double>(i);
+		table.cos[i] = static_cast<float>(std::cos(angle));
+		table.sin[i] = static_cast<float>(std::sin(angle));
+	}
+	return table;
+}
+
+bool
+fast_trig::is_vectorized()
+{
+	return false;
+}
+
+#endif
+
+float
+fast_trig::max_error(sincos_table const& table, float const start, float const step)
+{
+	float error = 0.0f;
+	for (std::size_t i = 0u; i < table.cos.size(); ++i) {
+		auto const angle = static_cast<double>(start) + static_cast<double>(step) * static_cast<double>(i);
+		error = std::max(error, static_cast<float>(std::abs(table.cos[i] - std::cos(angle))));
+		error = std::max(error, static_cast<float>(std::abs(table.sin[i] - std::sin(angle))));
+	}
+	return error;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+//! \brief Defined, along with the SSE2 intrinsics, on targets with SSE2;
+//!        the vectorised paths of the other modules test it as well.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define FAST_TRIG_USE_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+//! \brief Batched sine and cosine evaluation for the parametric shape
+//!        generators.
+//!
+//! The generators only need sin and cos at evenly spaced angles, which
+//! can be obtained from a handful of libm calls and the angle-addition
+//! formulas
+//!
+//!     cos(a + d) = cos(a) cos(d) - sin(a) sin(d)
+//!     sin(a + d) = sin(a) cos(d) + cos(a) sin(d)
+//!
+//! evaluated on four angles at once with SSE2 when available. The
+//! recurrence is re-seeded from libm every few iterations so that the
+//! rounding errors stay below `tolerance`.
+namespace fast_trig
+{
+	//! \brief Maximum absolute error of the vectorised path compared to
+	//!        std::sin and std::cos.
+	constexpr float tolerance = 1.0e-5f;
+
+	//! \brief Sine and cosine of `start + i * step`, for i in [0, count).
+	struct sincos_table {
+		std::vector<float> cos;
+		std::vector<float> sin;
+	};
+
+	//! \brief Fill a table with the vectorised recurrence, or with the
+	//!        scalar path on targets without SIMD support.
+	//!
+	//! @param [in] start the first angle, in radians
+	//! @param [in] step the difference between two consecutive angles
+	//! @param [in] count the number of angles
+	//! @return the table
+	sincos_table make_sincos_table(float start, float step, unsigned int count);
+
+	//! \brief Fill a table with one std::sin and one std::cos call per
+	//!        angle, accumulating the angle the same way the original
+	//!        generator loops did; their output is bit-identical.
+	//!
+	//! @param [in] start the first angle, in radians
+	//! @param [in] step the difference between two consecutive angles
+	//! @param [in] count the number of angles
+	//! @return the table
+	sincos_table make_sincos_table_scalar(float start, float step, unsigned int count);
+
+	//! \brief Largest absolute difference between a table and the values
+	//!        computed in double precision.
+	float max_error(sincos_table const& table, float start, float step);
+
+	//! \brief Whether make_sincos_table(), SplineTrack::get_positions()
+	//!        and frustum_culling::cull() use SIMD instructions on this
+	//!        target.
+	bool is_vectorized();
+}
@@ -0,0 +1,160 @@
+#include "flight_simulation.hpp"
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+	// Rotation turning by `pitch` around the right axis of the ship, then
+	// by `yaw` around its up axis, in its own frame.
+	glm::mat3 make_local_rotation(float const pitch, float const yaw)
+	{
+		auto const cos_pitch = std::cos(pitch);
+		auto const sin_pitch = std::sin(pitch);
+		auto const cos_yaw = std::cos(yaw);
+		auto const sin_yaw = std::sin(yaw);
+		auto const around_right = glm::mat3(glm::vec3(1.0f, 0.0f, 0.0f),
+		                                    glm::vec3(0.0f, cos_pitch, sin_pitch),
+		                                    glm::vec3(0.0f, -sin_pitch, cos_pitch));
+		auto const around_up = glm::mat3(glm::vec3(cos_yaw, 0.0f, -sin_yaw),
+		                                 glm::vec3(0.0f, 1.0f, 0.0f),
+		                                 glm::vec3(sin_yaw, 0.0f, cos_yaw));
+		return around_right * around_up;
+	}
+
+	// Remove the drift accumulated by chaining many small rotations.
+	glm::mat3 orthonormalize(glm::mat3 const& orientation)
+	{
+		auto const back = glm::normalize(orientation[2]);
+		auto const right = glm::normalize(glm::cross(orientation[1], back));
+		auto const up = glm::cross(back, right);
+		return glm::mat3(right, up, back);
+	}
+}
+
+glm::vec3
+flight::ship_state::get_front() const
+{
+	return -orientation[2];
+}
+
+glm::vec3
+flight::ship_state::get_up() const
+{
+	return orientation[1];
+}
+
+FlightSimulation::FlightSimulation(RingCourse course, flight::ship_state const& start,
+                                   flight::parameters const& parameters) :
+	_course(std::move(course)), _parameters(parameters), _state(start), _previous_state(start)
+{
+	_course.reset(start.position);
+}
+
+unsigned int
+FlightSimulation::advance(std::chrono::microseconds const elapsed, flight::controls const& controls)
+{
+	if (_is_over)
+		return 0u;
+
+	_accumulator += elapsed;
+	unsigned int ticks_nb = 0u;
+	while (_accumulator >= _parameters.tick_duration && !_is_over) {
+		if (ticks_nb == _parameters.max_ticks_per_advance) {
+			// Too far behind: drop the backlog rather than freezing.
+			_accumulator %= _parameters.tick_duration;
+			break;
+		}
+		tick(controls);
+		_accumulator -= _parameters.tick_duration;
+		++ticks_nb;
+	}
+	if (_is_over)
+		_accumulator = std::chrono::microseconds(0);
+	return ticks_nb;
+}
+
+void
+FlightSimulation::tick(flight::controls const& controls)
+{
+	if (_is_over)
+		return;
+
+	auto const dt = std::chrono::duration<float>(_parameters.tick_duration).count();
+	_previous_state = _state;
+
+	// Move along the current heading, then turn.
+	_state.position += _state.get_front() * (_parameters.speed * dt);
+	_last_pitch = glm::clamp(controls.pitch, -1.0f, 1.0f) * _parameters.turn_rate * dt;
+	_last_yaw = glm::clamp(controls.yaw, -1.0f, 1.0f) * _parameters.turn_rate * dt;
+	_state.orientation = orthonormalize(_state.orientation * make_local_rotation(_last_pitch, _last_yaw));
+	++_ticks_nb;
+
+	auto event = RingCourse::result();
+	{
+		PROFILE_ZONE("collision");
+		event = _course.update(_previous_state.position, _state.position, _parameters.ship_radius);
+	}
+	if (event.type == RingCourse::event::none)
+		return;
+	_last_event = event;
+	_is_over = event.type == RingCourse::event::hit || event.type == RingCourse::event::missed;
+}
+
+flight::ship_state const&
+FlightSimulation::get_state() const
+{
+	return _state;
+}
+
+flight::ship_state
+FlightSimulation::get_interpolated_state() const
+{
+	auto const alpha = static_cast<float>(_accumulator.count())
+	                 / static_cast<float>(_parameters.tick_duration.count());
+
+	flight::ship_state state;
+	state.position = glm::mix(_previous_state.position, _state.position, alpha);
+	state.orientation = orthonormalize(_previous_state.orientation
+	                                   * make_local_rotation(alpha * _last_pitch, alpha * _last_yaw));
+	return state;
+}
+
+bool
+FlightSimulation::is_over() const
+{
+	return _is_over;
+}
+
+RingCourse::result const&
+FlightSimulation::get_last_event() const
+{
+	return _last_event;
+}
+
+RingCourse const&
+FlightSimulation::get_course() const
+{
+	return _course;
+}
+
+RingCourse&
+FlightSimulation::get_course()
+{
+	return _course;
+}
+
+std::uint64_t
+FlightSimulation::get_ticks_nb() const
+{
+	return _ticks_nb;
+}
+
+flight::parameters const&
+FlightSimulation::get_parameters() const
+{
+	return _parameters;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ring_collision.hpp"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+//! \brief State and controls of the ship, independent of rendering.
+namespace flight
+{
+	//! \brief What the player asks for during a tick, each axis in [-1, 1].
+	struct controls {
+		float pitch{0.0f}; //!< positive turns the nose up
+		float yaw{0.0f};   //!< positive turns the nose left
+	};
+
+	struct ship_state {
+		glm::vec3 position{0.0f};
+		//! Columns are the right, up and back directions of the ship.
+		glm::mat3 orientation{1.0f};
+
+		glm::vec3 get_front() const;
+		glm::vec3 get_up() const;
+	};
+
+	struct parameters {
+		//! Duration of a simulation tick; an integer number of
+		//! microseconds, so that any split of the same elapsed time runs
+		//! the same ticks.
+		std::chrono::microseconds tick_duration{8000};
+		//! Ticks run at most by one advance(), so that a long stall does
+		//! not have to be caught up all at once.
+		unsigned int max_ticks_per_advance{30u};
+		float speed{3.0f};          //!< in units per second
+		float turn_rate{0.3f};      //!< in radians per second
+		float ship_radius{0.0005f};
+	};
+}
+
+//! \brief Fixed-timestep simulation of the ship flying the course.
+//!
+//! The elapsed time given to advance() is accumulated, and consumed one
+//! tick of `tick_duration` at a time, so the outcome only depends on the
+//! controls of each tick and not on the frame rate. What is left in the
+//! accumulator is used to interpolate between the last two ticks when
+//! rendering. Nothing here needs a window nor an OpenGL context.
+class FlightSimulation {
+public:
+	FlightSimulation(RingCourse course, flight::ship_state const& start,
+	                 flight::parameters const& parameters = flight::parameters());
+
+	//! \brief Run as many ticks as fit in the accumulated time.
+	//!
+	//! @param [in] elapsed the time since the previous call
+	//! @param [in] controls the controls applied during every tick run
+	//! @return the number of ticks run
+	unsigned int advance(std::chrono::microseconds elapsed, flight::controls const& controls);
+
+	//! \brief Run exactly one tick, leaving the accumulator untouched;
+	//!        does nothing once the run is over.
+	void tick(flight::controls const& controls);
+
+	//! \brief State at the last tick.
+	flight::ship_state const& get_state() const;
+
+	//! \brief State between the last two ticks, matching the time left
+	//!        in the accumulator; this is what should be rendered.
+	flight::ship_state get_interpolated_state() const;
+
+	//! \brief Whether the ship hit or missed a ring.
+	bool is_over() const;
+
+	//! \brief Last event reported by the course, other than none.
+	RingCourse::result const& get_last_event() const;
+
+	RingCourse const& get_course() const;
+	//! \brief The course, e.g. to stream rings in and out of it between
+	//!        ticks; see CourseStream.
+	RingCourse& get_course();
+	std::uint64_t get_ticks_nb() const;
+	flight::parameters const& get_parameters() const;
+
+private:
+	RingCourse                 _course;
+	flight::parameters         _parameters;
+	flight::ship_state         _state;
+	flight::ship_state         _previous_state;
+	// Rotation applied by the last tick, reapplied partially when
+	// interpolating.
+	float                      _last_pitch{0.0f};
+	float                      _last_yaw{0.0f};
+	std::chrono::microseconds  _accumulator{0};
+	std::uint64_t              _ticks_nb{0u};
+	RingCourse::result         _last_event;
+	bool                       _is_over{false};
+};
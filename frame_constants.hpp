@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+//! \brief Camera, lighting and material constants shared by every draw
+//!        of a frame, laid out as the std140 block `glsl_declaration`.
+//!
+//! A program declaring that block reads them from the uniform buffer
+//! bound at `binding`; the others get them as individual uniforms of the
+//! same names. The embedded shaders paste the declaration after their
+//! #version line.
+struct frame_constants {
+	glm::mat4     vertex_world_to_clip;
+	glm::vec3     light_position;
+	float         padding0;
+	glm::vec3     camera_position;
+	float         padding1;
+	glm::vec3     ambient;
+	float         padding2;
+	glm::vec3     diffuse;
+	float         padding3;
+	glm::vec3     specular;
+	float         shininess;
+	std::int32_t  use_normal_mapping;
+	float         padding4[3];
+
+	static constexpr char const* block_name = "FrameConstants";
+	static constexpr unsigned int binding = 0u;
+
+	static constexpr char const* glsl_declaration =
+		"layout (std140) uniform FrameConstants\n"
+		"{\n"
+		"	mat4  vertex_world_to_clip;\n"
+		"	vec3  light_position;\n"
+		"	vec3  camera_position;\n"
+		"	vec3  ambient;\n"
+		"	vec3  diffuse;\n"
+		"	vec3  specular;\n"
+		"	float shininess;\n"
+		"	bool  use_normal_mapping;\n"
+		"};\n";
+};
+
+static_assert(offsetof(frame_constants, light_position) == 64u, "std140 mismatch");
+static_assert(offsetof(frame_constants, camera_position) == 80u, "std140 mismatch");
+static_assert(offsetof(frame_constants, ambient) == 96u, "std140 mismatch");
+static_assert(offsetof(frame_constants, diffuse) == 112u, "std140 mismatch");
+static_assert(offsetof(frame_constants, specular) == 128u, "std140 mismatch");
+static_assert(offsetof(frame_constants, shininess) == 140u, "std140 mismatch");
+static_assert(offsetof(frame_constants, use_normal_mapping) == 144u, "std140 mismatch");
+static_assert(sizeof(frame_constants) == 160u, "std140 mismatch");
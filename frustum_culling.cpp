@@ -0,0 +1,213 @@
+#include "frustum_culling.hpp"
+
+#include "fast_trig.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Summed in the same order as the vectorised path, so that both agree
+	// on spheres exactly touching a plane.
+	float get_plane_distance(glm::vec4 const& plane, glm::vec3 const& point)
+	{
+		return (point.x * plane.x + point.y * plane.y) + (point.z * plane.z + plane.w);
+	}
+
+	// Test spheres [first, end) one at a time.
+	std::size_t cull_range(frustum_culling::frustum const& f, frustum_culling::SphereSet const& spheres,
+	                       std::size_t const first, std::size_t const end, std::vector<std::uint8_t>& visible)
+	{
+		std::size_t visible_nb = 0u;
+		for (std::size_t i = first; i < end; ++i) {
+			auto const is_visible = frustum_culling::is_visible(f, spheres.get(i));
+			visible[i] = is_visible ? 1u : 0u;
+			visible_nb += is_visible ? 1u : 0u;
+		}
+		return visible_nb;
+	}
+}
+
+frustum_culling::frustum
+frustum_culling::extract_frustum(glm::mat4 const& world_to_clip)
+{
+	// Rows of the matrix; glm stores it column by column.
+	auto const row = [&world_to_clip](glm::length_t const r) {
+		return glm::vec4(world_to_clip[0][r], world_to_clip[1][r], world_to_clip[2][r], world_to_clip[3][r]);
+	};
+	auto const x = row(0), y = row(1), z = row(2), w = row(3);
+
+	frustum f;
+	f.planes = { w + x, w - x, w + y, w - y, w + z, w - z };
+	for (auto& plane : f.planes)
+		plane = plane / glm::length(glm::vec3(plane));
+	return f;
+}
+
+frustum_culling::sphere
+frustum_culling::transform_bounds(mesh_builder::bounds const& bounds, glm::mat4 const& model_to_world)
+{
+	auto const scale = std::sqrt(std::max(std::max(glm::dot(glm::vec3(model_to_world[0]), glm::vec3(model_to_world[0])),
+	                                                glm::dot(glm::vec3(model_to_world[1]), glm::vec3(model_to_world[1]))),
+	                                       glm::dot(glm::vec3(model_to_world[2]), glm::vec3(model_to_world[2]))));
+	sphere s;
+	s.center = glm::vec3(model_to_world * glm::vec4(bounds.get_center(), 1.0f));
+	s.radius = bounds.get_radius() * scale;
+	return s;
+}
+
+bool
+frustum_culling::is_visible(frustum const& f, sphere const& s)
+{
+	for (auto const& plane : f.planes)
+		if (get_plane_distance(plane, s.center) < -s.radius)
+			return false;
+	return true;
+}
+
+float
+frustum_culling::get_near_distance(frustum const& f, sphere const& s)
+{
+	return get_plane_distance(f.planes[4], s.center) - s.radius;
+}
+
+std::size_t
+frustum_culling::SphereSet::add(sphere const& s)
+{
+	_x.push_back(s.center.x);
+	_y.push_back(s.center.y);
+	_z.push_back(s.center.z);
+	_radius.push_back(s.radius);
+	return _x.size() - 1u;
+}
+
+void
+frustum_culling::SphereSet::set(std::size_t const index, sphere const& s)
+{
+	_x[index] = s.center.x;
+	_y[index] = s.center.y;
+	_z[index] = s.center.z;
+	_radius[index] = s.radius;
+}
+
+frustum_culling::sphere
+frustum_culling::SphereSet::get(std::size_t const index) const
+{
+	sphere s;
+	s.center = glm::vec3(_x[index], _y[index], _z[index]);
+	s.radius = _radius[index];
+	return s;
+}
+
+void
+frustum_culling::SphereSet::clear()
+{
+	_x.clear();
+	_y.clear();
+	_z.clear();
+	_radius.clear();
+}
+
+std::size_t
+frustum_culling::SphereSet::size() const
+{
+	return _x.size();
+}
+
+std::vector<float> const&
+frustum_culling::SphereSet::get_x() const
+{
+	return _x;
+}
+
+std::vector<float> const&
+frustum_culling::SphereSet::get_y() const
+{
+	return _y;
+}
+
+std::vector<float> const&
+frustum_culling::SphereSet::get_z() const
+{
+	return _z;
+}
+
+std::vector<float> const&
+frustum_culling::SphereSet::get_radius() const
+{
+	return _radius;
+}
+
+frustum_culling::statistics
+frustum_culling::cull_scalar(frustum const& f, SphereSet const& spheres, std::vector<std::uint8_t>& visible)
+{
+	visible.resize(spheres.size());
+	statistics result;
+	result.visible_nb = cull_range(f, spheres, 0u, spheres.size(), visible);
+	result.culled_nb = spheres.size() - result.visible_nb;
+	return result;
+}
+
+#if defined(FAST_TRIG_USE_SSE2)
+
+frustum_culling::statistics
+frustum_culling::cull(frustum const& f, SphereSet const& spheres, std::vector<std::uint8_t>& visible)
+{
+	constexpr std::size_t lanes = 4u;
+
+	auto const count = spheres.size();
+	visible.resize(count);
+	auto const* const xs = spheres.get_x().data();
+	auto const* const ys = spheres.get_y().data();
+	auto const* const zs = spheres.get_z().data();
+	auto const* const radii = spheres.get_radius().data();
+
+	__m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+	for (std::size_t p = 0u; p < f.planes.size(); ++p) {
+		plane_x[p] = _mm_set1_ps(f.planes[p].x);
+		plane_y[p] = _mm_set1_ps(f.planes[p].y);
+		plane_z[p] = _mm_set1_ps(f.planes[p].z);
+		plane_w[p] = _mm_set1_ps(f.planes[p].w);
+	}
+	auto const sign_bit = _mm_set1_ps(-0.0f);
+
+	std::size_t visible_nb = 0u;
+	auto const vectorised_end = count / lanes * lanes;
+	for (std::size_t i = 0u; i < vectorised_end; i += lanes) {
+		auto const x = _mm_loadu_ps(xs + i);
+		auto const y = _mm_loadu_ps(ys + i);
+		auto const z = _mm_loadu_ps(zs + i);
+		auto const negated_radius = _mm_xor_ps(_mm_loadu_ps(radii + i), sign_bit);
+
+		// A lane stays set while its sphere is not fully behind any plane.
+		auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (std::size_t p = 0u; p < f.planes.size(); ++p) {
+			auto const distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, plane_x[p]), _mm_mul_ps(y, plane_y[p])),
+			                                 _mm_add_ps(_mm_mul_ps(z, plane_z[p]), plane_w[p]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negated_radius));
+		}
+
+		auto const mask = _mm_movemask_ps(inside);
+		for (std::size_t l = 0u; l < lanes; ++l) {
+			auto const is_visible = (mask >> l) & 1;
+			visible[i + l] = static_cast<std::uint8_t>(is_visible);
+			visible_nb += static_cast<std::size_t>(is_visible);
+		}
+	}
+	visible_nb += cull_range(f, spheres, vectorised_end, count, visible);
+
+	statistics result;
+	result.visible_nb = visible_nb;
+	result.culled_nb = count - visible_nb;
+	return result;
+}
+
+#else
+
+frustum_culling::statistics
+frustum_culling::cull(frustum const& f, SphereSet const& spheres, std::vector<std::uint8_t>& visible)
+{
+	return cull_scalar(f, spheres, visible);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "mesh_builder.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! \brief Tests of bounding spheres against the view frustum of a camera.
+//!
+//! The planes are extracted from a world-to-clip matrix, as described by
+//! Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from
+//! the World-View-Projection Matrix" (2001). Sets of spheres are stored
+//! one array per coordinate, so that cull() tests four of them at once
+//! with SSE2 when available.
+namespace frustum_culling
+{
+	//! \brief Planes as (normal, distance), normals being unit length and
+	//!        pointing inside; in the order left, right, bottom, top,
+	//!        near, far.
+	struct frustum {
+		std::array<glm::vec4, 6> planes;
+	};
+
+	//! \brief Frustum of everything a world-to-clip matrix maps inside
+	//!        the clip volume.
+	frustum extract_frustum(glm::mat4 const& world_to_clip);
+
+	struct sphere {
+		glm::vec3 center{0.0f};
+		float     radius{0.0f};
+	};
+
+	//! \brief World-space sphere containing model-space bounds once
+	//!        transformed; non-uniform scaling is accounted for by its
+	//!        largest factor.
+	sphere transform_bounds(mesh_builder::bounds const& bounds, glm::mat4 const& model_to_world);
+
+	//! \brief Whether a sphere is at least partly inside the frustum; it
+	//!        can be reported visible while only touching the corner
+	//!        regions outside it, never the other way around.
+	bool is_visible(frustum const& f, sphere const& s);
+
+	//! \brief Distance from the near plane to the nearest point of a
+	//!        sphere, negative if the sphere crosses that plane; ordering
+	//!        spheres by it draws them front to back.
+	float get_near_distance(frustum const& f, sphere const& s);
+
+	//! \brief Spheres stored one array per coordinate.
+	class SphereSet {
+	public:
+		//! @return the index of the added sphere
+		std::size_t add(sphere const& s);
+		void set(std::size_t index, sphere const& s);
+		sphere get(std::size_t index) const;
+		void clear();
+		std::size_t size() const;
+
+		std::vector<float> const& get_x() const;
+		std::vector<float> const& get_y() const;
+		std::vector<float> const& get_z() const;
+		std::vector<float> const& get_radius() const;
+
+	private:
+		std::vector<float> _x;
+		std::vector<float> _y;
+		std::vector<float> _z;
+		std::vector<float> _radius;
+	};
+
+	struct statistics {
+		std::size_t visible_nb{0u};
+		std::size_t culled_nb{0u};
+	};
+
+	//! \brief Test every sphere of a set, vectorised when possible.
+	//!
+	//! @param [in] f the frustum
+	//! @param [in] spheres the spheres to test
+	//! @param [out] visible resized to the number of spheres, and set to 1
+	//!              for the visible ones and 0 for the others
+	//! @return the numbers of visible and culled spheres
+	statistics cull(frustum const& f, SphereSet const& spheres, std::vector<std::uint8_t>& visible);
+
+	//! \brief Same as cull(), one sphere at a time; for comparison.
+	statistics cull_scalar(frustum const& f, SphereSet const& spheres, std::vector<std::uint8_t>& visible);
+}
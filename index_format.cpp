@@ -0,0 +1,97 @@
+#include "index_format.hpp"
+#include "core/Log.h"
+
+namespace
+{
+	template<typename T>
+	void append_triangles(mesh_builder::cpu_mesh const& mesh, std::vector<T>& indices)
+	{
+		indices.reserve(mesh.index_sets.size() * 3u);
+		for (auto const& triangle : mesh.index_sets) {
+			indices.push_back(static_cast<T>(triangle.x));
+			indices.push_back(static_cast<T>(triangle.y));
+			indices.push_back(static_cast<T>(triangle.z));
+		}
+	}
+
+	// Each row of grid cells becomes one strip going through the vertices
+	// (i + 1, j) and (i, j) in turn, which reproduces the triangles and
+	// winding of the grid generators in mesh_builder.
+	template<typename T>
+	void append_strips(mesh_builder::cpu_mesh const& mesh, T const restart_index, std::vector<T>& indices)
+	{
+		auto const columns = mesh.grid_columns;
+		auto const rows = mesh.grid_rows;
+		indices.reserve((rows - 1u) * (2u * columns + 1u));
+		for (unsigned int i = 0u; i + 1u < rows; ++i) {
+			if (i > 0u)
+				indices.push_back(restart_index);
+			for (unsigned int j = 0u; j < columns; ++j) {
+				indices.push_back(static_cast<T>(columns * (i + 1u) + j));
+				indices.push_back(static_cast<T>(columns * (i + 0u) + j));
+			}
+		}
+	}
+}
+
+std::size_t
+index_format::index_buffer::count() const
+{
+	return is_16_bits ? indices_16.size() : indices_32.size();
+}
+
+std::size_t
+index_format::index_buffer::size_in_bytes() const
+{
+	return is_16_bits ? indices_16.size() * sizeof(std::uint16_t)
+	                  : indices_32.size() * sizeof(std::uint32_t);
+}
+
+void const*
+index_format::index_buffer::data() const
+{
+	return is_16_bits ? static_cast<void const*>(indices_16.data())
+	                  : static_cast<void const*>(indices_32.data());
+}
+
+index_format::index_buffer
+index_format::build_index_buffer(mesh_builder::cpu_mesh const& mesh,
+                                 primitive_mode primitive,
+                                 index_width const width)
+{
+	auto const vertices_nb = mesh.vertices.size();
+
+	if (primitive == primitive_mode::triangle_strip
+	    && (mesh.grid_columns == 0u || mesh.grid_rows < 2u
+	        || static_cast<std::size_t>(mesh.grid_columns) * mesh.grid_rows != vertices_nb)) {
+		LogWarning("Triangle strips require a grid mesh: falling back to triangles.");
+		primitive = primitive_mode::triangles;
+	}
+
+	// The highest index value is reserved for restarting strips.
+	auto const max_16_bits_vertices_nb = primitive == primitive_mode::triangle_strip
+	                                   ? static_cast<std::size_t>(restart_index_16)
+	                                   : static_cast<std::size_t>(restart_index_16) + 1u;
+	auto const fits_16_bits = vertices_nb <= max_16_bits_vertices_nb;
+	if (width == index_width::bits_16 && !fits_16_bits)
+		LogWarning("%zu vertices cannot be addressed with 16-bit indices: using 32-bit ones.", vertices_nb);
+
+	index_buffer buffer;
+	buffer.primitive = primitive;
+	buffer.is_16_bits = width != index_width::bits_32 && fits_16_bits;
+	buffer.restart_index = buffer.is_16_bits ? restart_index_16 : restart_index_32;
+
+	if (buffer.is_16_bits) {
+		if (primitive == primitive_mode::triangle_strip)
+			append_strips(mesh, static_cast<std::uint16_t>(restart_index_16), buffer.indices_16);
+		else
+			append_triangles(mesh, buffer.indices_16);
+	} else {
+		if (primitive == primitive_mode::triangle_strip)
+			append_strips(mesh, restart_index_32, buffer.indices_32);
+		else
+			append_triangles(mesh, buffer.indices_32);
+	}
+
+	return buffer;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "mesh_builder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! \brief CPU-side index buffer layouts that a cpu_mesh can be converted
+//!        to before being uploaded.
+namespace index_format
+{
+	//! \brief Which primitives the index buffer describes.
+	enum class primitive_mode : unsigned int {
+		triangles = 0u,  //!< independent triangles, as in cpu_mesh::index_sets
+		triangle_strip   //!< one strip per grid row, separated by restart indices
+	};
+
+	//! \brief How wide each index is.
+	enum class index_width : unsigned int {
+		automatic = 0u, //!< 16 bits whenever all vertices can be addressed, 32 bits otherwise
+		bits_16,
+		bits_32
+	};
+
+	//! \brief Restart index used by 16-bit strips.
+	constexpr std::uint32_t restart_index_16 = 0xffffu;
+
+	//! \brief Restart index used by 32-bit strips.
+	constexpr std::uint32_t restart_index_32 = 0xffffffffu;
+
+	//! \brief Index data ready to be copied into an element buffer.
+	//!
+	//! Only one of indices_16 and indices_32 is filled, depending on
+	//! is_16_bits.
+	struct index_buffer {
+		primitive_mode             primitive{primitive_mode::triangles};
+		bool                       is_16_bits{false};
+		std::uint32_t              restart_index{restart_index_32};
+		std::vector<std::uint16_t> indices_16;
+		std::vector<std::uint32_t> indices_32;
+
+		//! \brief Number of indices, restart indices included.
+		std::size_t count() const;
+
+		//! \brief Size of the index data, in bytes.
+		std::size_t size_in_bytes() const;
+
+		//! \brief Pointer to the first index.
+		void const* data() const;
+	};
+
+	//! \brief Convert the triangles of a mesh to the requested layout.
+	//!
+	//! Triangle strips are only available for meshes describing a
+	//! regular grid (see cpu_mesh::grid_columns); other meshes fall back
+	//! to triangles. With index_width::bits_16, meshes with too many
+	//! vertices fall back to 32-bit indices.
+	//!
+	//! @param [in] mesh the mesh whose triangles to convert
+	//! @param [in] primitive the kind of primitives to output
+	//! @param [in] width the width of each index
+	//! @return the converted indices
+	index_buffer build_index_buffer(mesh_builder::cpu_mesh const& mesh,
+	                                primitive_mode primitive,
+	                                index_width width);
+}
@@ -0,0 +1,208 @@
+#include "instanced_batch.hpp"
+
+#include "frame_constants.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+char const* const InstancedBatch::normal_vertex_shader = R"glsl(
+#version 410
+
+layout (location = 0) in vec3 vertex;
+layout (location = 1) in vec3 normal;
+layout (location = 6) in mat4 vertex_model_to_world;
+layout (location = 10) in mat4 normal_model_to_world;
+
+uniform mat4 vertex_world_to_clip;
+
+out VS_OUT {
+	vec3 normal;
+} vs_out;
+
+void main()
+{
+	vs_out.normal = normalize(vec3(normal_model_to_world * vec4(normal, 0.0)));
+	gl_Position = vertex_world_to_clip * vertex_model_to_world * vec4(vertex, 1.0);
+}
+)glsl";
+
+char const* const InstancedBatch::normal_fragment_shader = R"glsl(
+#version 410
+
+in VS_OUT {
+	vec3 normal;
+} fs_in;
+
+out vec4 frag_color;
+
+void main()
+{
+	frag_color = vec4(0.5 * normalize(fs_in.normal) + 0.5, 1.0);
+}
+)glsl";
+
+InstancedBatch::InstancedBatch() :
+	_vertex_world_to_clip(_uniforms.declare("vertex_world_to_clip")),
+	_frame_constants(_uniforms.declare_block(frame_constants::block_name, frame_constants::binding))
+{
+}
+
+InstancedBatch::~InstancedBatch()
+{
+	glDeleteBuffers(1, &_instance_buffer);
+}
+
+InstancedBatch::InstancedBatch(InstancedBatch&& other) :
+	_mesh(std::move(other._mesh)), _format(other._format),
+	_program(other._program), _set_uniforms(std::move(other._set_uniforms)),
+	_uniforms(std::move(other._uniforms)),
+	_vertex_world_to_clip(other._vertex_world_to_clip),
+	_frame_constants(other._frame_constants),
+	_instances(std::move(other._instances)),
+	_instance_buffer(other._instance_buffer),
+	_instance_buffer_capacity(other._instance_buffer_capacity),
+	_are_instances_dirty(other._are_instances_dirty)
+{
+	other._instance_buffer = 0u;
+	other._instance_buffer_capacity = 0u;
+}
+
+InstancedBatch&
+InstancedBatch::operator=(InstancedBatch&& other)
+{
+	if (this == &other)
+		return *this;
+
+	glDeleteBuffers(1, &_instance_buffer);
+	_mesh = std::move(other._mesh);
+	_format = other._format;
+	_program = other._program;
+	_set_uniforms = std::move(other._set_uniforms);
+	_uniforms = std::move(other._uniforms);
+	_vertex_world_to_clip = other._vertex_world_to_clip;
+	_frame_constants = other._frame_constants;
+	_instances = std::move(other._instances);
+	_instance_buffer = other._instance_buffer;
+	_instance_buffer_capacity = other._instance_buffer_capacity;
+	_are_instances_dirty = other._are_instances_dirty;
+	other._instance_buffer = 0u;
+	other._instance_buffer_capacity = 0u;
+	return *this;
+}
+
+void
+InstancedBatch::set_geometry(bonobo::mesh_data const& mesh,
+                             mesh_upload::mesh_format const& format)
+{
+	_mesh = mesh;
+	_format = format;
+
+	if (_instance_buffer == 0u)
+		glGenBuffers(1, &_instance_buffer);
+	assert(_instance_buffer != 0u);
+
+	glBindVertexArray(_mesh.vao);
+	glBindBuffer(GL_ARRAY_BUFFER, _instance_buffer);
+	// Each matrix takes four consecutive locations, one per column.
+	for (GLuint column = 0u; column < 8u; ++column) {
+		auto const location = first_instance_location + column;
+		auto const offset = (column < 4u ? offsetof(instance, vertex_model_to_world) : offsetof(instance, normal_model_to_world))
+		                  + (column % 4u) * sizeof(glm::vec4);
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(instance),
+		                      reinterpret_cast<GLvoid const*>(offset));
+		glVertexAttribDivisor(location, 1u);
+	}
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+
+	_are_instances_dirty = true;
+}
+
+void
+InstancedBatch::set_program(GLuint const* program,
+                            std::function<void (GLuint)> const& set_uniforms)
+{
+	_program = program;
+	_set_uniforms = set_uniforms;
+}
+
+void
+InstancedBatch::clear_instances()
+{
+	_instances.clear();
+	_are_instances_dirty = true;
+}
+
+void
+InstancedBatch::add_instance(glm::mat4 const& model_to_world)
+{
+	_instances.push_back({ model_to_world, glm::transpose(glm::inverse(model_to_world)) });
+	_are_instances_dirty = true;
+}
+
+void
+InstancedBatch::set_transforms(std::vector<glm::mat4> const& model_to_world)
+{
+	_instances.clear();
+	_instances.reserve(model_to_world.size());
+	for (auto const& transform : model_to_world)
+		add_instance(transform);
+}
+
+GLsizei
+InstancedBatch::get_instances_nb() const
+{
+	return static_cast<GLsizei>(_instances.size());
+}
+
+void
+InstancedBatch::render(glm::mat4 const& world_to_clip)
+{
+	if (_instances.empty() || _mesh.vao == 0u || _program == nullptr || *_program == 0u)
+		return;
+
+	update_instance_buffer();
+
+	glUseProgram(*_program);
+	if (!_uniforms.bind_block(*_program, _frame_constants))
+		glUniformMatrix4fv(_uniforms.get_location(*_program, _vertex_world_to_clip), 1, GL_FALSE, glm::value_ptr(world_to_clip));
+	if (_set_uniforms)
+		_set_uniforms(*_program);
+
+	glBindVertexArray(_mesh.vao);
+	mesh_upload::draw(_mesh, _format, get_instances_nb());
+	glBindVertexArray(0u);
+
+	glUseProgram(0u);
+}
+
+void
+InstancedBatch::invalidate_programs()
+{
+	_uniforms.invalidate();
+}
+
+void
+InstancedBatch::update_instance_buffer()
+{
+	if (!_are_instances_dirty || _instance_buffer == 0u)
+		return;
+
+	auto const size = _instances.size() * sizeof(instance);
+	glBindBuffer(GL_ARRAY_BUFFER, _instance_buffer);
+	if (size > _instance_buffer_capacity) {
+		_instance_buffer_capacity = size;
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), _instances.data(), GL_STREAM_DRAW);
+	} else {
+		// Orphan the previous storage so the driver does not have to wait
+		// for draws still reading from it.
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_instance_buffer_capacity), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), _instances.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+	_are_instances_dirty = false;
+}
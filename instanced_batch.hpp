@@ -0,0 +1,114 @@
+#pragma once
+
+#include "mesh_upload.hpp"
+#include "uniform_cache.hpp"
+
+#include "core/helpers.hpp"
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+//! \brief Draws many copies of one mesh in a single instanced call.
+//!
+//! The transforms of all instances are streamed into an instance buffer
+//! whenever they change, and bound as per-instance vertex attributes:
+//! the model-to-world matrix takes the locations starting at
+//! `first_instance_location`, followed by the normal matrix. The program
+//! reads them in place of Node's `vertex_model_to_world` and
+//! `normal_model_to_world` uniforms; see `normal_vertex_shader` for an
+//! example.
+//!
+//! The instance attributes are added to the VAO of the mesh, so a mesh
+//! should only be given to one batch; regular Node rendering of that
+//! mesh is not affected. All functions require a current OpenGL context.
+//!
+//! Like a RenderQueue, render() binds the frame_constants block of
+//! programs declaring it, which then read `vertex_world_to_clip` from
+//! the frame constants buffer rather than from a uniform.
+class InstancedBatch {
+public:
+	//! \brief Per-instance data, as laid out in the instance buffer.
+	struct instance {
+		glm::mat4 vertex_model_to_world;
+		glm::mat4 normal_model_to_world;
+	};
+
+	//! \brief First attribute location used by the instance data, right
+	//!        after the bonobo::shader_bindings ones; eight locations
+	//!        are used in total.
+	static constexpr GLuint first_instance_location = 6u;
+
+	//! \brief Vertex shader equivalent to the one of the "Normal"
+	//!        program, reading its transforms from the instance data.
+	static char const* const normal_vertex_shader;
+
+	//! \brief Fragment shader to pair with `normal_vertex_shader`.
+	static char const* const normal_fragment_shader;
+
+	InstancedBatch();
+	~InstancedBatch();
+
+	InstancedBatch(InstancedBatch const&) = delete;
+	InstancedBatch& operator=(InstancedBatch const&) = delete;
+	InstancedBatch(InstancedBatch&& other);
+	InstancedBatch& operator=(InstancedBatch&& other);
+
+	//! \brief Set the mesh to instantiate, and bind the instance buffer
+	//!        to its VAO.
+	//!
+	//! @param [in] mesh the uploaded mesh
+	//! @param [in] format the format it was uploaded with
+	void set_geometry(bonobo::mesh_data const& mesh,
+	                  mesh_upload::mesh_format const& format = mesh_upload::mesh_format());
+
+	//! \brief Set the program to draw with, and a function setting its
+	//!        uniforms besides `vertex_world_to_clip`.
+	void set_program(GLuint const* program,
+	                 std::function<void (GLuint)> const& set_uniforms = [](GLuint /*program*/){});
+
+	//! \brief Remove every instance.
+	void clear_instances();
+
+	//! \brief Add an instance; its normal matrix is derived from
+	//!        `model_to_world`.
+	void add_instance(glm::mat4 const& model_to_world);
+
+	//! \brief Replace all instances at once.
+	void set_transforms(std::vector<glm::mat4> const& model_to_world);
+
+	//! \brief Number of instances that will be drawn.
+	GLsizei get_instances_nb() const;
+
+	//! \brief Upload the instances if they changed since the last call.
+	//!
+	//! render() calls it; it only needs to be called directly when the
+	//! mesh gets drawn by other means, e.g. through a RenderQueue.
+	void update_instance_buffer();
+
+	//! \brief Upload the instances if they changed, and draw all of them
+	//!        with a single call; nothing is drawn if there are none.
+	//!
+	//! @param [in] world_to_clip the world-to-clip matrix of the camera,
+	//!        only used by programs without the frame_constants block
+	void render(glm::mat4 const& world_to_clip);
+
+	//! \brief Forget resolved uniform locations; to be called after
+	//!        ShaderProgramManager::ReloadAllPrograms().
+	void invalidate_programs();
+
+private:
+
+	bonobo::mesh_data            _mesh;
+	mesh_upload::mesh_format     _format;
+	GLuint const*                _program{nullptr};
+	std::function<void (GLuint)> _set_uniforms;
+	UniformCache                 _uniforms;
+	UniformCache::uniform_id     _vertex_world_to_clip;
+	UniformCache::block_id       _frame_constants;
+	std::vector<instance>        _instances;
+	GLuint                       _instance_buffer{0u};
+	std::size_t                  _instance_buffer_capacity{0u};
+	bool                         _are_instances_dirty{false};
+};
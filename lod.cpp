@@ -0,0 +1,74 @@
+#include "lod.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+std::vector<unsigned int>
+lod::halve_split_counts(unsigned int const split_count,
+                        unsigned int const levels_nb,
+                        unsigned int const min_split_count)
+{
+	auto split_counts = std::vector<unsigned int>();
+	auto edges_count = split_count + 1u;
+	for (unsigned int level = 0u; level < levels_nb; ++level) {
+		auto const level_split_count = edges_count - 1u;
+		if (level > 0u && level_split_count < min_split_count)
+			break;
+		split_counts.push_back(level_split_count);
+		edges_count /= 2u;
+		if (edges_count == 0u)
+			break;
+	}
+	return split_counts;
+}
+
+float
+lod::screen_size(glm::vec3 const& center, float const radius,
+                 glm::vec3 const& eye, glm::mat4 const& view_to_clip,
+                 float const viewport_height)
+{
+	auto const distance = glm::length(center - eye);
+	if (distance <= radius)
+		return std::numeric_limits<float>::infinity();
+
+	// view_to_clip[1][1] is cot(fov_y / 2): a sphere of radius r at
+	// distance d covers about r / d * cot(fov_y / 2) half-viewports.
+	return radius / distance * view_to_clip[1][1] * viewport_height;
+}
+
+std::vector<float>
+lod::make_thresholds(unsigned int const levels_nb, float const full_detail_size)
+{
+	auto thresholds = std::vector<float>();
+	auto size = full_detail_size;
+	for (unsigned int level = 0u; level + 1u < levels_nb; ++level) {
+		thresholds.push_back(size);
+		size *= 0.5f;
+	}
+	return thresholds;
+}
+
+LodSelector::LodSelector(std::vector<float> thresholds, float const hysteresis) :
+	_thresholds(std::move(thresholds)), _hysteresis(hysteresis)
+{
+	assert(std::is_sorted(_thresholds.rbegin(), _thresholds.rend()));
+}
+
+unsigned int
+LodSelector::select(float const screen_size)
+{
+	auto const levels_nb = static_cast<unsigned int>(_thresholds.size()) + 1u;
+	while (_level + 1u < levels_nb && screen_size < _thresholds[_level] * (1.0f - _hysteresis))
+		++_level;
+	while (_level > 0u && screen_size >= _thresholds[_level - 1u] * (1.0f + _hysteresis))
+		--_level;
+	return _level;
+}
+
+unsigned int
+LodSelector::get_level() const
+{
+	return _level;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "mesh_upload.hpp"
+
+#include "core/helpers.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+//! \brief Discrete levels of detail for the parametric shapes.
+//!
+//! A chain holds the same shape uploaded at decreasing resolutions,
+//! level 0 being the finest one; each level halves the number of edges
+//! of the previous one in both directions, so it has about a quarter of
+//! its triangles. The level a shape is drawn with is picked from the
+//! size it covers on screen, see LodSelector.
+namespace lod
+{
+	//! \brief Default number of levels in a chain.
+	constexpr unsigned int default_levels_nb = 4u;
+
+	//! \brief Split counts of each level, halving the number of edges
+	//!        from one level to the next.
+	//!
+	//! The builders add one edge to their split count, so a split count
+	//! `s` gives `s + 1` edges.
+	//!
+	//! @param [in] split_count the split count of level 0
+	//! @param [in] levels_nb the maximum number of levels
+	//! @param [in] min_split_count levels stop before going below this
+	//! @return one split count per level; there can be fewer than
+	//!         `levels_nb` of them if `min_split_count` is reached first
+	std::vector<unsigned int> halve_split_counts(unsigned int split_count,
+	                                             unsigned int levels_nb = default_levels_nb,
+	                                             unsigned int min_split_count = 2u);
+
+	//! \brief A shape uploaded at every level of detail.
+	struct chain {
+		std::vector<bonobo::mesh_data>        levels;
+		std::vector<mesh_upload::mesh_format> formats;               //!< per level
+		std::vector<std::size_t>              triangles_nb;          //!< per level
+		float                                 bounding_radius{0.0f}; //!< in model space, around the origin
+	};
+
+	//! \brief Approximate diameter, in pixels, of a bounding sphere once
+	//!        projected on screen.
+	//!
+	//! @param [in] center the centre of the sphere, in world space
+	//! @param [in] radius the radius of the sphere
+	//! @param [in] eye the position of the camera, in world space
+	//! @param [in] view_to_clip the projection matrix of the camera
+	//! @param [in] viewport_height the height of the viewport, in pixels
+	//! @return the diameter; it is infinite when the eye is inside the
+	//!         sphere
+	float screen_size(glm::vec3 const& center, float radius,
+	                  glm::vec3 const& eye, glm::mat4 const& view_to_clip,
+	                  float viewport_height);
+
+	//! \brief Screen sizes at which each level stops being used.
+	//!
+	//! Level 0 is drawn down to `full_detail_size` pixels, and each
+	//! further level down to half the size of the previous one.
+	std::vector<float> make_thresholds(unsigned int levels_nb, float full_detail_size);
+}
+
+//! \brief Picks the level of detail of one shape, with some hysteresis.
+//!
+//! The level only gets coarser once the screen size falls a fraction
+//! below the threshold of the current level, and finer once it rises the
+//! same fraction above the threshold of the next finer one. A shape
+//! hovering around a threshold therefore keeps its level rather than
+//! switching back and forth every frame.
+class LodSelector {
+public:
+	//! \brief Default fraction around the thresholds in which the level
+	//!        is kept.
+	static constexpr float default_hysteresis = 0.15f;
+
+	//! @param [in] thresholds the sizes returned by lod::make_thresholds()
+	//! @param [in] hysteresis the fraction around each threshold in which
+	//!             the current level is kept
+	explicit LodSelector(std::vector<float> thresholds = std::vector<float>(),
+	                     float hysteresis = default_hysteresis);
+
+	//! \brief Update the current level given the screen size of the shape.
+	//!
+	//! @return the current level
+	unsigned int select(float screen_size);
+
+	//! \brief Current level, 0 being the finest one.
+	unsigned int get_level() const;
+
+private:
+	std::vector<float> _thresholds;
+	float              _hysteresis;
+	unsigned int       _level{0u};
+};
@@ -0,0 +1,170 @@
+#include "mesh_builder.hpp"
+#include "parametric_surface.hpp"
+
+#include <cassert>
+
+// Every shape is an instantiation of parametric_surface::build(); the
+// split counts are turned into numbers of cells, a split adding one cell
+// to the single one of an unsplit grid.
+
+mesh_builder::cpu_mesh
+mesh_builder::buildQuad(float const width, float const height,
+	unsigned int const horizontal_split_count,
+	unsigned int const vertical_split_count,
+	ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::quad{ width, height },
+	                                 horizontal_split_count + 1u,
+	                                 vertical_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildSphere(float const radius,
+                          unsigned int const longitude_split_count,
+                          unsigned int const latitude_split_count,
+                          ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::sphere{ radius },
+	                                 longitude_split_count + 1u,
+	                                 latitude_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildCircleRing(float const radius,
+                              float const spread_length,
+                              unsigned int const circle_split_count,
+                              unsigned int const spread_split_count,
+                              ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::circle_ring{ radius, spread_length },
+	                                 spread_split_count + 1u,
+	                                 circle_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildTorus(float const major_radius,
+	float const minor_radius,
+	unsigned int const major_split_count,
+	unsigned int const minor_split_count,
+	ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::torus{ major_radius, minor_radius },
+	                                 major_split_count + 1u,
+	                                 minor_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildSweptTube(std::vector<sweep_frame> const& frames,
+                             float const radius,
+                             unsigned int const circle_split_count,
+                             ThreadPool* pool)
+{
+	assert(frames.size() >= 2u);
+	return parametric_surface::build(parametric_surface::swept_tube{ radius, frames.data(), frames.size() },
+	                                 circle_split_count + 1u,
+	                                 static_cast<unsigned int>(frames.size() - 1u),
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildCylinder(float const radius,
+                            float const height,
+                            unsigned int const circle_split_count,
+                            unsigned int const height_split_count,
+                            ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::cylinder{ radius, height },
+	                                 circle_split_count + 1u,
+	                                 height_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildCone(float const radius,
+                        float const height,
+                        unsigned int const circle_split_count,
+                        unsigned int const height_split_count,
+                        ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::cone{ radius, height },
+	                                 circle_split_count + 1u,
+	                                 height_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildCapsule(float const radius,
+                           float const length,
+                           unsigned int const circle_split_count,
+                           unsigned int const profile_split_count,
+                           ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::capsule{ radius, length },
+	                                 circle_split_count + 1u,
+	                                 profile_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildSuperquadric(glm::vec3 const& radii,
+                                float const north_south_exponent,
+                                float const east_west_exponent,
+                                unsigned int const longitude_split_count,
+                                unsigned int const latitude_split_count,
+                                ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::superquadric{ radii, north_south_exponent, east_west_exponent },
+	                                 longitude_split_count + 1u,
+	                                 latitude_split_count + 1u,
+	                                 pool);
+}
+
+mesh_builder::cpu_mesh
+mesh_builder::buildBezierPatch(std::array<glm::vec3, 16> const& control_points,
+                               unsigned int const u_split_count,
+                               unsigned int const v_split_count,
+                               ThreadPool* pool)
+{
+	return parametric_surface::build(parametric_surface::bezier_patch{ control_points },
+	                                 u_split_count + 1u,
+	                                 v_split_count + 1u,
+	                                 pool);
+}
+
+bool
+mesh_builder::bounds::is_empty() const
+{
+	return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+void
+mesh_builder::bounds::extend(glm::vec3 const& point)
+{
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+glm::vec3
+mesh_builder::bounds::get_center() const
+{
+	return is_empty() ? glm::vec3(0.0f) : 0.5f * (min + max);
+}
+
+float
+mesh_builder::bounds::get_radius() const
+{
+	return is_empty() ? 0.0f : 0.5f * glm::length(max - min);
+}
+
+mesh_builder::bounds
+mesh_builder::compute_bounds(cpu_mesh const& mesh)
+{
+	bounds result;
+	for (auto const& vertex : mesh.vertices)
+		result.extend(vertex);
+	return result;
+}
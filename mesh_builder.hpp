@@ -0,0 +1,213 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <limits>
+#include <vector>
+
+class ThreadPool;
+
+//! \brief GL-free generation of the parametric shapes.
+//!
+//! Nothing in this namespace touches OpenGL: the functions only fill
+//! CPU-side arrays, so they can run on any thread, be cached, or be
+//! benchmarked without a context. Use mesh_upload::upload() to turn the
+//! result into a bonobo::mesh_data. The shapes are all sampled by
+//! parametric_surface::build(), which can also be used directly for
+//! surfaces without a builder here.
+//!
+//! Every builder optionally takes a ThreadPool, across which the rows of
+//! the vertex and index grids get split. The output does not depend on
+//! whether a pool is used, nor on its size.
+namespace mesh_builder
+{
+	//! \brief Plain CPU mesh, with one array per vertex attribute.
+	struct cpu_mesh {
+		std::vector<glm::vec3> vertices;   //!< positions, in model space
+		std::vector<glm::vec3> normals;    //!< unit normals
+		std::vector<glm::vec3> texcoords;  //!< texture coordinates, z is unused
+		std::vector<glm::vec3> tangents;   //!< unit tangents
+		std::vector<glm::vec3> binormals;  //!< unit binormals
+		std::vector<glm::uvec3> index_sets; //!< triangles, as indices into the arrays above
+
+		//! Number of vertices per row, when the vertices form a regular
+		//! grid stored row by row and index_sets splits each grid cell
+		//! along the same diagonal; 0 otherwise.
+		unsigned int grid_columns{0u};
+		unsigned int grid_rows{0u};    //!< number of rows of that grid
+	};
+
+	//! \brief Axis-aligned bounding box, in model space; empty when
+	//!        `min` is greater than `max`.
+	struct bounds {
+		glm::vec3 min{std::numeric_limits<float>::max()};
+		glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+		bool is_empty() const;
+		//! \brief Grow the box to contain `point`.
+		void extend(glm::vec3 const& point);
+		glm::vec3 get_center() const;
+		//! \brief Radius of the sphere around get_center() containing
+		//!        the box.
+		float get_radius() const;
+	};
+
+	//! \brief Bounds of the vertices of a mesh.
+	bounds compute_bounds(cpu_mesh const& mesh);
+
+	//! \brief Point of a curve along with an orthonormal frame, as swept
+	//!        by buildSweptTube(); the third axis is
+	//!        `cross(tangent, normal)`.
+	struct sweep_frame {
+		glm::vec3 position{0.0f};
+		glm::vec3 tangent{0.0f, 0.0f, -1.0f}; //!< along the curve
+		glm::vec3 normal{1.0f, 0.0f, 0.0f};   //!< across it
+	};
+
+	//! \brief Build the vertices of a quad lying in the XZ-plane.
+	//!
+	//! @param [in] width the width of the quad
+	//! @param [in] height the height of the quad
+	//! @param [in] horizontal_split_count the number of edges along the height
+	//! @param [in] vertical_split_count the number of edges along the width
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildQuad(float const width, float const height,
+	                   unsigned int const horizontal_split_count,
+	                   unsigned int const vertical_split_count,
+	                   ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of a sphere centred on the origin.
+	//!
+	//! @param [in] radius the radius of the sphere
+	//! @param [in] longitude_split_count the number of splits along the longitude
+	//! @param [in] latitude_split_count the number of splits along the latitude
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildSphere(float const radius,
+	                     unsigned int const longitude_split_count,
+	                     unsigned int const latitude_split_count,
+	                     ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of a flat ring in the XY-plane.
+	//!
+	//! @param [in] radius the radius of the middle of the ring
+	//! @param [in] spread_length the width of the ring
+	//! @param [in] circle_split_count the number of splits along the circle
+	//! @param [in] spread_split_count the number of splits across the ring
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildCircleRing(float const radius,
+	                         float const spread_length,
+	                         unsigned int const circle_split_count,
+	                         unsigned int const spread_split_count,
+	                         ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of a torus lying in the XZ-plane.
+	//!
+	//! @param [in] major_radius the distance from the centre to the tube centre
+	//! @param [in] minor_radius the radius of the tube
+	//! @param [in] major_split_count the number of splits around the tube
+	//! @param [in] minor_split_count the number of splits around the centre
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildTorus(float const major_radius,
+	                    float const minor_radius,
+	                    unsigned int const major_split_count,
+	                    unsigned int const minor_split_count,
+	                    ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of a tube sweeping a circle along a
+	//!        curve, given as a sequence of frames.
+	//!
+	//! Each frame gives a row of vertices, the circle lying in the plane
+	//! of its normal and third axis. The directions are laid out as for
+	//! buildTorus(), whose frames would follow its major circle: the
+	//! tangents go around the tube, the binormals along the curve, and the
+	//! normals point into the tube. The frames should not twist around the
+	//! curve, see swept_tube::compute_frames().
+	//!
+	//! @param [in] frames the frames along the curve, at least two
+	//! @param [in] radius the radius of the tube
+	//! @param [in] circle_split_count the number of splits around the tube
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildSweptTube(std::vector<sweep_frame> const& frames,
+	                        float const radius,
+	                        unsigned int const circle_split_count,
+	                        ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of an open cylinder around the Y-axis,
+	//!        centred on the origin.
+	//!
+	//! @param [in] radius the radius of the cylinder
+	//! @param [in] height the height of the cylinder
+	//! @param [in] circle_split_count the number of splits around the axis
+	//! @param [in] height_split_count the number of splits along the axis
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildCylinder(float const radius,
+	                       float const height,
+	                       unsigned int const circle_split_count,
+	                       unsigned int const height_split_count,
+	                       ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of an open cone around the Y-axis, with
+	//!        its base centred on the origin.
+	//!
+	//! @param [in] radius the radius of the base
+	//! @param [in] height the distance from the base to the apex
+	//! @param [in] circle_split_count the number of splits around the axis
+	//! @param [in] height_split_count the number of splits along the axis
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildCone(float const radius,
+	                   float const height,
+	                   unsigned int const circle_split_count,
+	                   unsigned int const height_split_count,
+	                   ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of a capsule around the Y-axis, centred
+	//!        on the origin.
+	//!
+	//! @param [in] radius the radius of the cylinder and of the caps
+	//! @param [in] length the length of the cylinder between the caps
+	//! @param [in] circle_split_count the number of splits around the axis
+	//! @param [in] profile_split_count the number of splits from pole to pole
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildCapsule(float const radius,
+	                      float const length,
+	                      unsigned int const circle_split_count,
+	                      unsigned int const profile_split_count,
+	                      ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of a superellipsoid centred on the origin.
+	//!
+	//! @param [in] radii the radii along each axis
+	//! @param [in] north_south_exponent the exponent of the vertical sections, in (0, 2)
+	//! @param [in] east_west_exponent the exponent of the horizontal sections, in (0, 2)
+	//! @param [in] longitude_split_count the number of splits along the longitude
+	//! @param [in] latitude_split_count the number of splits along the latitude
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildSuperquadric(glm::vec3 const& radii,
+	                           float const north_south_exponent,
+	                           float const east_west_exponent,
+	                           unsigned int const longitude_split_count,
+	                           unsigned int const latitude_split_count,
+	                           ThreadPool* pool = nullptr);
+
+	//! \brief Build the vertices of a bicubic Bézier patch.
+	//!
+	//! @param [in] control_points the 4x4 control points, row by row
+	//! @param [in] u_split_count the number of splits along a row
+	//! @param [in] v_split_count the number of splits across the rows
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	cpu_mesh buildBezierPatch(std::array<glm::vec3, 16> const& control_points,
+	                          unsigned int const u_split_count,
+	                          unsigned int const v_split_count,
+	                          ThreadPool* pool = nullptr);
+}
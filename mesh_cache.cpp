@@ -0,0 +1,457 @@
+#include "mesh_cache.hpp"
+#include "core/Log.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#	include <direct.h>
+#	include <sys/stat.h>
+#	include <sys/types.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <sys/types.h>
+#	include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr char file_magic[4] = { 'B', 'M', 'C', 'H' };
+	constexpr std::uint32_t max_attributes_nb = 16u;
+	constexpr std::uint64_t blob_alignment = 16u;
+
+	struct file_header {
+		char          magic[4];
+		std::uint32_t version;
+		std::uint32_t key_length;
+		std::uint32_t meshes_nb;
+	};
+
+	struct attribute_header {
+		std::uint32_t location;
+		std::uint32_t size;
+		std::uint32_t type;
+		std::uint32_t normalized;
+		std::uint32_t integer;
+		std::uint32_t stride;
+		std::uint64_t offset;
+	};
+
+	struct mesh_header {
+		std::uint32_t    drawing_mode;
+		std::uint32_t    index_type;
+		std::uint32_t    restart_index;
+		std::uint32_t    layout;
+		std::uint32_t    primitive;
+		std::uint32_t    attributes_nb;
+		std::uint64_t    indices_nb;
+		std::uint64_t    vertices_nb;
+		std::uint64_t    first_index;
+		std::uint64_t    vertex_bytes;
+		std::uint64_t    index_bytes;
+		float            bounds_min[3];
+		float            bounds_max[3];
+		attribute_header attributes[max_attributes_nb];
+	};
+
+	std::uint64_t align_up(std::uint64_t const value)
+	{
+		return (value + blob_alignment - 1u) / blob_alignment * blob_alignment;
+	}
+
+	// 64-bit FNV-1a, only used to derive a file name from a key; the key
+	// itself is stored in the file and compared on load.
+	std::uint64_t hash_key(std::string const& key)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325ull;
+		for (auto const c : key) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// Read-only memory mapping of a whole file.
+	class mapped_file {
+	public:
+		explicit mapped_file(std::string const& path)
+		{
+#if defined(_WIN32)
+			_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (_file == INVALID_HANDLE_VALUE)
+				return;
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+				return;
+			_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (_mapping == nullptr)
+				return;
+			_data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+			if (_data != nullptr)
+				_size = static_cast<std::size_t>(size.QuadPart);
+#else
+			_file = open(path.c_str(), O_RDONLY);
+			if (_file < 0)
+				return;
+			struct stat info;
+			if (fstat(_file, &info) != 0 || info.st_size == 0)
+				return;
+			auto data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, _file, 0);
+			if (data == MAP_FAILED)
+				return;
+			_data = data;
+			_size = static_cast<std::size_t>(info.st_size);
+#endif
+		}
+
+		~mapped_file()
+		{
+#if defined(_WIN32)
+			if (_data != nullptr)
+				UnmapViewOfFile(_data);
+			if (_mapping != nullptr)
+				CloseHandle(_mapping);
+			if (_file != INVALID_HANDLE_VALUE)
+				CloseHandle(_file);
+#else
+			if (_data != nullptr)
+				munmap(_data, _size);
+			if (_file >= 0)
+				close(_file);
+#endif
+		}
+
+		mapped_file(mapped_file const&) = delete;
+		mapped_file& operator=(mapped_file const&) = delete;
+
+		std::uint8_t const* data() const { return static_cast<std::uint8_t const*>(_data); }
+		std::size_t size() const { return _size; }
+
+	private:
+#if defined(_WIN32)
+		HANDLE _file{INVALID_HANDLE_VALUE};
+		HANDLE _mapping{nullptr};
+#else
+		int    _file{-1};
+#endif
+		void*       _data{nullptr};
+		std::size_t _size{0u};
+	};
+
+	void make_directory(std::string const& path)
+	{
+#if defined(_WIN32)
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+
+	// Read back the vertex attribute setup of the currently bound VAO;
+	// returns false if the attributes do not all come from `bo`.
+	bool capture_attributes(GLuint const bo, mesh_header& header)
+	{
+		header.attributes_nb = 0u;
+		for (GLuint location = 0u; location < max_attributes_nb; ++location) {
+			GLint enabled = GL_FALSE;
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+			if (enabled == GL_FALSE)
+				continue;
+
+			GLint buffer = 0, size = 0, type = 0, normalized = 0, integer = 0, stride = 0;
+			GLvoid* pointer = nullptr;
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &normalized);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &integer);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+			glGetVertexAttribPointerv(location, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+			if (static_cast<GLuint>(buffer) != bo)
+				return false;
+
+			auto& attribute = header.attributes[header.attributes_nb++];
+			attribute.location = location;
+			attribute.size = static_cast<std::uint32_t>(size);
+			attribute.type = static_cast<std::uint32_t>(type);
+			attribute.normalized = static_cast<std::uint32_t>(normalized);
+			attribute.integer = static_cast<std::uint32_t>(integer);
+			attribute.stride = static_cast<std::uint32_t>(stride);
+			attribute.offset = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(pointer));
+		}
+		return true;
+	}
+
+	std::vector<std::uint8_t> read_back_buffer(GLenum const target, GLuint const buffer)
+	{
+		glBindBuffer(target, buffer);
+		GLint size = 0;
+		glGetBufferParameteriv(target, GL_BUFFER_SIZE, &size);
+		auto bytes = std::vector<std::uint8_t>(static_cast<std::size_t>(size));
+		if (size > 0)
+			glGetBufferSubData(target, 0, size, bytes.data());
+		return bytes;
+	}
+
+	void write_padding(std::ofstream& file, std::uint64_t& offset)
+	{
+		static char const zeros[blob_alignment] = {};
+		auto const aligned = align_up(offset);
+		file.write(zeros, static_cast<std::streamsize>(aligned - offset));
+		offset = aligned;
+	}
+}
+
+MeshCache::MeshCache(std::string directory) : _directory(std::move(directory))
+{
+	if (!_directory.empty() && _directory.back() != '/' && _directory.back() != '\\')
+		_directory += '/';
+	make_directory(_directory);
+}
+
+std::string
+MeshCache::make_file_key(char const* function_name, std::string const& path)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+		return make_key(function_name, path);
+
+	return make_key(function_name, path,
+	                static_cast<long long>(info.st_size),
+	                static_cast<long long>(info.st_mtime));
+}
+
+std::vector<bonobo::mesh_data>
+MeshCache::get_or_create(std::string const& key, create_function const& create,
+                         std::vector<mesh_upload::mesh_format>* formats)
+{
+	auto meshes = std::vector<bonobo::mesh_data>();
+	auto loaded_formats = std::vector<mesh_upload::mesh_format>();
+	if (load(key, meshes, loaded_formats)) {
+		++_hits_nb;
+		if (formats != nullptr)
+			*formats = std::move(loaded_formats);
+		return meshes;
+	}
+
+	++_misses_nb;
+	auto created_formats = std::vector<mesh_upload::mesh_format>();
+	meshes = create(created_formats);
+	created_formats.resize(meshes.size());
+	if (!meshes.empty() && !store(key, meshes, created_formats))
+		LogWarning("Failed to store \"%s\" in the mesh cache.", key.c_str());
+
+	if (formats != nullptr)
+		*formats = std::move(created_formats);
+	return meshes;
+}
+
+bool
+MeshCache::load(std::string const& key,
+                std::vector<bonobo::mesh_data>& meshes,
+                std::vector<mesh_upload::mesh_format>& formats) const
+{
+	mapped_file const file(get_entry_path(key));
+	if (file.data() == nullptr || file.size() < sizeof(file_header))
+		return false;
+
+	file_header header;
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0
+	    || header.version != format_version
+	    || header.key_length != key.size()
+	    || sizeof(file_header) + header.key_length > file.size()
+	    || std::memcmp(file.data() + sizeof(file_header), key.data(), key.size()) != 0)
+		return false;
+
+	// Validate every mesh before creating any OpenGL object.
+	auto headers = std::vector<std::pair<mesh_header, std::uint64_t>>();
+	std::uint64_t offset = align_up(sizeof(file_header) + header.key_length);
+	for (std::uint32_t i = 0u; i < header.meshes_nb; ++i) {
+		mesh_header mesh;
+		if (offset + sizeof(mesh_header) > file.size())
+			return false;
+		std::memcpy(&mesh, file.data() + offset, sizeof(mesh));
+		offset = align_up(offset + sizeof(mesh_header));
+		if (mesh.attributes_nb > max_attributes_nb
+		    || offset + align_up(mesh.vertex_bytes) + mesh.index_bytes > file.size())
+			return false;
+		headers.emplace_back(mesh, offset);
+		offset = align_up(offset + align_up(mesh.vertex_bytes) + mesh.index_bytes);
+	}
+
+	meshes.clear();
+	formats.clear();
+	for (auto const& entry : headers) {
+		auto const& mesh = entry.first;
+		auto const* vertex_blob = file.data() + entry.second;
+		auto const* index_blob = vertex_blob + align_up(mesh.vertex_bytes);
+
+		bonobo::mesh_data data;
+		glGenVertexArrays(1, &data.vao);
+		assert(data.vao != 0u);
+		glBindVertexArray(data.vao);
+
+		glGenBuffers(1, &data.bo);
+		assert(data.bo != 0u);
+		glBindBuffer(GL_ARRAY_BUFFER, data.bo);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.vertex_bytes), vertex_blob, GL_STATIC_DRAW);
+
+		for (std::uint32_t a = 0u; a < mesh.attributes_nb; ++a) {
+			auto const& attribute = mesh.attributes[a];
+			auto const pointer = reinterpret_cast<GLvoid const*>(static_cast<std::uintptr_t>(attribute.offset));
+			glEnableVertexAttribArray(attribute.location);
+			if (attribute.integer != 0u)
+				glVertexAttribIPointer(attribute.location, static_cast<GLint>(attribute.size), attribute.type, static_cast<GLsizei>(attribute.stride), pointer);
+			else
+				glVertexAttribPointer(attribute.location, static_cast<GLint>(attribute.size), attribute.type, attribute.normalized != 0u ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(attribute.stride), pointer);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0u);
+
+		if (mesh.index_bytes > 0u) {
+			glGenBuffers(1, &data.ibo);
+			assert(data.ibo != 0u);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.index_bytes), index_blob, GL_STATIC_DRAW);
+		}
+
+		glBindVertexArray(0u);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+		data.indices_nb = static_cast<std::size_t>(mesh.indices_nb);
+		data.vertices_nb = static_cast<std::size_t>(mesh.vertices_nb);
+		data.drawing_mode = static_cast<GLenum>(mesh.drawing_mode);
+		meshes.push_back(data);
+
+		mesh_upload::mesh_format format;
+		format.layout = static_cast<vertex_format::vertex_layout>(mesh.layout);
+		format.primitive = static_cast<index_format::primitive_mode>(mesh.primitive);
+		format.index_type = static_cast<GLenum>(mesh.index_type);
+		format.restart_index = static_cast<GLuint>(mesh.restart_index);
+		format.vertex_bytes = static_cast<std::size_t>(mesh.vertex_bytes);
+		format.index_bytes = static_cast<std::size_t>(mesh.index_bytes);
+		format.first_index = static_cast<std::size_t>(mesh.first_index);
+		format.bounds.min = glm::vec3(mesh.bounds_min[0], mesh.bounds_min[1], mesh.bounds_min[2]);
+		format.bounds.max = glm::vec3(mesh.bounds_max[0], mesh.bounds_max[1], mesh.bounds_max[2]);
+		formats.push_back(format);
+	}
+
+	return true;
+}
+
+bool
+MeshCache::store(std::string const& key,
+                 std::vector<bonobo::mesh_data> const& meshes,
+                 std::vector<mesh_upload::mesh_format> const& formats) const
+{
+	assert(meshes.size() == formats.size());
+
+	struct captured_mesh {
+		mesh_header               header;
+		std::vector<std::uint8_t> vertices;
+		std::vector<std::uint8_t> indices;
+	};
+	auto captured = std::vector<captured_mesh>(meshes.size());
+	for (std::size_t i = 0u; i < meshes.size(); ++i) {
+		auto const& data = meshes[i];
+		auto const& format = formats[i];
+		auto& entry = captured[i];
+		std::memset(&entry.header, 0, sizeof(entry.header));
+
+		glBindVertexArray(data.vao);
+		auto const has_supported_attributes = capture_attributes(data.bo, entry.header);
+		if (has_supported_attributes) {
+			entry.vertices = read_back_buffer(GL_ARRAY_BUFFER, data.bo);
+			if (data.ibo != 0u)
+				entry.indices = read_back_buffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
+		}
+		glBindVertexArray(0u);
+		glBindBuffer(GL_ARRAY_BUFFER, 0u);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+		if (!has_supported_attributes) {
+			LogWarning("Meshes whose attributes span several buffers cannot be cached.");
+			return false;
+		}
+
+		entry.header.drawing_mode = data.drawing_mode;
+		entry.header.index_type = format.index_type;
+		entry.header.restart_index = format.restart_index;
+		entry.header.layout = static_cast<std::uint32_t>(format.layout);
+		entry.header.primitive = static_cast<std::uint32_t>(format.primitive);
+		entry.header.indices_nb = data.indices_nb;
+		entry.header.vertices_nb = data.vertices_nb;
+		entry.header.first_index = format.first_index;
+		entry.header.vertex_bytes = entry.vertices.size();
+		entry.header.index_bytes = entry.indices.size();
+		for (int c = 0; c < 3; ++c) {
+			entry.header.bounds_min[c] = format.bounds.min[c];
+			entry.header.bounds_max[c] = format.bounds.max[c];
+		}
+	}
+
+	// Write to a temporary file first, so that an interrupted write never
+	// leaves a truncated entry behind.
+	auto const path = get_entry_path(key);
+	auto const temporary_path = path + ".tmp";
+	{
+		std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		file_header header;
+		std::memcpy(header.magic, file_magic, sizeof(file_magic));
+		header.version = format_version;
+		header.key_length = static_cast<std::uint32_t>(key.size());
+		header.meshes_nb = static_cast<std::uint32_t>(captured.size());
+		file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		file.write(key.data(), static_cast<std::streamsize>(key.size()));
+		std::uint64_t offset = sizeof(header) + key.size();
+		write_padding(file, offset);
+
+		for (auto const& entry : captured) {
+			file.write(reinterpret_cast<char const*>(&entry.header), sizeof(entry.header));
+			offset += sizeof(entry.header);
+			write_padding(file, offset);
+			file.write(reinterpret_cast<char const*>(entry.vertices.data()), static_cast<std::streamsize>(entry.vertices.size()));
+			offset += entry.vertices.size();
+			write_padding(file, offset);
+			file.write(reinterpret_cast<char const*>(entry.indices.data()), static_cast<std::streamsize>(entry.indices.size()));
+			offset += entry.indices.size();
+			write_padding(file, offset);
+		}
+
+		if (!file)
+			return false;
+	}
+
+	std::remove(path.c_str());
+	return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+unsigned int
+MeshCache::get_hits_nb() const
+{
+	return _hits_nb;
+}
+
+unsigned int
+MeshCache::get_misses_nb() const
+{
+	return _misses_nb;
+}
+
+std::string
+MeshCache::get_entry_path(std::string const& key) const
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(hash_key(key)));
+	return _directory + name;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "mesh_upload.hpp"
+
+#include "core/helpers.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//! \brief On-disk cache of uploaded meshes.
+//!
+//! An entry stores exactly what was uploaded for one or more meshes: the
+//! bytes of their vertex and index buffers, along with the vertex
+//! attribute setup of their VAO. It is captured by reading the buffers
+//! back after a regular upload, so generated meshes and meshes coming
+//! from bonobo::loadObjects() are handled the same way.
+//!
+//! On a hit, the file is memory-mapped and the buffers are filled
+//! directly from the mapping; nothing gets generated, parsed nor
+//! repacked. Only geometry is cached: texture bindings and materials of
+//! loaded objects are not.
+//!
+//! Every function touching OpenGL requires a current context.
+class MeshCache {
+public:
+	//! \brief Bump whenever the file layout, or the output of the
+	//!        generators, changes, so that stale entries are ignored.
+	static constexpr std::uint32_t format_version = 4u;
+
+	//! \brief Mesh creation function used on cache misses.
+	//!
+	//! It fills `formats` with one entry per returned mesh, or leaves it
+	//! empty for meshes using 32-bit indices.
+	using create_function = std::function<std::vector<bonobo::mesh_data> (std::vector<mesh_upload::mesh_format>& formats)>;
+
+	//! \brief Create a cache storing its entries in `directory`, which is
+	//!        created if needed.
+	explicit MeshCache(std::string directory);
+
+	//! \brief Build a key out of a function name and its parameters.
+	//!
+	//! Floating-point parameters are printed with enough digits to be
+	//! told apart, and the format version is appended.
+	template<typename... Args>
+	static std::string make_key(char const* function_name, Args const&... parameters);
+
+	//! \brief Build a key for a file loaded from disk; its size and last
+	//!        modification time are part of the key.
+	static std::string make_file_key(char const* function_name, std::string const& path);
+
+	//! \brief Return the meshes stored under `key` if any, or create,
+	//!        store and return them otherwise.
+	//!
+	//! @param [in] key the key identifying the meshes
+	//! @param [in] create the function called on misses
+	//! @param [out] formats if not null, receives the format of each mesh
+	//! @return the uploaded meshes
+	std::vector<bonobo::mesh_data> get_or_create(std::string const& key,
+	                                             create_function const& create,
+	                                             std::vector<mesh_upload::mesh_format>* formats = nullptr);
+
+	//! \brief Load the meshes stored under `key`.
+	//!
+	//! @return false if there is no valid entry for that key
+	bool load(std::string const& key,
+	          std::vector<bonobo::mesh_data>& meshes,
+	          std::vector<mesh_upload::mesh_format>& formats) const;
+
+	//! \brief Read the given meshes back from the GPU and store them
+	//!        under `key`.
+	//!
+	//! @return false if the entry could not be written
+	bool store(std::string const& key,
+	           std::vector<bonobo::mesh_data> const& meshes,
+	           std::vector<mesh_upload::mesh_format> const& formats) const;
+
+	//! \brief Number of get_or_create() calls served from disk.
+	unsigned int get_hits_nb() const;
+
+	//! \brief Number of get_or_create() calls that had to create meshes.
+	unsigned int get_misses_nb() const;
+
+private:
+	std::string get_entry_path(std::string const& key) const;
+
+	std::string  _directory;
+	unsigned int _hits_nb{0u};
+	unsigned int _misses_nb{0u};
+};
+
+template<typename... Args>
+std::string
+MeshCache::make_key(char const* function_name, Args const&... parameters)
+{
+	std::ostringstream key;
+	key.precision(9);
+	key << function_name << '(';
+	char const* separator = "";
+	using expand = int[];
+	(void) expand{ 0, ((key << separator << parameters), separator = ", ", 0)... };
+	key << ")|v" << format_version;
+	return key.str();
+}
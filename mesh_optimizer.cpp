@@ -0,0 +1,221 @@
+#include "mesh_optimizer.hpp"
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	// Triangles using each vertex, stored as one flat array with an
+	// offset per vertex.
+	struct vertex_adjacency {
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> triangles;
+	};
+
+	vertex_adjacency build_adjacency(std::vector<std::uint32_t> const& indices, std::size_t const vertices_nb)
+	{
+		vertex_adjacency adjacency;
+		adjacency.offsets.assign(vertices_nb + 1u, 0u);
+		for (auto const index : indices)
+			++adjacency.offsets[index + 1u];
+		for (std::size_t v = 0u; v < vertices_nb; ++v)
+			adjacency.offsets[v + 1u] += adjacency.offsets[v];
+
+		auto fill = std::vector<std::uint32_t>(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		adjacency.triangles.resize(indices.size());
+		for (std::size_t i = 0u; i < indices.size(); ++i)
+			adjacency.triangles[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3u);
+
+		return adjacency;
+	}
+
+	std::vector<std::uint32_t> flatten(std::vector<glm::uvec3> const& index_sets)
+	{
+		auto indices = std::vector<std::uint32_t>();
+		indices.reserve(index_sets.size() * 3u);
+		for (auto const& triangle : index_sets) {
+			indices.push_back(triangle.x);
+			indices.push_back(triangle.y);
+			indices.push_back(triangle.z);
+		}
+		return indices;
+	}
+}
+
+mesh_optimizer::cache_statistics
+mesh_optimizer::compute_cache_statistics(std::vector<std::uint32_t> const& indices,
+                                         std::size_t const vertices_nb,
+                                         unsigned int const cache_size)
+{
+	// A FIFO cache can be simulated with a single counter: a vertex is
+	// still cached if fewer than cache_size misses happened since it was
+	// last loaded.
+	auto loaded_at = std::vector<std::size_t>(vertices_nb, 0u);
+	std::size_t misses = 0u;
+	for (auto const index : indices) {
+		assert(index < vertices_nb);
+		if (loaded_at[index] == 0u || misses - loaded_at[index] >= cache_size) {
+			++misses;
+			loaded_at[index] = misses;
+		}
+	}
+
+	cache_statistics statistics;
+	statistics.triangles_nb = indices.size() / 3u;
+	statistics.vertices_nb = vertices_nb;
+	statistics.cache_misses = misses;
+	statistics.acmr = statistics.triangles_nb > 0u ? static_cast<float>(misses) / static_cast<float>(statistics.triangles_nb) : 0.0f;
+	statistics.atvr = vertices_nb > 0u ? static_cast<float>(misses) / static_cast<float>(vertices_nb) : 0.0f;
+	return statistics;
+}
+
+std::vector<std::uint32_t>
+mesh_optimizer::tipsify(std::vector<std::uint32_t> const& indices,
+                        std::size_t const vertices_nb,
+                        unsigned int const cache_size)
+{
+	auto const triangles_nb = indices.size() / 3u;
+	auto const adjacency = build_adjacency(indices, vertices_nb);
+
+	auto live_triangles = std::vector<int>(vertices_nb);
+	for (std::size_t v = 0u; v < vertices_nb; ++v)
+		live_triangles[v] = static_cast<int>(adjacency.offsets[v + 1u] - adjacency.offsets[v]);
+
+	auto cache_time = std::vector<int>(vertices_nb, 0);
+	auto emitted = std::vector<bool>(triangles_nb, false);
+	auto dead_end = std::vector<std::uint32_t>();
+	auto candidates = std::vector<std::uint32_t>();
+	auto const k = static_cast<int>(cache_size);
+
+	auto output = std::vector<std::uint32_t>();
+	output.reserve(indices.size());
+
+	int timestamp = k + 1;
+	std::size_t cursor = 0u;
+	auto fanning_vertex = vertices_nb > 0u ? 0 : -1;
+	while (fanning_vertex >= 0) {
+		candidates.clear();
+
+		// Emit all the triangles around the fanning vertex.
+		auto const f = static_cast<std::size_t>(fanning_vertex);
+		for (auto a = adjacency.offsets[f]; a < adjacency.offsets[f + 1u]; ++a) {
+			auto const triangle = adjacency.triangles[a];
+			if (emitted[triangle])
+				continue;
+
+			for (std::size_t c = 0u; c < 3u; ++c) {
+				auto const v = indices[3u * triangle + c];
+				output.push_back(v);
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				--live_triangles[v];
+				if (timestamp - cache_time[v] > k)
+					cache_time[v] = timestamp++;
+			}
+			emitted[triangle] = true;
+		}
+
+		// Pick the candidate that is still in the cache and has the most
+		// triangles left, if any.
+		fanning_vertex = -1;
+		int best_priority = -1;
+		for (auto const v : candidates) {
+			if (live_triangles[v] <= 0)
+				continue;
+			int priority = 0;
+			if (timestamp - cache_time[v] + 2 * live_triangles[v] <= k)
+				priority = timestamp - cache_time[v];
+			if (priority > best_priority) {
+				best_priority = priority;
+				fanning_vertex = static_cast<int>(v);
+			}
+		}
+
+		// Otherwise, fall back to the most recently used vertex that
+		// still has triangles, and then to the next one in input order.
+		while (fanning_vertex < 0 && !dead_end.empty()) {
+			auto const v = dead_end.back();
+			dead_end.pop_back();
+			if (live_triangles[v] > 0)
+				fanning_vertex = static_cast<int>(v);
+		}
+		while (fanning_vertex < 0 && cursor < vertices_nb) {
+			if (live_triangles[cursor] > 0)
+				fanning_vertex = static_cast<int>(cursor);
+			++cursor;
+		}
+	}
+
+	assert(output.size() == indices.size());
+	return output;
+}
+
+mesh_optimizer::optimization_report
+mesh_optimizer::optimize(mesh_builder::cpu_mesh& mesh, char const* name, unsigned int const cache_size)
+{
+	auto const vertices_nb = mesh.vertices.size();
+	auto const indices = flatten(mesh.index_sets);
+	auto const optimized = tipsify(indices, vertices_nb, cache_size);
+
+	for (std::size_t i = 0u; i < mesh.index_sets.size(); ++i)
+		mesh.index_sets[i] = glm::uvec3(optimized[3u * i + 0u], optimized[3u * i + 1u], optimized[3u * i + 2u]);
+
+	optimization_report report;
+	report.before = compute_cache_statistics(indices, vertices_nb, cache_size);
+	report.after = compute_cache_statistics(optimized, vertices_nb, cache_size);
+	if (name != nullptr)
+		log_report(name, report);
+
+	return report;
+}
+
+mesh_optimizer::optimization_report
+mesh_optimizer::optimize(bonobo::mesh_data const& data, char const* name, unsigned int const cache_size)
+{
+	optimization_report report;
+	if (data.ibo == 0u || data.drawing_mode != GL_TRIANGLES || data.indices_nb % 3u != 0u) {
+		LogWarning("Only indexed triangle lists can be reordered for the vertex cache.");
+		return report;
+	}
+
+	// The element buffer binding is part of the VAO state, so bind the
+	// VAO first to avoid modifying someone else's.
+	glBindVertexArray(data.vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
+
+	GLint buffer_size = 0;
+	glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &buffer_size);
+	auto const indices_size = static_cast<GLsizeiptr>(data.indices_nb * sizeof(std::uint32_t));
+	if (buffer_size < indices_size) {
+		LogWarning("The index buffer is too small to hold 32-bit indices: leaving it untouched.");
+		glBindVertexArray(0u);
+		return report;
+	}
+
+	auto indices = std::vector<std::uint32_t>(data.indices_nb);
+	glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices_size, indices.data());
+
+	auto const vertices_nb = indices.empty() ? 0u : static_cast<std::size_t>(*std::max_element(indices.begin(), indices.end())) + 1u;
+	auto const optimized = tipsify(indices, vertices_nb, cache_size);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices_size, optimized.data());
+
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+	report.before = compute_cache_statistics(indices, vertices_nb, cache_size);
+	report.after = compute_cache_statistics(optimized, vertices_nb, cache_size);
+	if (name != nullptr)
+		log_report(name, report);
+
+	return report;
+}
+
+void
+mesh_optimizer::log_report(char const* name, optimization_report const& report)
+{
+	LogInfo("%s: %zu triangles, %zu vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+	        name, report.after.triangles_nb, report.after.vertices_nb,
+	        report.before.acmr, report.after.acmr,
+	        report.before.atvr, report.after.atvr);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "mesh_builder.hpp"
+
+#include "core/helpers.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! \brief Reordering of triangle lists to make better use of the GPU
+//!        post-transform vertex cache.
+//!
+//! The reordering is the Tipsify algorithm from Sander, Nehab and
+//! Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+//! Overdraw" (SIGGRAPH 2007): it runs in linear time and only needs the
+//! approximate size of the cache.
+namespace mesh_optimizer
+{
+	//! \brief Cache size assumed when none is given; close to what
+	//!        current GPUs effectively achieve.
+	constexpr unsigned int default_cache_size = 16u;
+
+	//! \brief Result of simulating a FIFO vertex cache over a triangle
+	//!        list.
+	struct cache_statistics {
+		std::size_t triangles_nb{0u};
+		std::size_t vertices_nb{0u};
+		std::size_t cache_misses{0u};
+		float       acmr{0.0f}; //!< average cache miss ratio: misses per triangle, 0.5 at best for large grids, 3 at worst
+		float       atvr{0.0f}; //!< average transform to vertex ratio: misses per vertex, 1 at best
+	};
+
+	//! \brief Statistics of a mesh before and after being optimised.
+	struct optimization_report {
+		cache_statistics before;
+		cache_statistics after;
+	};
+
+	//! \brief Simulate a FIFO vertex cache of the given size.
+	//!
+	//! @param [in] indices the triangle list, three indices per triangle
+	//! @param [in] vertices_nb the number of vertices referenced
+	//! @param [in] cache_size the number of entries of the simulated cache
+	//! @return the miss counts and ratios
+	cache_statistics compute_cache_statistics(std::vector<std::uint32_t> const& indices,
+	                                          std::size_t vertices_nb,
+	                                          unsigned int cache_size = default_cache_size);
+
+	//! \brief Reorder the triangles of a triangle list with Tipsify.
+	//!
+	//! The vertices themselves are left untouched, as is the winding of
+	//! each triangle.
+	//!
+	//! @param [in] indices the triangle list, three indices per triangle
+	//! @param [in] vertices_nb the number of vertices referenced
+	//! @param [in] cache_size the number of entries of the targeted cache
+	//! @return the reordered triangle list
+	std::vector<std::uint32_t> tipsify(std::vector<std::uint32_t> const& indices,
+	                                   std::size_t vertices_nb,
+	                                   unsigned int cache_size = default_cache_size);
+
+	//! \brief Reorder the triangles of a CPU mesh in place.
+	//!
+	//! Only index_sets is affected: strips built through
+	//! index_format::primitive_mode::triangle_strip keep their own order.
+	//!
+	//! @param [in,out] mesh the mesh to optimise
+	//! @param [in] name if not null, the statistics are logged under that name
+	//! @param [in] cache_size the number of entries of the targeted cache
+	//! @return the statistics before and after reordering
+	optimization_report optimize(mesh_builder::cpu_mesh& mesh,
+	                             char const* name = nullptr,
+	                             unsigned int cache_size = default_cache_size);
+
+	//! \brief Reorder the triangles of an already uploaded mesh, such as
+	//!        the ones returned by bonobo::loadObjects().
+	//!
+	//! The index buffer is read back, reordered and written again, so
+	//! this requires a current OpenGL context. Only meshes drawn as
+	//! GL_TRIANGLES with 32-bit indices are supported; others are left
+	//! untouched and an empty report is returned.
+	//!
+	//! @param [in] data the mesh to optimise
+	//! @param [in] name if not null, the statistics are logged under that name
+	//! @param [in] cache_size the number of entries of the targeted cache
+	//! @return the statistics before and after reordering
+	optimization_report optimize(bonobo::mesh_data const& data,
+	                             char const* name = nullptr,
+	                             unsigned int cache_size = default_cache_size);
+
+	//! \brief Print the statistics of an optimisation to the log.
+	void log_report(char const* name, optimization_report const& report);
+}
@@ -0,0 +1,234 @@
+#include "mesh_upload.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	void upload_planar_vertices(mesh_builder::cpu_mesh const& mesh, bonobo::mesh_data& data)
+	{
+		auto const& vertices = mesh.vertices;
+		auto const& normals = mesh.normals;
+		auto const& texcoords = mesh.texcoords;
+		auto const& tangents = mesh.tangents;
+		auto const& binormals = mesh.binormals;
+
+		auto const vertices_offset = 0u;
+		auto const vertices_size = static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
+		auto const normals_offset = vertices_size;
+		auto const normals_size = static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
+		auto const texcoords_offset = normals_offset + normals_size;
+		auto const texcoords_size = static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
+		auto const tangents_offset = texcoords_offset + texcoords_size;
+		auto const tangents_size = static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
+		auto const binormals_offset = tangents_offset + tangents_size;
+		auto const binormals_size = static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
+		auto const bo_size = static_cast<GLsizeiptr>(vertices_size + normals_size + texcoords_size + tangents_size + binormals_size);
+
+		glGenBuffers(1, &data.bo);
+		assert(data.bo != 0u);
+		glBindBuffer(GL_ARRAY_BUFFER, data.bo);
+		glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
+
+		glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size, static_cast<GLvoid const*>(vertices.data()));
+		glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
+		glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(0x0));
+
+		glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, static_cast<GLvoid const*>(normals.data()));
+		glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
+		glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(normals_offset));
+
+		glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, static_cast<GLvoid const*>(texcoords.data()));
+		glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
+		glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(texcoords_offset));
+
+		glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size, static_cast<GLvoid const*>(tangents.data()));
+		glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
+		glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(tangents_offset));
+
+		glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size, static_cast<GLvoid const*>(binormals.data()));
+		glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::binormals));
+		glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(binormals_offset));
+	}
+
+	void upload_packed_vertices(mesh_builder::cpu_mesh const& mesh, bonobo::mesh_data& data)
+	{
+		using vertex_format::packed_vertex;
+
+		auto const vertices = vertex_format::pack_interleaved(mesh);
+
+		glGenBuffers(1, &data.bo);
+		assert(data.bo != 0u);
+		glBindBuffer(GL_ARRAY_BUFFER, data.bo);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(packed_vertex)), static_cast<GLvoid const*>(vertices.data()), GL_STATIC_DRAW);
+
+		mesh_upload::set_packed_attributes();
+	}
+}
+
+bonobo::mesh_data
+mesh_upload::upload(mesh_builder::cpu_mesh const& mesh, upload_options const& options,
+                    mesh_format* format)
+{
+	bonobo::mesh_data data;
+	glGenVertexArrays(1, &data.vao);
+	assert(data.vao != 0u);
+	glBindVertexArray(data.vao);
+
+	switch (options.layout) {
+		case vertex_format::vertex_layout::interleaved_packed:
+			upload_packed_vertices(mesh, data);
+			break;
+		case vertex_format::vertex_layout::planar:
+		default:
+			upload_planar_vertices(mesh, data);
+			break;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+	data.vertices_nb = mesh.vertices.size();
+
+	auto const indices = index_format::build_index_buffer(mesh, options.primitive, options.index_width);
+	data.indices_nb = indices.count();
+	data.drawing_mode = indices.primitive == index_format::primitive_mode::triangle_strip ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+	glGenBuffers(1, &data.ibo);
+	assert(data.ibo != 0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size_in_bytes()), indices.data(), GL_STATIC_DRAW);
+
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+	if (format != nullptr) {
+		format->layout = options.layout;
+		format->primitive = indices.primitive;
+		format->index_type = indices.is_16_bits ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		format->restart_index = indices.restart_index;
+		format->vertex_bytes = mesh.vertices.size() * vertex_format::vertex_size(options.layout);
+		format->index_bytes = indices.size_in_bytes();
+		format->bounds = mesh_builder::compute_bounds(mesh);
+	}
+
+	return data;
+}
+
+mesh_upload::upload_options
+mesh_upload::node_upload_options(vertex_format::vertex_layout const layout,
+                                 index_format::primitive_mode const primitive)
+{
+	upload_options options;
+	options.layout = layout;
+	options.primitive = primitive;
+	options.index_width = index_format::index_width::bits_32;
+	return options;
+}
+
+mesh_builder::bounds
+mesh_upload::read_bounds(bonobo::mesh_data const& data)
+{
+	auto const location = static_cast<GLuint>(bonobo::shader_bindings::vertices);
+	mesh_builder::bounds bounds;
+
+	glBindVertexArray(data.vao);
+	GLint enabled = GL_FALSE, buffer = 0, size = 0, type = 0, stride = 0;
+	GLvoid* pointer = nullptr;
+	glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+	glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+	glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+	glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+	glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+	glGetVertexAttribPointerv(location, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+	glBindVertexArray(0u);
+	if (enabled == GL_FALSE || static_cast<GLuint>(buffer) != data.bo || type != GL_FLOAT || size < 3
+	    || data.vertices_nb == 0u)
+		return bounds;
+
+	glBindBuffer(GL_ARRAY_BUFFER, data.bo);
+	GLint buffer_size = 0;
+	glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &buffer_size);
+	auto bytes = std::vector<std::uint8_t>(static_cast<std::size_t>(buffer_size));
+	if (buffer_size > 0)
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, buffer_size, bytes.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+
+	auto const position_size = 3u * sizeof(float);
+	auto const step = stride != 0 ? static_cast<std::size_t>(stride) : static_cast<std::size_t>(size) * sizeof(float);
+	auto const first = static_cast<std::size_t>(reinterpret_cast<std::uintptr_t>(pointer));
+	for (std::size_t i = 0u; i < data.vertices_nb; ++i) {
+		auto const offset = first + i * step;
+		if (offset + position_size > bytes.size())
+			break;
+		glm::vec3 position;
+		std::memcpy(&position, bytes.data() + offset, position_size);
+		bounds.extend(position);
+	}
+	return bounds;
+}
+
+bonobo::mesh_data
+mesh_upload::make_empty_mesh(std::size_t const vertices_nb, GLenum const mode)
+{
+	bonobo::mesh_data data;
+	glGenVertexArrays(1, &data.vao);
+	assert(data.vao != 0u);
+	data.vertices_nb = vertices_nb;
+	data.drawing_mode = mode;
+	return data;
+}
+
+void
+mesh_upload::set_packed_attributes()
+{
+	using vertex_format::packed_vertex;
+
+	auto const stride = static_cast<GLsizei>(sizeof(packed_vertex));
+
+	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
+	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid const*>(offsetof(packed_vertex, position)));
+
+	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
+	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, reinterpret_cast<GLvoid const*>(offsetof(packed_vertex, texcoord)));
+
+	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
+	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals), 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, reinterpret_cast<GLvoid const*>(offsetof(packed_vertex, normal)));
+
+	// The handedness travels in tangent.w; the binormal attribute is
+	// left disabled and has to be rebuilt in the shader.
+	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
+	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents), 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, reinterpret_cast<GLvoid const*>(offsetof(packed_vertex, tangent)));
+}
+
+void
+mesh_upload::enable_primitive_restart()
+{
+	glEnable(GL_PRIMITIVE_RESTART);
+	glPrimitiveRestartIndex(index_format::restart_index_32);
+}
+
+void
+mesh_upload::draw(bonobo::mesh_data const& data, mesh_format const& format,
+                  GLsizei const instances_nb)
+{
+	// Meshes without indices, e.g. from procedural_shapes, are drawn
+	// in vertex order.
+	if (data.ibo == 0u) {
+		glDrawArraysInstanced(data.drawing_mode, 0, static_cast<GLsizei>(data.vertices_nb), instances_nb);
+		return;
+	}
+
+	auto const is_strip = format.primitive == index_format::primitive_mode::triangle_strip;
+	if (is_strip)
+		glPrimitiveRestartIndex(format.restart_index);
+
+	auto const index_size = format.index_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+	glDrawElementsInstanced(data.drawing_mode, static_cast<GLsizei>(data.indices_nb),
+	                        format.index_type, reinterpret_cast<GLvoid const*>(format.first_index * index_size),
+	                        instances_nb);
+
+	// Leave the restart index as Node::render() expects it.
+	if (is_strip && format.restart_index != index_format::restart_index_32)
+		glPrimitiveRestartIndex(index_format::restart_index_32);
+}
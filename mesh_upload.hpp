@@ -0,0 +1,104 @@
+#pragma once
+
+#include "index_format.hpp"
+#include "mesh_builder.hpp"
+#include "vertex_format.hpp"
+
+#include "core/helpers.hpp"
+
+#include <cstddef>
+
+//! \brief Upload stage turning CPU meshes into OpenGL objects.
+//!
+//! Unlike mesh_builder, every function in here requires a current
+//! OpenGL context and must be called from the thread owning it.
+namespace mesh_upload
+{
+	//! \brief Layout to use when uploading a mesh.
+	struct upload_options {
+		vertex_format::vertex_layout layout{vertex_format::vertex_layout::planar};
+		index_format::primitive_mode primitive{index_format::primitive_mode::triangles};
+		index_format::index_width    index_width{index_format::index_width::automatic};
+	};
+
+	//! \brief Options producing meshes that Node::render() can draw,
+	//!        i.e. 32-bit indices; the layout and primitive are kept.
+	upload_options node_upload_options(vertex_format::vertex_layout layout = vertex_format::vertex_layout::planar,
+	                                   index_format::primitive_mode primitive = index_format::primitive_mode::triangles);
+
+	//! \brief Describes how an uploaded mesh is laid out, and what is
+	//!        needed to draw it.
+	//!
+	//! bonobo::mesh_data only records the drawing mode, and
+	//! Node::render() always draws with 32-bit indices, so meshes using
+	//! 16-bit indices have to be drawn through draw() below.
+	struct mesh_format {
+		vertex_format::vertex_layout layout{vertex_format::vertex_layout::planar};
+		index_format::primitive_mode primitive{index_format::primitive_mode::triangles};
+		GLenum                       index_type{GL_UNSIGNED_INT};
+		GLuint                       restart_index{index_format::restart_index_32};
+		std::size_t                  vertex_bytes{0u};
+		std::size_t                  index_bytes{0u};
+		//! Bounds of the vertices, used for culling; empty when unknown.
+		mesh_builder::bounds         bounds;
+		//! Index draws start from, for meshes drawing only part of their
+		//! index buffer.
+		std::size_t                  first_index{0u};
+	};
+
+	//! \brief Upload a CPU mesh into a new VAO, vertex buffer and index
+	//!        buffer.
+	//!
+	//! The attributes are bound to the bonobo::shader_bindings locations.
+	//! With vertex_layout::interleaved_packed, no binormal attribute is
+	//! bound; see vertex_format::packed_vertex for how to rebuild it.
+	//! Triangle strips are reported through bonobo::mesh_data::drawing_mode
+	//! and rely on primitive restart being enabled, see
+	//! enable_primitive_restart().
+	//!
+	//! @param [in] mesh the CPU mesh to upload
+	//! @param [in] options how to lay out the vertices and the indices
+	//! @param [out] format if not null, receives the layout actually used
+	//! @return wrapper around the OpenGL objects' name containing the
+	//!         geometry data
+	bonobo::mesh_data upload(mesh_builder::cpu_mesh const& mesh,
+	                         upload_options const& options = upload_options(),
+	                         mesh_format* format = nullptr);
+
+	//! \brief Bounds of an uploaded mesh, read back from the positions
+	//!        in its vertex buffer; for meshes not built from a CPU mesh,
+	//!        e.g. by bonobo::loadObjects().
+	//!
+	//! @return the bounds, empty if the positions are not floats in the
+	//!         vertex buffer of `data` or its vertices_nb is not set
+	mesh_builder::bounds read_bounds(bonobo::mesh_data const& data);
+
+	//! \brief A mesh without any buffer, for shaders generating their
+	//!        vertices from gl_VertexID; it only has a VAO, as core
+	//!        profiles cannot draw without one bound, even an empty one.
+	//!
+	//! @param [in] vertices_nb the number of vertices to draw
+	//! @param [in] mode the primitives to draw them as
+	bonobo::mesh_data make_empty_mesh(std::size_t vertices_nb, GLenum mode);
+
+	//! \brief Point the attributes of the bound VAO at packed vertices,
+	//!        see vertex_layout::interleaved_packed, in the buffer bound
+	//!        to GL_ARRAY_BUFFER; for vertex buffers filled by other means
+	//!        than upload().
+	void set_packed_attributes();
+
+	//! \brief Enable primitive restart for 32-bit strips, which is what
+	//!        Node::render() needs to draw meshes uploaded with
+	//!        primitive_mode::triangle_strip.
+	void enable_primitive_restart();
+
+	//! \brief Draw a mesh with its VAO already bound, taking its index
+	//!        width and first index into account; meshes without an
+	//!        index buffer are drawn with glDrawArrays().
+	//!
+	//! @param [in] data the uploaded mesh
+	//! @param [in] format the format returned by upload()
+	//! @param [in] instances_nb how many instances to draw
+	void draw(bonobo::mesh_data const& data, mesh_format const& format,
+	          GLsizei instances_nb = 1);
+}
@@ -0,0 +1,31 @@
+#include "parametric_surface.hpp"
+
+std::vector<glm::uvec3>
+parametric_surface::build_grid_index_sets(unsigned int const columns,
+                                          unsigned int const rows,
+                                          ThreadPool* pool)
+{
+	auto const column_edges_count = columns - 1u;
+	auto index_sets = std::vector<glm::uvec3>(2u * column_edges_count * (rows - 1u));
+
+	detail::for_each_rows(pool, rows - 1u, [&](unsigned int const first, unsigned int const last) {
+		for (unsigned int i = first; i < last; ++i)
+		{
+			size_t index = 2u * column_edges_count * i;
+			for (unsigned int j = 0u; j < column_edges_count; ++j)
+			{
+				index_sets[index] = glm::uvec3(columns * (i + 0u) + (j + 0u),
+					columns * (i + 0u) + (j + 1u),
+					columns * (i + 1u) + (j + 1u));
+				++index;
+
+				index_sets[index] = glm::uvec3(columns * (i + 0u) + (j + 0u),
+					columns * (i + 1u) + (j + 1u),
+					columns * (i + 1u) + (j + 0u));
+				++index;
+			}
+		}
+	});
+
+	return index_sets;
+}
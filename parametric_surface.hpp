@@ -0,0 +1,555 @@
+#pragma once
+
+#include "fast_trig.hpp"
+#include "mesh_builder.hpp"
+#include "thread_pool.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//! \brief Generic generator for meshes sampling a parametric surface on
+//!        a regular (u, v) grid.
+//!
+//! A surface is a small functor type; build() is instantiated for each of
+//! them, so their evaluation gets fully inlined into the grid walk. A
+//! surface provides:
+//!
+//!     domain get_domain() const;
+//!     column_terms prepare_column(parameter const& u) const;
+//!     row_terms prepare_row(parameter const& v) const;
+//!     sample evaluate(column_terms const& c, row_terms const& r) const;
+//!
+//! The prepare functions compute whatever only depends on u, or on v,
+//! once per column or per row instead of once per vertex; they receive
+//! the sine and cosine of the parameter, taken from fast_trig tables.
+//!
+//! Columns follow u and rows follow v. Texture coordinates always go from
+//! 0 to 1 over the domain, and triangles are wound so that
+//! cross(tangent, binormal) points towards their front face.
+namespace parametric_surface
+{
+	//! \brief Range covered by the parameters.
+	struct domain {
+		float u_start;
+		float u_length;
+		float v_start;
+		float v_length;
+	};
+
+	//! \brief Value of a parameter at a column or a row, along with its
+	//!        sine and cosine.
+	struct parameter {
+		float value;
+		float cos;
+		float sin;
+	};
+
+	//! \brief Surface evaluated at one (u, v); the three directions are
+	//!        unit vectors.
+	struct sample {
+		glm::vec3 position;
+		glm::vec3 tangent;   //!< along increasing u
+		glm::vec3 binormal;  //!< along increasing v
+		glm::vec3 normal;
+	};
+
+	//! \brief Sample the surface over a grid of `u_edges_count` by
+	//!        `v_edges_count` cells.
+	//!
+	//! @param [in] surface the surface to sample
+	//! @param [in] u_edges_count the number of cells along u
+	//! @param [in] v_edges_count the number of cells along v
+	//! @param [in] pool if not null, the pool to generate the rows on
+	//! @return the CPU mesh
+	template<typename Surface>
+	mesh_builder::cpu_mesh build(Surface const& surface,
+	                             unsigned int u_edges_count,
+	                             unsigned int v_edges_count,
+	                             ThreadPool* pool = nullptr);
+
+	//! \brief Two triangles per cell of a grid of `columns` by `rows`
+	//!        vertices, stored row by row.
+	std::vector<glm::uvec3> build_grid_index_sets(unsigned int columns,
+	                                              unsigned int rows,
+	                                              ThreadPool* pool = nullptr);
+
+	//! \brief Normalise `v`, or return it unchanged if it is (nearly) null,
+	//!        as happens at the poles of some surfaces.
+	inline glm::vec3 safe_normalize(glm::vec3 const& v)
+	{
+		auto const length_squared = glm::dot(v, v);
+		return length_squared > 1.0e-24f ? v / std::sqrt(length_squared) : v;
+	}
+
+	//! \brief `x` raised to `exponent` while keeping its sign.
+	inline float signed_pow(float const x, float const exponent)
+	{
+		return std::copysign(std::pow(std::abs(x), exponent), x);
+	}
+
+	namespace detail
+	{
+		// Run `body` over the rows [first, last), either all at once or
+		// split across the pool; every row writes its own slots, so the
+		// result is the same in both cases.
+		template<typename F>
+		void for_each_rows(ThreadPool* pool, unsigned int const rows_nb, F const& body)
+		{
+			if (pool == nullptr) {
+				body(0u, rows_nb);
+				return;
+			}
+			pool->parallel_for(0u, rows_nb, [&body](std::size_t const first, std::size_t const last) {
+				body(static_cast<unsigned int>(first), static_cast<unsigned int>(last));
+			});
+		}
+	}
+
+	//
+	// Surfaces
+	//
+
+	//! \brief Sphere centred on the origin; u goes around the Y-axis and
+	//!        v from the south pole to the north one.
+	struct sphere {
+		float radius;
+
+		using column_terms = parameter;
+		using row_terms = parameter;
+
+		domain get_domain() const { return { 0.0f, glm::two_pi<float>(), 0.0f, glm::pi<float>() }; }
+		column_terms prepare_column(parameter const& theta) const { return theta; }
+		row_terms prepare_row(parameter const& phi) const { return phi; }
+
+		sample evaluate(parameter const& theta, parameter const& phi) const
+		{
+			sample s;
+			s.position = glm::vec3(radius * theta.sin * phi.sin,
+			                       -radius * phi.cos,
+			                       radius * theta.cos * phi.sin);
+			// The derivatives divided by their norms, radius * sin(phi)
+			// and radius, so they stay defined at the poles.
+			s.tangent = glm::vec3(theta.cos, 0.0f, -theta.sin);
+			s.binormal = glm::vec3(theta.sin * phi.cos, phi.sin, theta.cos * phi.cos);
+			s.normal = glm::cross(s.tangent, s.binormal);
+			return s;
+		}
+	};
+
+	//! \brief Torus lying in the XZ-plane; u goes around the tube and v
+	//!        around the Y-axis.
+	struct torus {
+		float major_radius;
+		float minor_radius;
+
+		using column_terms = parameter;
+		using row_terms = parameter;
+
+		domain get_domain() const { return { 0.0f, glm::two_pi<float>(), 0.0f, glm::two_pi<float>() }; }
+		column_terms prepare_column(parameter const& theta) const { return theta; }
+		row_terms prepare_row(parameter const& phi) const { return phi; }
+
+		sample evaluate(parameter const& theta, parameter const& phi) const
+		{
+			auto const distance_to_axis = major_radius + minor_radius * theta.cos;
+
+			sample s;
+			s.position = glm::vec3(distance_to_axis * phi.cos,
+			                       -minor_radius * theta.sin,
+			                       distance_to_axis * phi.sin);
+			s.tangent = glm::vec3(-theta.sin * phi.cos, -theta.cos, -theta.sin * phi.sin);
+			s.binormal = glm::vec3(-phi.sin, 0.0f, phi.cos);
+			s.normal = glm::cross(s.tangent, s.binormal);
+			return s;
+		}
+	};
+
+	//! \brief Flat ring in the XY-plane; u goes across the ring and v
+	//!        around the Z-axis.
+	struct circle_ring {
+		float radius;
+		float spread_length;
+
+		using column_terms = float;
+		using row_terms = parameter;
+
+		domain get_domain() const { return { radius - 0.5f * spread_length, spread_length, 0.0f, glm::two_pi<float>() }; }
+		column_terms prepare_column(parameter const& distance_to_centre) const { return distance_to_centre.value; }
+		row_terms prepare_row(parameter const& theta) const { return theta; }
+
+		sample evaluate(float const distance_to_centre, parameter const& theta) const
+		{
+			sample s;
+			s.position = glm::vec3(distance_to_centre * theta.cos, distance_to_centre * theta.sin, 0.0f);
+			s.tangent = glm::vec3(theta.cos, theta.sin, 0.0f);
+			s.binormal = glm::vec3(-theta.sin, theta.cos, 0.0f);
+			s.normal = glm::cross(s.tangent, s.binormal);
+			return s;
+		}
+	};
+
+	//! \brief Circle swept along a sequence of frames; u goes around the
+	//!        tube and v from one frame to the next, the row at v = i
+	//!        lying around frame i.
+	//!
+	//! The directions follow the torus, with the frames standing for its
+	//! major circle: at frame (t, n), the circle starts along n, and the
+	//! third axis cross(t, n) plays the part of the torus' Y-axis.
+	struct swept_tube {
+		float                            radius;
+		mesh_builder::sweep_frame const* frames;
+		std::size_t                      frames_nb;
+
+		using column_terms = parameter;
+		using row_terms = mesh_builder::sweep_frame const*;
+
+		domain get_domain() const { return { 0.0f, glm::two_pi<float>(), 0.0f, static_cast<float>(frames_nb - 1u) }; }
+		column_terms prepare_column(parameter const& theta) const { return theta; }
+		row_terms prepare_row(parameter const& v) const
+		{
+			auto const index = static_cast<std::size_t>(v.value + 0.5f);
+			return frames + (index < frames_nb ? index : frames_nb - 1u);
+		}
+
+		sample evaluate(parameter const& theta, mesh_builder::sweep_frame const* const frame) const
+		{
+			auto const up = glm::cross(frame->tangent, frame->normal);
+
+			sample s;
+			s.position = frame->position + radius * (theta.cos * frame->normal - theta.sin * up);
+			s.tangent = -theta.sin * frame->normal - theta.cos * up;
+			s.binormal = frame->tangent;
+			s.normal = glm::cross(s.tangent, s.binormal);
+			return s;
+		}
+	};
+
+	//! \brief Quad lying in the XZ-plane, with a corner at the origin; u
+	//!        goes along Z and v along X.
+	struct quad {
+		float width;
+		float height;
+
+		using column_terms = float;
+		using row_terms = float;
+
+		domain get_domain() const { return { 0.0f, height, 0.0f, width }; }
+		column_terms prepare_column(parameter const& z) const { return z.value; }
+		row_terms prepare_row(parameter const& x) const { return x.value; }
+
+		sample evaluate(float const z, float const x) const
+		{
+			sample s;
+			s.position = glm::vec3(x, 0.0f, z);
+			s.tangent = glm::vec3(0.0f, 0.0f, 1.0f);
+			s.binormal = glm::vec3(1.0f, 0.0f, 0.0f);
+			s.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			return s;
+		}
+	};
+
+	//! \brief Open cylinder around the Y-axis, centred on the origin; u
+	//!        goes around the axis and v from bottom to top.
+	struct cylinder {
+		float radius;
+		float height;
+
+		using column_terms = parameter;
+		using row_terms = float;
+
+		domain get_domain() const { return { 0.0f, glm::two_pi<float>(), -0.5f * height, height }; }
+		column_terms prepare_column(parameter const& theta) const { return theta; }
+		row_terms prepare_row(parameter const& y) const { return y.value; }
+
+		sample evaluate(parameter const& theta, float const y) const
+		{
+			sample s;
+			s.position = glm::vec3(radius * theta.sin, y, radius * theta.cos);
+			s.tangent = glm::vec3(theta.cos, 0.0f, -theta.sin);
+			s.binormal = glm::vec3(0.0f, 1.0f, 0.0f);
+			s.normal = glm::vec3(theta.sin, 0.0f, theta.cos);
+			return s;
+		}
+	};
+
+	//! \brief Open cone around the Y-axis, with its base centred on the
+	//!        origin; u goes around the axis and v from base to apex.
+	struct cone {
+		float radius;
+		float height;
+
+		struct row_terms {
+			float distance_to_axis;
+			float y;
+			float radial_slope;   // radius / slant length
+			float vertical_slope; // height / slant length
+		};
+		using column_terms = parameter;
+
+		domain get_domain() const { return { 0.0f, glm::two_pi<float>(), 0.0f, 1.0f }; }
+		column_terms prepare_column(parameter const& theta) const { return theta; }
+
+		row_terms prepare_row(parameter const& v) const
+		{
+			auto const slant_length = std::sqrt(radius * radius + height * height);
+			return { radius * (1.0f - v.value), height * v.value, radius / slant_length, height / slant_length };
+		}
+
+		sample evaluate(parameter const& theta, row_terms const& row) const
+		{
+			sample s;
+			s.position = glm::vec3(row.distance_to_axis * theta.sin, row.y, row.distance_to_axis * theta.cos);
+			s.tangent = glm::vec3(theta.cos, 0.0f, -theta.sin);
+			s.binormal = glm::vec3(-row.radial_slope * theta.sin, row.vertical_slope, -row.radial_slope * theta.cos);
+			s.normal = glm::vec3(row.vertical_slope * theta.sin, row.radial_slope, row.vertical_slope * theta.cos);
+			return s;
+		}
+	};
+
+	//! \brief Capsule around the Y-axis, centred on the origin: a cylinder
+	//!        of length `length` closed by two hemispheres.
+	//!
+	//! v is the arc length along the profile, from the south pole to the
+	//! north one, so rows are spread evenly over the caps and the sides.
+	struct capsule {
+		float radius;
+		float length;
+
+		struct row_terms {
+			float cos_phi;
+			float sin_phi;
+			float y_offset;
+		};
+		using column_terms = parameter;
+
+		domain get_domain() const { return { 0.0f, glm::two_pi<float>(), 0.0f, glm::pi<float>() * radius + length }; }
+		column_terms prepare_column(parameter const& theta) const { return theta; }
+
+		row_terms prepare_row(parameter const& v) const
+		{
+			auto const cap_length = glm::half_pi<float>() * radius;
+			auto const half_length = 0.5f * length;
+
+			float phi, y_offset;
+			if (v.value <= cap_length) {
+				phi = v.value / radius;
+				y_offset = -half_length;
+			} else if (v.value < cap_length + length) {
+				phi = glm::half_pi<float>();
+				y_offset = v.value - cap_length - half_length;
+			} else {
+				phi = (v.value - length) / radius;
+				y_offset = half_length;
+			}
+			return { std::cos(phi), std::sin(phi), y_offset };
+		}
+
+		sample evaluate(parameter const& theta, row_terms const& row) const
+		{
+			sample s;
+			s.position = glm::vec3(radius * theta.sin * row.sin_phi,
+			                       -radius * row.cos_phi + row.y_offset,
+			                       radius * theta.cos * row.sin_phi);
+			s.tangent = glm::vec3(theta.cos, 0.0f, -theta.sin);
+			s.binormal = glm::vec3(theta.sin * row.cos_phi, row.sin_phi, theta.cos * row.cos_phi);
+			s.normal = glm::cross(s.tangent, s.binormal);
+			return s;
+		}
+	};
+
+	//! \brief Superellipsoid centred on the origin, laid out like the
+	//!        sphere.
+	//!
+	//! `east_west_exponent` shapes the horizontal sections and
+	//! `north_south_exponent` the vertical ones; both must be in (0, 2),
+	//! and 1 gives back an ellipsoid. The powers are only evaluated once
+	//! per column and once per row.
+	struct superquadric {
+		glm::vec3 radii;
+		float     north_south_exponent;
+		float     east_west_exponent;
+
+		struct column_terms {
+			float     shape_sin;  // signed_pow(sin(theta), e)
+			float     shape_cos;
+			float     normal_sin; // signed_pow(sin(theta), 2 - e)
+			float     normal_cos;
+			glm::vec3 tangent;
+		};
+		struct row_terms {
+			float shape_sin;
+			float shape_cos;
+			float normal_sin;
+			float normal_cos;
+		};
+
+		domain get_domain() const { return { 0.0f, glm::two_pi<float>(), 0.0f, glm::pi<float>() }; }
+
+		column_terms prepare_column(parameter const& theta) const
+		{
+			column_terms column;
+			column.shape_sin = signed_pow(theta.sin, east_west_exponent);
+			column.shape_cos = signed_pow(theta.cos, east_west_exponent);
+			column.normal_sin = signed_pow(theta.sin, 2.0f - east_west_exponent);
+			column.normal_cos = signed_pow(theta.cos, 2.0f - east_west_exponent);
+			// Perpendicular to the normal of the horizontal section, which
+			// never vanishes, unlike the derivative at the poles.
+			column.tangent = safe_normalize(glm::vec3(column.normal_cos / radii.z, 0.0f, -column.normal_sin / radii.x));
+			return column;
+		}
+
+		row_terms prepare_row(parameter const& phi) const
+		{
+			row_terms row;
+			row.shape_sin = signed_pow(phi.sin, north_south_exponent);
+			row.shape_cos = signed_pow(phi.cos, north_south_exponent);
+			row.normal_sin = signed_pow(phi.sin, 2.0f - north_south_exponent);
+			row.normal_cos = signed_pow(phi.cos, 2.0f - north_south_exponent);
+			return row;
+		}
+
+		sample evaluate(column_terms const& column, row_terms const& row) const
+		{
+			sample s;
+			s.position = glm::vec3(radii.x * column.shape_sin * row.shape_sin,
+			                       -radii.y * row.shape_cos,
+			                       radii.z * column.shape_cos * row.shape_sin);
+			s.normal = safe_normalize(glm::vec3(column.normal_sin * row.normal_sin / radii.x,
+			                                    -row.normal_cos / radii.y,
+			                                    column.normal_cos * row.normal_sin / radii.z));
+			s.tangent = column.tangent;
+			s.binormal = glm::cross(s.normal, s.tangent);
+			return s;
+		}
+	};
+
+	//! \brief Bicubic Bézier patch over [0, 1]²; control point (i, j) is
+	//!        stored at `control_points[4 * j + i]`, with i along u.
+	struct bezier_patch {
+		std::array<glm::vec3, 16> control_points;
+
+		// Bernstein polynomials and their derivatives at one parameter.
+		struct basis {
+			float values[4];
+			float derivatives[4];
+		};
+		using column_terms = basis;
+		using row_terms = basis;
+
+		static basis make_basis(float const t)
+		{
+			auto const s = 1.0f - t;
+			return { { s * s * s, 3.0f * s * s * t, 3.0f * s * t * t, t * t * t },
+			         { -3.0f * s * s, 3.0f * s * (s - 2.0f * t), 3.0f * t * (2.0f * s - t), 3.0f * t * t } };
+		}
+
+		domain get_domain() const { return { 0.0f, 1.0f, 0.0f, 1.0f }; }
+		column_terms prepare_column(parameter const& u) const { return make_basis(u.value); }
+		row_terms prepare_row(parameter const& v) const { return make_basis(v.value); }
+
+		sample evaluate(basis const& u, basis const& v) const
+		{
+			auto position = glm::vec3(0.0f);
+			auto d_u = glm::vec3(0.0f);
+			auto d_v = glm::vec3(0.0f);
+			for (unsigned int j = 0u; j < 4u; ++j) {
+				auto row_position = glm::vec3(0.0f);
+				auto row_d_u = glm::vec3(0.0f);
+				for (unsigned int i = 0u; i < 4u; ++i) {
+					row_position += u.values[i] * control_points[4u * j + i];
+					row_d_u += u.derivatives[i] * control_points[4u * j + i];
+				}
+				position += v.values[j] * row_position;
+				d_u += v.values[j] * row_d_u;
+				d_v += v.derivatives[j] * row_position;
+			}
+
+			sample s;
+			s.position = position;
+			s.tangent = safe_normalize(d_u);
+			s.binormal = safe_normalize(d_v);
+			s.normal = safe_normalize(glm::cross(d_u, d_v));
+			return s;
+		}
+	};
+}
+
+template<typename Surface>
+mesh_builder::cpu_mesh
+parametric_surface::build(Surface const& surface,
+                          unsigned int const u_edges_count,
+                          unsigned int const v_edges_count,
+                          ThreadPool* pool)
+{
+	assert(u_edges_count > 0u && v_edges_count > 0u);
+
+	auto const columns_nb = u_edges_count + 1u;
+	auto const rows_nb = v_edges_count + 1u;
+	auto const vertices_nb = columns_nb * rows_nb;
+
+	auto const range = surface.get_domain();
+	float const d_u = range.u_length / static_cast<float>(u_edges_count);
+	float const d_v = range.v_length / static_cast<float>(v_edges_count);
+
+	// Everything that only depends on u, or on v, is computed up front.
+	auto const u_table = fast_trig::make_sincos_table(range.u_start, d_u, columns_nb);
+	auto const v_table = fast_trig::make_sincos_table(range.v_start, d_v, rows_nb);
+	assert(fast_trig::max_error(u_table, range.u_start, d_u) <= fast_trig::tolerance);
+	assert(fast_trig::max_error(v_table, range.v_start, d_v) <= fast_trig::tolerance);
+
+	auto columns = std::vector<typename Surface::column_terms>();
+	auto columns_texcoord = std::vector<float>(columns_nb);
+	columns.reserve(columns_nb);
+	for (unsigned int j = 0u; j < columns_nb; ++j) {
+		columns.push_back(surface.prepare_column({ range.u_start + d_u * static_cast<float>(j), u_table.cos[j], u_table.sin[j] }));
+		columns_texcoord[j] = static_cast<float>(j) / static_cast<float>(u_edges_count);
+	}
+
+	auto rows = std::vector<typename Surface::row_terms>();
+	rows.reserve(rows_nb);
+	for (unsigned int i = 0u; i < rows_nb; ++i)
+		rows.push_back(surface.prepare_row({ range.v_start + d_v * static_cast<float>(i), v_table.cos[i], v_table.sin[i] }));
+
+	mesh_builder::cpu_mesh mesh;
+	mesh.vertices.resize(vertices_nb);
+	mesh.normals.resize(vertices_nb);
+	mesh.texcoords.resize(vertices_nb);
+	mesh.tangents.resize(vertices_nb);
+	mesh.binormals.resize(vertices_nb);
+
+	auto* const vertices = mesh.vertices.data();
+	auto* const normals = mesh.normals.data();
+	auto* const texcoords = mesh.texcoords.data();
+	auto* const tangents = mesh.tangents.data();
+	auto* const binormals = mesh.binormals.data();
+
+	detail::for_each_rows(pool, rows_nb, [&](unsigned int const first, unsigned int const last) {
+		for (unsigned int i = first; i < last; ++i) {
+			auto const& row = rows[i];
+			float const row_texcoord = static_cast<float>(i) / static_cast<float>(v_edges_count);
+			size_t index = columns_nb * i;
+
+			for (unsigned int j = 0u; j < columns_nb; ++j) {
+				auto const s = surface.evaluate(columns[j], row);
+				vertices[index] = s.position;
+				normals[index] = s.normal;
+				texcoords[index] = glm::vec3(columns_texcoord[j], row_texcoord, 0.0f);
+				tangents[index] = s.tangent;
+				binormals[index] = s.binormal;
+				++index;
+			}
+		}
+	});
+
+	mesh.index_sets = build_grid_index_sets(columns_nb, rows_nb, pool);
+	mesh.grid_columns = columns_nb;
+	mesh.grid_rows = rows_nb;
+	return mesh;
+}
@@ -0,0 +1,262 @@
+#include "procedural_shapes.hpp"
+
+#include "frame_constants.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cassert>
+#include <string>
+
+static_assert(sizeof(procedural_shapes::feedback_vertex) == 14u * sizeof(float),
+              "transform feedback writes the varyings without padding");
+
+char const* const procedural_shapes::glsl_functions = R"glsl(
+uniform int   procedural_shape;      // 0: sphere, 1: torus, 2: circle ring
+uniform vec2  procedural_dimensions;
+uniform ivec2 procedural_edges;      // cells along u and v
+
+const float procedural_pi = 3.14159265358979323846;
+
+struct procedural_sample {
+	vec3 position;
+	vec3 normal;
+	vec3 tangent;
+	vec3 binormal;
+	vec2 texcoord;
+};
+
+// Grid vertex, as (column, row), of vertex `vertex_id` of the strip: each
+// row of cells takes 2 * columns vertices, alternating between its upper
+// and lower rows of vertices, then two more repeating its last vertex
+// and the first one of the next row.
+ivec2 procedural_grid_vertex(int vertex_id)
+{
+	int columns = procedural_edges.x + 1;
+	int row_length = 2 * columns + 2;
+	int row = vertex_id / row_length;
+	int k = vertex_id - row * row_length;
+	if (k == 2 * columns)
+		return ivec2(columns - 1, row);
+	if (k == 2 * columns + 1)
+		return ivec2(0, row + 2);
+	return ivec2(k / 2, row + 1 - (k & 1));
+}
+
+// Same formulas as the surfaces of parametric_surface.hpp.
+procedural_sample procedural_vertex(int vertex_id)
+{
+	ivec2 grid = procedural_grid_vertex(vertex_id);
+
+	procedural_sample s;
+	s.texcoord = vec2(grid) / vec2(procedural_edges);
+	if (procedural_shape == 0) {
+		float radius = procedural_dimensions.x;
+		float theta = (2.0 * procedural_pi / float(procedural_edges.x)) * float(grid.x);
+		float phi = (procedural_pi / float(procedural_edges.y)) * float(grid.y);
+		float cos_theta = cos(theta), sin_theta = sin(theta);
+		float cos_phi = cos(phi), sin_phi = sin(phi);
+		s.position = vec3(radius * sin_theta * sin_phi, -radius * cos_phi, radius * cos_theta * sin_phi);
+		s.tangent = vec3(cos_theta, 0.0, -sin_theta);
+		s.binormal = vec3(sin_theta * cos_phi, sin_phi, cos_theta * cos_phi);
+	} else if (procedural_shape == 1) {
+		float major_radius = procedural_dimensions.x;
+		float minor_radius = procedural_dimensions.y;
+		float theta = (2.0 * procedural_pi / float(procedural_edges.x)) * float(grid.x);
+		float phi = (2.0 * procedural_pi / float(procedural_edges.y)) * float(grid.y);
+		float cos_theta = cos(theta), sin_theta = sin(theta);
+		float cos_phi = cos(phi), sin_phi = sin(phi);
+		float distance_to_axis = major_radius + minor_radius * cos_theta;
+		s.position = vec3(distance_to_axis * cos_phi, -minor_radius * sin_theta, distance_to_axis * sin_phi);
+		s.tangent = vec3(-sin_theta * cos_phi, -cos_theta, -sin_theta * sin_phi);
+		s.binormal = vec3(-sin_phi, 0.0, cos_phi);
+	} else {
+		float radius = procedural_dimensions.x;
+		float spread_length = procedural_dimensions.y;
+		float distance_to_centre = (radius - 0.5 * spread_length)
+		                         + (spread_length / float(procedural_edges.x)) * float(grid.x);
+		float theta = (2.0 * procedural_pi / float(procedural_edges.y)) * float(grid.y);
+		float cos_theta = cos(theta), sin_theta = sin(theta);
+		s.position = vec3(distance_to_centre * cos_theta, distance_to_centre * sin_theta, 0.0);
+		s.tangent = vec3(cos_theta, sin_theta, 0.0);
+		s.binormal = vec3(-sin_theta, cos_theta, 0.0);
+	}
+	s.normal = cross(s.tangent, s.binormal);
+	return s;
+}
+)glsl";
+
+namespace
+{
+	// The vertex shaders start with the shared functions; their sources
+	// are assembled once, before main().
+	std::string make_vertex_shader(char const* main_source)
+	{
+		return std::string("#version 410\n") + procedural_shapes::glsl_functions + main_source;
+	}
+
+	std::string make_vertex_shader(char const* declarations, char const* main_source)
+	{
+		return std::string("#version 410\n") + declarations + procedural_shapes::glsl_functions + main_source;
+	}
+
+	// The camera comes from the per-frame uniform buffer.
+	std::string const instanced_normal_vertex_source = make_vertex_shader(frame_constants::glsl_declaration, R"glsl(
+layout (location = 6) in mat4 vertex_model_to_world;
+layout (location = 10) in mat4 normal_model_to_world;
+
+out VS_OUT {
+	vec3 normal;
+} vs_out;
+
+void main()
+{
+	procedural_sample s = procedural_vertex(gl_VertexID);
+	vs_out.normal = normalize(vec3(normal_model_to_world * vec4(s.normal, 0.0)));
+	gl_Position = vertex_world_to_clip * vertex_model_to_world * vec4(s.position, 1.0);
+}
+)glsl");
+
+	std::string const feedback_vertex_source = make_vertex_shader(R"glsl(
+out vec3 feedback_position;
+out vec3 feedback_normal;
+out vec3 feedback_tangent;
+out vec3 feedback_binormal;
+out vec2 feedback_texcoord;
+
+void main()
+{
+	procedural_sample s = procedural_vertex(gl_VertexID);
+	feedback_position = s.position;
+	feedback_normal = s.normal;
+	feedback_tangent = s.tangent;
+	feedback_binormal = s.binormal;
+	feedback_texcoord = s.texcoord;
+	gl_Position = vec4(s.position, 1.0);
+}
+)glsl");
+}
+
+char const* const procedural_shapes::instanced_normal_vertex_shader = instanced_normal_vertex_source.c_str();
+
+char const* const procedural_shapes::feedback_vertex_shader = feedback_vertex_source.c_str();
+
+char const* const procedural_shapes::feedback_varyings[5] = {
+	"feedback_position", "feedback_normal", "feedback_tangent", "feedback_binormal", "feedback_texcoord"
+};
+
+// A split adds one cell to the single one of an unsplit grid, as in
+// mesh_builder.
+
+procedural_shapes::shape
+procedural_shapes::make_sphere(float const radius, unsigned int const longitude_split_count,
+                               unsigned int const latitude_split_count)
+{
+	return { shape_type::sphere, glm::vec2(radius, 0.0f), longitude_split_count + 1u, latitude_split_count + 1u };
+}
+
+procedural_shapes::shape
+procedural_shapes::make_torus(float const major_radius, float const minor_radius,
+                              unsigned int const major_split_count, unsigned int const minor_split_count)
+{
+	return { shape_type::torus, glm::vec2(major_radius, minor_radius), major_split_count + 1u, minor_split_count + 1u };
+}
+
+procedural_shapes::shape
+procedural_shapes::make_circle_ring(float const radius, float const spread_length,
+                                    unsigned int const circle_split_count, unsigned int const spread_split_count)
+{
+	return { shape_type::circle_ring, glm::vec2(radius, spread_length), spread_split_count + 1u, circle_split_count + 1u };
+}
+
+mesh_builder::cpu_mesh
+procedural_shapes::build(shape const& s)
+{
+	switch (s.type) {
+	case shape_type::sphere:
+		return mesh_builder::buildSphere(s.dimensions.x, s.u_edges_nb - 1u, s.v_edges_nb - 1u);
+	case shape_type::torus:
+		return mesh_builder::buildTorus(s.dimensions.x, s.dimensions.y, s.u_edges_nb - 1u, s.v_edges_nb - 1u);
+	case shape_type::circle_ring:
+		return mesh_builder::buildCircleRing(s.dimensions.x, s.dimensions.y, s.v_edges_nb - 1u, s.u_edges_nb - 1u);
+	}
+	return mesh_builder::cpu_mesh();
+}
+
+std::size_t
+procedural_shapes::get_vertices_nb(shape const& s)
+{
+	auto const row_length = 2u * (static_cast<std::size_t>(s.u_edges_nb) + 1u) + 2u;
+	// The last row of cells is not followed by a degenerate pair.
+	return static_cast<std::size_t>(s.v_edges_nb) * row_length - 2u;
+}
+
+std::size_t
+procedural_shapes::get_triangles_nb(shape const& s)
+{
+	return 2u * static_cast<std::size_t>(s.u_edges_nb) * static_cast<std::size_t>(s.v_edges_nb);
+}
+
+glm::uvec2
+procedural_shapes::get_grid_vertex(shape const& s, std::size_t const vertex_id)
+{
+	assert(vertex_id < get_vertices_nb(s));
+
+	auto const columns = static_cast<std::size_t>(s.u_edges_nb) + 1u;
+	auto const row_length = 2u * columns + 2u;
+	auto const row = vertex_id / row_length;
+	auto const k = vertex_id - row * row_length;
+	if (k == 2u * columns)
+		return glm::uvec2(columns - 1u, row);
+	if (k == 2u * columns + 1u)
+		return glm::uvec2(0u, row + 2u);
+	return glm::uvec2(k / 2u, row + 1u - (k & 1u));
+}
+
+mesh_builder::bounds
+procedural_shapes::get_bounds(shape const& s)
+{
+	auto extent = glm::vec3(0.0f);
+	switch (s.type) {
+	case shape_type::sphere:
+		extent = glm::vec3(s.dimensions.x);
+		break;
+	case shape_type::torus:
+		extent = glm::vec3(s.dimensions.x + s.dimensions.y, s.dimensions.y, s.dimensions.x + s.dimensions.y);
+		break;
+	case shape_type::circle_ring:
+		extent = glm::vec3(glm::vec2(s.dimensions.x + 0.5f * s.dimensions.y), 0.0f);
+		break;
+	}
+
+	mesh_builder::bounds b;
+	b.extend(-extent);
+	b.extend(extent);
+	return b;
+}
+
+bonobo::mesh_data
+procedural_shapes::make_mesh(shape const& s, mesh_upload::mesh_format* format)
+{
+	auto data = mesh_upload::make_empty_mesh(get_vertices_nb(s), GL_TRIANGLE_STRIP);
+
+	if (format != nullptr) {
+		*format = mesh_upload::mesh_format();
+		format->primitive = index_format::primitive_mode::triangle_strip;
+		format->bounds = get_bounds(s);
+	}
+	return data;
+}
+
+procedural_shapes::uniforms
+procedural_shapes::declare_uniforms(UniformCache& cache)
+{
+	return { cache.declare("procedural_shape"), cache.declare("procedural_dimensions"), cache.declare("procedural_edges") };
+}
+
+void
+procedural_shapes::set_uniforms(UniformCache& cache, uniforms const& ids, GLuint const program, shape const& s)
+{
+	glUniform1i(cache.get_location(program, ids.type), static_cast<GLint>(s.type));
+	glUniform2fv(cache.get_location(program, ids.dimensions), 1, glm::value_ptr(s.dimensions));
+	glUniform2i(cache.get_location(program, ids.edges), static_cast<GLint>(s.u_edges_nb), static_cast<GLint>(s.v_edges_nb));
+}
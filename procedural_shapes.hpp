@@ -0,0 +1,119 @@
+#pragma once
+
+#include "mesh_builder.hpp"
+#include "mesh_upload.hpp"
+#include "uniform_cache.hpp"
+
+#include "core/helpers.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+//! \brief Parametric shapes drawn without any vertex buffer: the vertex
+//!        shader rebuilds each vertex from gl_VertexID and a few
+//!        uniforms.
+//!
+//! The shapes are the sphere, torus and circle ring of mesh_builder,
+//! with the same split counts and the same vertices: position, normal,
+//! tangent, binormal and texture coordinates follow the formulas of
+//! parametric_surface, evaluated on the GPU instead of being uploaded.
+//! Only an empty VAO is created per mesh, so nothing is uploaded and no
+//! video memory is used besides a few uniforms.
+//!
+//! The grid is drawn with glDrawArrays() as one triangle strip, row after
+//! row, rows being joined by degenerate triangles; a vertex is computed
+//! about twice, against six times for a list of triangles. The triangles
+//! and their winding are those of build_grid_index_sets().
+//!
+//! The shaders below all start with `glsl_functions`; other vertex
+//! shaders can paste it after their #version line.
+namespace procedural_shapes
+{
+	enum class shape_type : int {
+		sphere = 0,
+		torus = 1,
+		circle_ring = 2,
+	};
+
+	//! \brief What the vertex shader needs to rebuild a shape.
+	struct shape {
+		shape_type   type{shape_type::sphere};
+		//! Sphere: radius and unused; torus: major and minor radii;
+		//! circle ring: radius and spread length.
+		glm::vec2    dimensions{1.0f, 0.0f};
+		//! Cells along u and v, as given to parametric_surface::build().
+		unsigned int u_edges_nb{1u};
+		unsigned int v_edges_nb{1u};
+	};
+
+	//! \brief Shapes matching mesh_builder::buildSphere(), buildTorus()
+	//!        and buildCircleRing() called with the same arguments.
+	shape make_sphere(float radius, unsigned int longitude_split_count, unsigned int latitude_split_count);
+	shape make_torus(float major_radius, float minor_radius,
+	                 unsigned int major_split_count, unsigned int minor_split_count);
+	shape make_circle_ring(float radius, float spread_length,
+	                       unsigned int circle_split_count, unsigned int spread_split_count);
+
+	//! \brief The same shape built on the CPU, for comparison.
+	mesh_builder::cpu_mesh build(shape const& s);
+
+	//! \brief Number of vertices of the strip drawing `s`, degenerate
+	//!        ones included.
+	std::size_t get_vertices_nb(shape const& s);
+
+	//! \brief Number of actual triangles drawn, two per cell.
+	std::size_t get_triangles_nb(shape const& s);
+
+	//! \brief Grid vertex, as (column, row), that vertex `vertex_id` of
+	//!        the strip stands for; the same mapping as `glsl_functions`.
+	glm::uvec2 get_grid_vertex(shape const& s, std::size_t vertex_id);
+
+	//! \brief Bounds of the shape, computed from its dimensions.
+	mesh_builder::bounds get_bounds(shape const& s);
+
+	//! \brief Mesh drawing `s` with an empty VAO, e.g. through
+	//!        RenderItem::set_geometry(), along with its format; the
+	//!        program still needs set_uniforms() to be called.
+	//!
+	//! Requires a current OpenGL context; delete the VAO with
+	//! glDeleteVertexArrays() once done.
+	bonobo::mesh_data make_mesh(shape const& s, mesh_upload::mesh_format* format = nullptr);
+
+	//! \brief Uniforms of `glsl_functions`, to declare once per cache.
+	struct uniforms {
+		UniformCache::uniform_id type;
+		UniformCache::uniform_id dimensions;
+		UniformCache::uniform_id edges;
+	};
+
+	uniforms declare_uniforms(UniformCache& cache);
+
+	//! \brief Set the uniforms describing `s` in `program`, which must be
+	//!        in use.
+	void set_uniforms(UniformCache& cache, uniforms const& ids, GLuint program, shape const& s);
+
+	//! \brief Declarations of the uniforms, and a function
+	//!        `procedural_vertex(int vertex_id)` returning the vertex as a
+	//!        `procedural_sample`.
+	extern char const* const glsl_functions;
+
+	//! \brief Vertex shader equivalent to
+	//!        InstancedBatch::normal_vertex_shader, to pair with
+	//!        InstancedBatch::normal_fragment_shader; it reads the camera
+	//!        from the frame_constants block.
+	extern char const* const instanced_normal_vertex_shader;
+
+	//! \brief Vertex shader writing every attribute to transform feedback,
+	//!        as `feedback_varyings` laid out as a feedback_vertex.
+	extern char const* const feedback_vertex_shader;
+	extern char const* const feedback_varyings[5];
+
+	struct feedback_vertex {
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec3 tangent;
+		glm::vec3 binormal;
+		glm::vec2 texcoord;
+	};
+}
@@ -0,0 +1,355 @@
+#include "profiler.hpp"
+
+#include "core/Log.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <thread>
+
+namespace
+{
+	struct profiler_state {
+		std::vector<profiler::frame>     frames{profiler::history_frames_nb};
+		std::size_t                      next_slot{0u};
+		std::size_t                      recorded_nb{0u};
+		std::uint64_t                    frames_nb{0u};
+		profiler::frame*                 current{nullptr};
+		std::uint32_t                    open_zones_nb{0u};
+		std::thread::id                  thread;
+		bool                             is_gpu_timing_enabled{true};
+		bool                             is_paused{false};
+		std::vector<GLuint>              free_queries;
+		std::deque<profiler::frame*>     gpu_pending;     // oldest first
+		int                              selected_age{0};
+		std::string                      export_message;
+		std::chrono::high_resolution_clock::time_point const epoch{std::chrono::high_resolution_clock::now()};
+	};
+
+	profiler_state& get_state()
+	{
+		static profiler_state state;
+		return state;
+	}
+
+	double get_time_ms(profiler_state const& state)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - state.epoch).count();
+	}
+
+	GLuint acquire_query(profiler_state& state)
+	{
+		if (state.free_queries.empty()) {
+			GLuint query = 0u;
+			glGenQueries(1, &query);
+			return query;
+		}
+		auto const query = state.free_queries.back();
+		state.free_queries.pop_back();
+		return query;
+	}
+
+	GLuint64 read_timestamp(GLuint const query)
+	{
+		GLuint64 timestamp = 0u;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timestamp);
+		return timestamp;
+	}
+
+	// Read the GPU times of the ended frames whose queries are available,
+	// oldest first; with `wait`, block until all of them are.
+	void resolve_gpu_times(profiler_state& state, bool const wait)
+	{
+		while (!state.gpu_pending.empty() && state.gpu_pending.front() != state.current) {
+			auto& f = *state.gpu_pending.front();
+
+			auto last_query = f.gpu_start_query;
+			for (auto const& z : f.zones)
+				if (z.gpu_queries[1] != 0u)
+					last_query = z.gpu_queries[1];
+			if (!wait) {
+				GLint is_available = GL_FALSE;
+				glGetQueryObjectiv(last_query, GL_QUERY_RESULT_AVAILABLE, &is_available);
+				if (is_available == GL_FALSE)
+					break;
+			}
+
+			auto const frame_start = read_timestamp(f.gpu_start_query);
+			state.free_queries.push_back(f.gpu_start_query);
+			f.gpu_start_query = 0u;
+			for (auto& z : f.zones) {
+				// A zone still open when the frame ended has no end time.
+				if (z.gpu_queries[1] == 0u) {
+					if (z.gpu_queries[0] != 0u)
+						state.free_queries.push_back(z.gpu_queries[0]);
+					z.gpu_queries[0] = 0u;
+					continue;
+				}
+				z.gpu_start = static_cast<double>(read_timestamp(z.gpu_queries[0]) - frame_start) * 1.0e-6;
+				z.gpu_end = static_cast<double>(read_timestamp(z.gpu_queries[1]) - frame_start) * 1.0e-6;
+				state.free_queries.push_back(z.gpu_queries[0]);
+				state.free_queries.push_back(z.gpu_queries[1]);
+				z.gpu_queries[0] = z.gpu_queries[1] = 0u;
+			}
+			f.is_gpu_resolved = true;
+			state.gpu_pending.pop_front();
+		}
+	}
+
+	ImU32 get_zone_colour(char const* name, bool const is_gpu)
+	{
+		static ImU32 const cpu_colours[] = {
+			IM_COL32(222, 110,  75, 255), IM_COL32( 75, 160, 222, 255), IM_COL32(120, 190,  90, 255),
+			IM_COL32(210, 170,  60, 255), IM_COL32(160, 110, 200, 255), IM_COL32( 80, 190, 170, 255)
+		};
+		auto const hash = std::hash<std::string>()(name != nullptr ? name : "");
+		auto const colour = cpu_colours[hash % (sizeof(cpu_colours) / sizeof(cpu_colours[0]))];
+		// GPU zones use a darker shade of the colour of their CPU side.
+		return is_gpu ? (colour & 0xff000000u) | ((colour >> 1u) & 0x007f7f7fu) : colour;
+	}
+
+	// Draw one lane of bars, one row per depth; returns its height.
+	float draw_lane(profiler::frame const& f, bool const is_gpu, ImVec2 const& origin, float const scale)
+	{
+		constexpr float row_height = 20.0f;
+		auto* const draw_list = ImGui::GetWindowDrawList();
+
+		std::uint32_t rows_nb = 0u;
+		for (auto const& z : f.zones) {
+			auto const start = is_gpu ? z.gpu_start : z.cpu_start;
+			auto const end = is_gpu ? z.gpu_end : z.cpu_end;
+			if (is_gpu && start < 0.0)
+				continue;
+			rows_nb = std::max(rows_nb, z.depth + 1u);
+
+			auto const min = ImVec2(origin.x + static_cast<float>(start) * scale,
+			                        origin.y + static_cast<float>(z.depth) * row_height);
+			auto const max = ImVec2(std::max(min.x + 1.0f, origin.x + static_cast<float>(end) * scale),
+			                        min.y + row_height - 1.0f);
+			draw_list->AddRectFilled(min, max, get_zone_colour(z.name, is_gpu));
+			draw_list->PushClipRect(min, max, true);
+			draw_list->AddText(ImVec2(min.x + 3.0f, min.y + 3.0f), IM_COL32(255, 255, 255, 255), z.name);
+			draw_list->PopClipRect();
+			if (ImGui::IsMouseHoveringRect(min, max))
+				ImGui::SetTooltip("%s (%s): %.3f ms", z.name, is_gpu ? "GPU" : "CPU", end - start);
+		}
+		return static_cast<float>(rows_nb) * row_height;
+	}
+}
+
+void
+profiler::begin_frame()
+{
+	auto& state = get_state();
+	state.thread = std::this_thread::get_id();
+	if (state.is_gpu_timing_enabled)
+		resolve_gpu_times(state, false);
+
+	state.current = nullptr;
+	state.open_zones_nb = 0u;
+	if (state.is_paused)
+		return;
+
+	// The GPU is very unlikely to be a whole history behind, but its
+	// times have to be read before the slot can be reused.
+	auto& f = state.frames[state.next_slot];
+	if (!f.is_gpu_resolved)
+		resolve_gpu_times(state, true);
+
+	f.index = state.frames_nb++;
+	f.start = get_time_ms(state);
+	f.cpu_duration = 0.0;
+	f.zones.clear();
+	f.gpu_start_query = 0u;
+	f.is_gpu_resolved = true;
+	if (state.is_gpu_timing_enabled) {
+		f.gpu_start_query = acquire_query(state);
+		glQueryCounter(f.gpu_start_query, GL_TIMESTAMP);
+		f.is_gpu_resolved = false;
+		state.gpu_pending.push_back(&f);
+	}
+	state.current = &f;
+}
+
+void
+profiler::end_frame()
+{
+	auto& state = get_state();
+	if (state.current == nullptr)
+		return;
+
+	state.current->cpu_duration = get_time_ms(state) - state.current->start;
+	state.current = nullptr;
+	state.next_slot = (state.next_slot + 1u) % history_frames_nb;
+	state.recorded_nb = std::min(state.recorded_nb + 1u, history_frames_nb);
+}
+
+void
+profiler::set_gpu_timing(bool const is_enabled)
+{
+	get_state().is_gpu_timing_enabled = is_enabled;
+}
+
+void
+profiler::set_paused(bool const is_paused)
+{
+	get_state().is_paused = is_paused;
+}
+
+bool
+profiler::is_paused()
+{
+	return get_state().is_paused;
+}
+
+profiler::frame const*
+profiler::get_frame(std::size_t const age)
+{
+	auto const& state = get_state();
+	if (age >= state.recorded_nb)
+		return nullptr;
+	return &state.frames[(state.next_slot + history_frames_nb - 1u - age) % history_frames_nb];
+}
+
+void
+profiler::render_ui(bool* const opened)
+{
+	auto& state = get_state();
+	if (!ImGui::Begin("Profiler", opened, ImGuiWindowFlags_None)) {
+		ImGui::End();
+		return;
+	}
+
+	auto frame_times = std::vector<float>(state.recorded_nb);
+	auto max_time = 0.0f;
+	for (std::size_t i = 0u; i < state.recorded_nb; ++i) {
+		frame_times[i] = static_cast<float>(get_frame(state.recorded_nb - 1u - i)->cpu_duration);
+		max_time = std::max(max_time, frame_times[i]);
+	}
+	ImGui::PlotLines("CPU frame time", frame_times.data(), static_cast<int>(frame_times.size()), 0,
+	                 nullptr, 0.0f, max_time, ImVec2(0.0f, 60.0f));
+
+	auto is_paused = state.is_paused;
+	if (ImGui::Checkbox("Pause", &is_paused))
+		state.is_paused = is_paused;
+	ImGui::SameLine();
+	if (ImGui::Button("Export Chrome trace")) {
+		char const* const path = "profile_trace.json";
+		state.export_message = export_chrome_trace(path) ? std::string("Exported to ") + path
+		                                                 : std::string("Failed to export to ") + path;
+	}
+	if (!state.export_message.empty()) {
+		ImGui::SameLine();
+		ImGui::Text("%s", state.export_message.c_str());
+	}
+
+	if (state.recorded_nb == 0u) {
+		ImGui::End();
+		return;
+	}
+	ImGui::SliderInt("Frames ago", &state.selected_age, 0, static_cast<int>(state.recorded_nb) - 1);
+	state.selected_age = std::min(state.selected_age, static_cast<int>(state.recorded_nb) - 1);
+	auto const& f = *get_frame(static_cast<std::size_t>(state.selected_age));
+
+	auto duration = f.cpu_duration;
+	for (auto const& z : f.zones)
+		duration = std::max(duration, z.gpu_end);
+	ImGui::Text("Frame %llu: %.3f ms on the CPU%s", static_cast<unsigned long long>(f.index), f.cpu_duration,
+	            f.is_gpu_resolved ? "" : ", GPU times pending");
+
+	auto const width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+	auto const scale = duration > 0.0 ? width / static_cast<float>(duration) : 0.0f;
+	auto origin = ImGui::GetCursorScreenPos();
+	auto const cpu_height = draw_lane(f, false, origin, scale);
+	origin.y += cpu_height + 6.0f;
+	auto const gpu_height = draw_lane(f, true, origin, scale);
+	ImGui::Dummy(ImVec2(width, cpu_height + 6.0f + gpu_height));
+
+	ImGui::End();
+}
+
+bool
+profiler::export_chrome_trace(std::string const& path)
+{
+	std::FILE* file = std::fopen(path.c_str(), "w");
+	if (file == nullptr) {
+		LogError("Failed to open \"%s\" to export the profile.", path.c_str());
+		return false;
+	}
+
+	auto const& state = get_state();
+	std::fprintf(file, "{\"traceEvents\":[\n"
+	                   "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n"
+	                   "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+	// GPU times are relative to the GPU timestamp taken at the beginning
+	// of the frame, which is aligned on its CPU start.
+	for (std::size_t age = state.recorded_nb; age-- > 0u;) {
+		auto const& f = *get_frame(age);
+		std::fprintf(file, ",\n{\"name\":\"frame %llu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+		             static_cast<unsigned long long>(f.index), 1000.0 * f.start, 1000.0 * f.cpu_duration);
+		for (auto const& z : f.zones) {
+			std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			             z.name, 1000.0 * (f.start + z.cpu_start), 1000.0 * (z.cpu_end - z.cpu_start));
+			if (z.gpu_start >= 0.0)
+				std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+				             z.name, 1000.0 * (f.start + z.gpu_start), 1000.0 * (z.gpu_end - z.gpu_start));
+		}
+	}
+	std::fprintf(file, "\n]}\n");
+
+	auto const is_written = std::ferror(file) == 0;
+	std::fclose(file);
+	return is_written;
+}
+
+profiler::CpuZone::CpuZone(char const* const name) :
+	_frame(nullptr), _zone(0u)
+{
+	auto& state = get_state();
+	if (state.current == nullptr || std::this_thread::get_id() != state.thread)
+		return;
+
+	_frame = state.current;
+	_zone = _frame->zones.size();
+	zone z;
+	z.name = name;
+	z.depth = state.open_zones_nb++;
+	z.cpu_start = get_time_ms(state) - _frame->start;
+	_frame->zones.push_back(z);
+}
+
+profiler::CpuZone::~CpuZone()
+{
+	if (_frame == nullptr)
+		return;
+
+	auto& state = get_state();
+	_frame->zones[_zone].cpu_end = get_time_ms(state) - _frame->start;
+	if (_frame == state.current)
+		--state.open_zones_nb;
+}
+
+profiler::GpuZone::GpuZone(char const* const name) :
+	CpuZone(name)
+{
+	if (_frame == nullptr || _frame->gpu_start_query == 0u)
+		return;
+
+	auto& query = _frame->zones[_zone].gpu_queries[0];
+	query = acquire_query(get_state());
+	glQueryCounter(query, GL_TIMESTAMP);
+}
+
+profiler::GpuZone::~GpuZone()
+{
+	if (_frame == nullptr || _frame->zones[_zone].gpu_queries[0] == 0u || _frame != get_state().current)
+		return;
+
+	auto& query = _frame->zones[_zone].gpu_queries[1];
+	query = acquire_query(get_state());
+	glQueryCounter(query, GL_TIMESTAMP);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/helpers.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! \brief Set to 0 to compile every PROFILE_ZONE() and PROFILE_GPU_ZONE()
+//!        to nothing.
+#if !defined(PROFILER_ENABLED)
+#	define PROFILER_ENABLED 1
+#endif
+
+//! \brief Hierarchical frame profiler.
+//!
+//! Frames are delimited by begin_frame() and end_frame(); within them,
+//! zones are opened and closed by the lifetime of the objects declared
+//! by PROFILE_ZONE() and PROFILE_GPU_ZONE(), and nest like the scopes
+//! they are declared in. GPU zones additionally record OpenGL timestamps
+//! around the commands issued in their scope; those are read back a few
+//! frames later, without stalling, once the GPU got to them.
+//!
+//! The last `history_frames_nb` frames are kept, and can be looked at in
+//! an ImGui window or exported in the Chrome trace format, to be opened
+//! in chrome://tracing or https://ui.perfetto.dev.
+//!
+//! Zone names must be string literals, or otherwise outlive the
+//! history. Only zones opened on the thread that called begin_frame()
+//! are recorded.
+namespace profiler
+{
+	constexpr std::size_t history_frames_nb = 240u;
+
+	//! \brief A zone of a recorded frame; times are in milliseconds since
+	//!        the beginning of the frame.
+	struct zone {
+		char const*   name{nullptr};
+		std::uint32_t depth{0u};
+		double        cpu_start{0.0};
+		double        cpu_end{0.0};
+		double        gpu_start{-1.0}; //!< negative if there is no GPU time
+		double        gpu_end{-1.0};
+		GLuint        gpu_queries[2]{0u, 0u};
+	};
+
+	struct frame {
+		std::uint64_t     index{0u};
+		double            start{0.0};     //!< in milliseconds since the profiler started
+		double            cpu_duration{0.0};
+		std::vector<zone> zones;          //!< in the order they were opened
+		GLuint            gpu_start_query{0u};
+		bool              is_gpu_resolved{true};
+	};
+
+	//! \brief Start recording a new frame, and collect the GPU times of
+	//!        previous frames that are available.
+	void begin_frame();
+	void end_frame();
+
+	//! \brief Whether GPU zones record timestamps; they must not when
+	//!        there is no OpenGL context. Enabled by default.
+	void set_gpu_timing(bool is_enabled);
+
+	//! \brief Stop recording new frames, to look at the history.
+	void set_paused(bool is_paused);
+	bool is_paused();
+
+	//! \brief Recorded frame, 0 being the last one ended.
+	//!
+	//! @return the frame, or nullptr if there is no such frame yet
+	frame const* get_frame(std::size_t age);
+
+	//! \brief Show the frame times and a flame graph of one frame.
+	void render_ui(bool* opened = nullptr);
+
+	//! \brief Write the whole history in the Chrome trace format; GPU
+	//!        zones are shown as a second thread.
+	//!
+	//! @return whether the file could be written
+	bool export_chrome_trace(std::string const& path);
+
+	//! \brief Zone measured on the CPU only; see PROFILE_ZONE().
+	class CpuZone {
+	public:
+		explicit CpuZone(char const* name);
+		~CpuZone();
+
+		CpuZone(CpuZone const&) = delete;
+		CpuZone& operator=(CpuZone const&) = delete;
+
+	protected:
+		frame*      _frame;
+		std::size_t _zone;
+	};
+
+	//! \brief Zone also measured on the GPU; see PROFILE_GPU_ZONE().
+	class GpuZone : public CpuZone {
+	public:
+		explicit GpuZone(char const* name);
+		~GpuZone();
+	};
+}
+
+#define PROFILER_JOIN_(a, b) a##b
+#define PROFILER_JOIN(a, b) PROFILER_JOIN_(a, b)
+
+#if PROFILER_ENABLED
+//! \brief Time the rest of the enclosing scope.
+#	define PROFILE_ZONE(name) profiler::CpuZone PROFILER_JOIN(profiler_zone_, __LINE__)(name)
+//! \brief Time the rest of the enclosing scope, and the OpenGL commands
+//!        it issues.
+#	define PROFILE_GPU_ZONE(name) profiler::GpuZone PROFILER_JOIN(profiler_zone_, __LINE__)(name)
+#else
+#	define PROFILE_ZONE(name) static_cast<void>(0)
+#	define PROFILE_GPU_ZONE(name) static_cast<void>(0)
+#endif
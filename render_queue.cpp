@@ -0,0 +1,358 @@
+#include "render_queue.hpp"
+
+#include "frame_constants.hpp"
+#include "profiler.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+void
+GLStateCache::use_program(GLuint const program)
+{
+	if (_is_program_known && _program == program) {
+		++_counters.programs_skipped;
+		return;
+	}
+	glUseProgram(program);
+	_program = program;
+	_is_program_known = true;
+	++_counters.programs_issued;
+}
+
+void
+GLStateCache::bind_vertex_array(GLuint const vao)
+{
+	if (_is_vao_known && _vao == vao) {
+		++_counters.vertex_arrays_skipped;
+		return;
+	}
+	glBindVertexArray(vao);
+	_vao = vao;
+	_is_vao_known = true;
+	++_counters.vertex_arrays_issued;
+}
+
+void
+GLStateCache::bind_texture(unsigned int const unit, GLenum const target, GLuint const texture)
+{
+	if (unit < tracked_texture_units_nb) {
+		auto const& known = _texture_units[unit];
+		if (known.is_known && known.target == target && known.texture == texture) {
+			++_counters.textures_skipped;
+			return;
+		}
+	}
+
+	if (!_is_active_unit_known || _active_unit != unit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		_active_unit = unit;
+		_is_active_unit_known = true;
+	}
+	glBindTexture(target, texture);
+	++_counters.textures_issued;
+
+	if (unit < tracked_texture_units_nb)
+		_texture_units[unit] = { target, texture, true };
+}
+
+void
+GLStateCache::count_draw()
+{
+	++_counters.draws;
+}
+
+void
+GLStateCache::invalidate()
+{
+	_is_program_known = false;
+	_is_vao_known = false;
+	_is_active_unit_known = false;
+	for (auto& unit : _texture_units)
+		unit.is_known = false;
+}
+
+GLStateCache::counters const&
+GLStateCache::get_counters() const
+{
+	return _counters;
+}
+
+void
+GLStateCache::reset_counters()
+{
+	_counters = counters();
+}
+
+void
+RenderItem::set_geometry(bonobo::mesh_data const& shape,
+                         mesh_upload::mesh_format const& format)
+{
+	_shape = shape;
+	_format = format;
+	for (auto const& binding : shape.bindings)
+		add_texture(binding.first, binding.second, GL_TEXTURE_2D);
+}
+
+void
+RenderItem::set_program(GLuint const* program,
+                        std::function<void (GLuint)> const& set_uniforms)
+{
+	_program = program;
+	_set_uniforms = set_uniforms;
+}
+
+void
+RenderItem::add_texture(std::string const& name, GLuint const texture, GLenum const type)
+{
+	_textures.push_back({ name, texture, type });
+	_uniforms_owner = nullptr;
+}
+
+void
+RenderItem::set_name(char const* const name)
+{
+	_name = name;
+}
+
+void
+RenderItem::set_instances_nb(GLsizei const instances_nb)
+{
+	_instances_nb = instances_nb;
+	_is_instanced = true;
+}
+
+void
+RenderItem::set_near_distance(float const distance)
+{
+	_near_distance = distance;
+}
+
+void
+RenderItem::set_pass(pass const p)
+{
+	_pass = p;
+}
+
+TRSTransformf&
+RenderItem::get_transform()
+{
+	return _transform;
+}
+
+TRSTransformf const&
+RenderItem::get_transform() const
+{
+	return _transform;
+}
+
+RenderQueue::RenderQueue() :
+	_vertex_model_to_world(_uniforms.declare("vertex_model_to_world")),
+	_normal_model_to_world(_uniforms.declare("normal_model_to_world")),
+	_vertex_world_to_clip(_uniforms.declare("vertex_world_to_clip")),
+	_frame_constants(_uniforms.declare_block(frame_constants::block_name, frame_constants::binding))
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+	if (_samples_queries[0] != 0u)
+		glDeleteQueries(static_cast<GLsizei>(samples_queries_nb), _samples_queries);
+}
+
+void
+RenderQueue::set_opaque_order(opaque_order const order)
+{
+	_opaque_order = order;
+}
+
+RenderQueue::opaque_order
+RenderQueue::get_opaque_order() const
+{
+	return _opaque_order;
+}
+
+void
+RenderQueue::submit(RenderItem& item)
+{
+	if (item._program == nullptr || *item._program == 0u || item._shape.vao == 0u || item._instances_nb <= 0)
+		return;
+	_items.push_back(&item);
+}
+
+void
+RenderQueue::flush(glm::mat4 const& world_to_clip)
+{
+	auto const frustum = frustum_culling::extract_frustum(world_to_clip);
+	auto const culled_begin = std::remove_if(_items.begin(), _items.end(), [&frustum](RenderItem* item) {
+		if (item->_is_instanced)
+			return false;
+		item->_near_distance = std::numeric_limits<float>::infinity();
+		if (item->_format.bounds.is_empty())
+			return false;
+		auto const s = frustum_culling::transform_bounds(item->_format.bounds, item->_transform.GetMatrix());
+		item->_near_distance = frustum_culling::get_near_distance(frustum, s);
+		return !frustum_culling::is_visible(frustum, s);
+	});
+	_culling.culled_nb += static_cast<std::size_t>(_items.end() - culled_begin);
+	_items.erase(culled_begin, _items.end());
+	_culling.visible_nb += _items.size();
+
+	auto const is_front_to_back = _opaque_order == opaque_order::front_to_back;
+	std::stable_sort(_items.begin(), _items.end(), [is_front_to_back](RenderItem const* a, RenderItem const* b) {
+		if (a->_pass != b->_pass)
+			return a->_pass < b->_pass;
+		if (is_front_to_back && a->_pass == RenderItem::pass::opaque && a->_near_distance != b->_near_distance)
+			return a->_near_distance < b->_near_distance;
+		if (*a->_program != *b->_program)
+			return *a->_program < *b->_program;
+		auto const textures_order = compare_textures(*a, *b);
+		if (textures_order != 0)
+			return textures_order < 0;
+		return a->_shape.vao < b->_shape.vao;
+	});
+
+	// Other code may have changed the bindings since the last flush.
+	_state.invalidate();
+
+	read_samples_queries(_samples_queries_issued - _samples_queries_read == samples_queries_nb);
+	if (_samples_queries[0] == 0u)
+		glGenQueries(static_cast<GLsizei>(samples_queries_nb), _samples_queries);
+	glBeginQuery(GL_SAMPLES_PASSED, _samples_queries[_samples_queries_issued % samples_queries_nb]);
+
+	RenderItem const* previous = nullptr;
+	for (auto* item : _items) {
+		PROFILE_GPU_ZONE(item->_name);
+
+		if (item->_pass == RenderItem::pass::background && (previous == nullptr || previous->_pass != item->_pass)) {
+			glDepthFunc(GL_LEQUAL);
+			glDepthMask(GL_FALSE);
+		}
+
+		auto const program = *item->_program;
+		resolve_uniforms(*item);
+
+		auto const is_new_program = previous == nullptr || *previous->_program != program;
+		_state.use_program(program);
+		if (is_new_program && !_uniforms.bind_block(program, _frame_constants))
+			glUniformMatrix4fv(_uniforms.get_location(program, _vertex_world_to_clip), 1, GL_FALSE, glm::value_ptr(world_to_clip));
+		if (item->_set_uniforms)
+			item->_set_uniforms(program);
+
+		auto const model_to_world = item->_transform.GetMatrix();
+		auto const normal_model_to_world = glm::transpose(glm::inverse(model_to_world));
+		glUniformMatrix4fv(_uniforms.get_location(program, _vertex_model_to_world), 1, GL_FALSE, glm::value_ptr(model_to_world));
+		glUniformMatrix4fv(_uniforms.get_location(program, _normal_model_to_world), 1, GL_FALSE, glm::value_ptr(normal_model_to_world));
+
+		// Sampler uniforms are per-program state: they only need to be
+		// set again if the program or the texture layout changed.
+		auto const are_samplers_set = !is_new_program && compare_textures(*previous, *item) == 0;
+		for (std::size_t i = 0u; i < item->_textures.size(); ++i) {
+			auto const& texture = item->_textures[i];
+			_state.bind_texture(static_cast<unsigned int>(i), texture.target, texture.id);
+			if (are_samplers_set)
+				continue;
+			glUniform1i(_uniforms.get_location(program, texture.sampler_uniform), static_cast<GLint>(i));
+			glUniform1i(_uniforms.get_location(program, texture.presence_uniform), 1);
+		}
+
+		_state.bind_vertex_array(item->_shape.vao);
+		mesh_upload::draw(item->_shape, item->_format, item->_instances_nb);
+		_state.count_draw();
+
+		previous = item;
+	}
+
+	glEndQuery(GL_SAMPLES_PASSED);
+	++_samples_queries_issued;
+
+	// Leave the bindings and the depth state as Node::render() does.
+	if (!_items.empty()) {
+		_state.bind_vertex_array(0u);
+		_state.use_program(0u);
+	}
+	if (previous != nullptr && previous->_pass == RenderItem::pass::background) {
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_TRUE);
+	}
+	_items.clear();
+}
+
+void
+RenderQueue::invalidate_programs()
+{
+	_uniforms.invalidate();
+}
+
+GLStateCache::counters const&
+RenderQueue::get_counters() const
+{
+	return _state.get_counters();
+}
+
+frustum_culling::statistics const&
+RenderQueue::get_culling_statistics() const
+{
+	return _culling;
+}
+
+void
+RenderQueue::reset_counters()
+{
+	_state.reset_counters();
+	_culling = frustum_culling::statistics();
+}
+
+std::uint64_t
+RenderQueue::get_samples_passed(bool const wait)
+{
+	read_samples_queries(wait);
+	return _samples_passed;
+}
+
+int
+RenderQueue::compare_textures(RenderItem const& a, RenderItem const& b)
+{
+	auto const count = std::min(a._textures.size(), b._textures.size());
+	for (std::size_t i = 0u; i < count; ++i) {
+		auto const& x = a._textures[i];
+		auto const& y = b._textures[i];
+		if (std::tie(x.target, x.id) != std::tie(y.target, y.id))
+			return std::tie(x.target, x.id) < std::tie(y.target, y.id) ? -1 : 1;
+	}
+	if (a._textures.size() == b._textures.size())
+		return 0;
+	return a._textures.size() < b._textures.size() ? -1 : 1;
+}
+
+void
+RenderQueue::read_samples_queries(bool const wait)
+{
+	for (; _samples_queries_read < _samples_queries_issued; ++_samples_queries_read) {
+		auto const query = _samples_queries[_samples_queries_read % samples_queries_nb];
+		if (!wait) {
+			GLint is_available = GL_FALSE;
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &is_available);
+			if (is_available == GL_FALSE)
+				break;
+		}
+		GLuint64 samples = 0u;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &samples);
+		_samples_passed = samples;
+	}
+}
+
+void
+RenderQueue::resolve_uniforms(RenderItem& item)
+{
+	if (item._uniforms_owner == this)
+		return;
+
+	for (auto& texture : item._textures) {
+		texture.sampler_uniform = _uniforms.declare(texture.name);
+		texture.presence_uniform = _uniforms.declare("has_" + texture.name);
+	}
+	item._uniforms_owner = this;
+}
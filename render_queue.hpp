@@ -0,0 +1,250 @@
+#pragma once
+
+#include "frustum_culling.hpp"
+#include "mesh_upload.hpp"
+#include "uniform_cache.hpp"
+
+#include "core/helpers.hpp"
+#include "core/TRSTransform.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+//! \brief Shadow copy of the OpenGL bindings the render queue touches,
+//!        used to skip calls that would not change anything.
+//!
+//! The cache only knows about calls made through it: call invalidate()
+//! whenever other code (Node::render(), ImGui, ...) may have changed
+//! those bindings.
+class GLStateCache {
+public:
+	//! \brief Number of calls issued to, and skipped instead of reaching,
+	//!        OpenGL since the last reset_counters().
+	struct counters {
+		unsigned int programs_issued{0u};
+		unsigned int programs_skipped{0u};
+		unsigned int vertex_arrays_issued{0u};
+		unsigned int vertex_arrays_skipped{0u};
+		unsigned int textures_issued{0u};
+		unsigned int textures_skipped{0u};
+		unsigned int draws{0u};
+	};
+
+	//! \brief Highest texture unit tracked; binds to further units are
+	//!        always issued.
+	static constexpr unsigned int tracked_texture_units_nb = 16u;
+
+	void use_program(GLuint program);
+	void bind_vertex_array(GLuint vao);
+	void bind_texture(unsigned int unit, GLenum target, GLuint texture);
+
+	//! \brief Count one draw call.
+	void count_draw();
+
+	//! \brief Forget the known bindings, so that the next call of each
+	//!        kind reaches OpenGL.
+	void invalidate();
+
+	counters const& get_counters() const;
+	void reset_counters();
+
+private:
+	struct texture_unit {
+		GLenum target{GL_NONE};
+		GLuint texture{0u};
+		bool   is_known{false};
+	};
+
+	GLuint       _program{0u};
+	bool         _is_program_known{false};
+	GLuint       _vao{0u};
+	bool         _is_vao_known{false};
+	unsigned int _active_unit{0u};
+	bool         _is_active_unit_known{false};
+	texture_unit _texture_units[tracked_texture_units_nb];
+	counters     _counters;
+};
+
+//! \brief Something to draw through a RenderQueue; it offers the same
+//!        set-up functions as Node.
+//!
+//! Like Node, the program gets `vertex_model_to_world`,
+//! `normal_model_to_world` and `vertex_world_to_clip`, and every texture
+//! is bound along with a `has_<name>` uniform set to 1. Programs
+//! declaring the frame_constants block read `vertex_world_to_clip` from
+//! it instead, and it is not set per program.
+class RenderItem {
+public:
+	//! \brief Part of the frame an item is drawn in; passes are drawn in
+	//!        this order.
+	enum class pass {
+		opaque,
+		//! Drawn once every opaque item is, with depth writes disabled
+		//! and GL_LEQUAL as depth test: the program is expected to put
+		//! its fragments on the far plane, e.g. for a skybox, so that
+		//! only the pixels nothing else covers get shaded.
+		background,
+	};
+
+	//! \brief Set the mesh to draw, and its upload format.
+	void set_geometry(bonobo::mesh_data const& shape,
+	                  mesh_upload::mesh_format const& format = mesh_upload::mesh_format());
+
+	//! \brief Set the program and the function setting its other
+	//!        uniforms.
+	void set_program(GLuint const* program,
+	                 std::function<void (GLuint)> const& set_uniforms = [](GLuint /*program*/){});
+
+	//! \brief Add a texture, bound to the next texture unit.
+	void add_texture(std::string const& name, GLuint texture, GLenum type);
+
+	//! \brief Set the name the draws of the item are profiled under; it
+	//!        must be a string literal.
+	void set_name(char const* name);
+
+	//! \brief Set how many instances get drawn, and mark the item as
+	//!        instanced; meant for meshes whose VAO carries per-instance
+	//!        attributes, see InstancedBatch.
+	//!
+	//! The transform and the bounds of an instanced item do not say
+	//! where its instances are, so the queue never culls it, even when
+	//! it has a single instance.
+	void set_instances_nb(GLsizei instances_nb);
+
+	//! \brief Set the distance from the near plane an instanced item is
+	//!        sorted by when opaque items are drawn front to back, e.g.
+	//!        that of its nearest instance; the queue computes it for
+	//!        the other items. Infinite by default.
+	void set_near_distance(float distance);
+
+	//! \brief Set the pass the item is drawn in; pass::opaque by default.
+	void set_pass(pass p);
+
+	TRSTransformf& get_transform();
+	TRSTransformf const& get_transform() const;
+
+private:
+	friend class RenderQueue;
+
+	struct texture {
+		std::string name;
+		GLuint      id;
+		GLenum      target;
+		// Resolved by the queue the first time it draws the item.
+		UniformCache::uniform_id sampler_uniform{0u};
+		UniformCache::uniform_id presence_uniform{0u};
+	};
+
+	char const*                  _name{"item"};
+	bonobo::mesh_data            _shape;
+	mesh_upload::mesh_format     _format;
+	GLuint const*                _program{nullptr};
+	std::function<void (GLuint)> _set_uniforms;
+	std::vector<texture>         _textures;
+	GLsizei                      _instances_nb{1};
+	bool                         _is_instanced{false};
+	pass                         _pass{pass::opaque};
+	TRSTransformf                _transform;
+	void const*                  _uniforms_owner{nullptr};
+	// Set by the queue at every flush, infinite when unknown, except
+	// for instanced items.
+	float                        _near_distance{std::numeric_limits<float>::infinity()};
+};
+
+//! \brief Collects the items to draw in a frame, and draws them pass by
+//!        pass, sorted within a pass by program, then set of textures,
+//!        then VAO, skipping the bindings that are already in place.
+//!
+//! Items with identical state keep their submission order. Items that
+//! are not instanced, and whose format carries bounds, are skipped when
+//! those are outside the view frustum; instanced ones are left to
+//! whoever fills their instance data.
+//!
+//! Opaque items can instead be drawn front to back, by the distance of
+//! their bounds to the near plane, or the one given to instanced items
+//! by RenderItem::set_near_distance(), so that the depth test rejects
+//! the hidden fragments before they get shaded; items without a
+//! distance follow in state order.
+//!
+//! Every flush counts, with an occlusion query, the samples passing the
+//! depth test; divided by the samples of the framebuffer, that is the
+//! overdraw of the frame.
+class RenderQueue {
+public:
+	//! \brief How opaque items are ordered.
+	enum class opaque_order {
+		by_state,
+		front_to_back,
+	};
+
+	RenderQueue();
+	~RenderQueue();
+
+	RenderQueue(RenderQueue const&) = delete;
+	RenderQueue& operator=(RenderQueue const&) = delete;
+
+	//! \brief Set the order of opaque items; opaque_order::front_to_back
+	//!        by default.
+	void set_opaque_order(opaque_order order);
+	opaque_order get_opaque_order() const;
+
+	//! \brief Queue an item for the next flush(); it must stay alive and
+	//!        unchanged until then.
+	void submit(RenderItem& item);
+
+	//! \brief Draw and remove every queued item.
+	//!
+	//! @param [in] world_to_clip the world-to-clip matrix of the camera
+	void flush(glm::mat4 const& world_to_clip);
+
+	//! \brief Forget resolved uniform locations; to be called after
+	//!        ShaderProgramManager::ReloadAllPrograms().
+	void invalidate_programs();
+
+	//! \brief Counters of the flushes since the last reset_counters().
+	GLStateCache::counters const& get_counters() const;
+	//! \brief Numbers of items drawn and culled by the flushes since the
+	//!        last reset_counters().
+	frustum_culling::statistics const& get_culling_statistics() const;
+	void reset_counters();
+
+	//! \brief Samples that passed the depth test during the last flush
+	//!        whose count the GPU has made available, 0 until there is
+	//!        one; counts are read a few frames late, without stalling.
+	//!
+	//! @param [in] wait whether to wait for the count of the very last
+	//!            flush instead, e.g. in tests
+	std::uint64_t get_samples_passed(bool wait = false);
+
+private:
+	// Occlusion queries used in turn by consecutive flushes.
+	static constexpr std::size_t samples_queries_nb = 4u;
+
+	// Order of the texture sets of two items: negative, zero or positive.
+	static int compare_textures(RenderItem const& a, RenderItem const& b);
+
+	void resolve_uniforms(RenderItem& item);
+	// Read the available counts of earlier flushes, in order, waiting
+	// for them if `wait` is set.
+	void read_samples_queries(bool wait);
+
+	std::vector<RenderItem*>  _items;
+	UniformCache              _uniforms;
+	UniformCache::uniform_id  _vertex_model_to_world;
+	UniformCache::uniform_id  _normal_model_to_world;
+	UniformCache::uniform_id  _vertex_world_to_clip;
+	UniformCache::block_id    _frame_constants;
+	GLStateCache              _state;
+	frustum_culling::statistics _culling;
+	opaque_order              _opaque_order{opaque_order::front_to_back};
+	GLuint                    _samples_queries[samples_queries_nb]{};
+	std::size_t               _samples_queries_issued{0u};
+	std::size_t               _samples_queries_read{0u};
+	std::uint64_t             _samples_passed{0u};
+};
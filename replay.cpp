@@ -0,0 +1,260 @@
+#include "replay.hpp"
+
+#include "course_stream.hpp"
+#include "lod.hpp"
+
+#include "config.hpp"
+#include "core/Log.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+namespace
+{
+	// v2 since the course is streamed, v3 since its rings are spaced along
+	// the spline track: older recordings flew other rings.
+	constexpr char const* recording_header = "# EDAF80 ring course input v3";
+	constexpr std::size_t ticks_per_line = 64u;
+
+	bool ends_with(std::string const& text, std::string const& suffix)
+	{
+		return text.size() >= suffix.size()
+		    && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	// Value at `fraction` of the sorted values.
+	double get_percentile(std::vector<double> values, double const fraction)
+	{
+		if (values.empty())
+			return 0.0;
+		std::sort(values.begin(), values.end());
+		auto const index = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1u) + 0.5);
+		return values[std::min(index, values.size() - 1u)];
+	}
+}
+
+flight::controls
+replay::to_controls(std::uint8_t const keys)
+{
+	flight::controls controls;
+	if (keys & key_up)
+		controls.pitch += 1.0f;
+	if (keys & key_down)
+		controls.pitch -= 1.0f;
+	if (keys & key_left)
+		controls.yaw += 1.0f;
+	if (keys & key_right)
+		controls.yaw -= 1.0f;
+	return controls;
+}
+
+bool
+replay::save(recording const& input, std::string const& path)
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file) {
+		LogError("Failed to open \"%s\" to save the input recording.", path.c_str());
+		return false;
+	}
+
+	static char const digits[] = "0123456789abcdef";
+	file << recording_header << '\n';
+	for (std::size_t i = 0u; i < input.keys.size(); ++i) {
+		file << digits[input.keys[i] & 0xfu];
+		if ((i + 1u) % ticks_per_line == 0u || i + 1u == input.keys.size())
+			file << '\n';
+	}
+	return static_cast<bool>(file);
+}
+
+bool
+replay::load(std::string const& path, recording& input)
+{
+	std::ifstream file(path);
+	if (!file) {
+		LogError("Failed to open the input recording \"%s\".", path.c_str());
+		return false;
+	}
+
+	std::string line;
+	if (!std::getline(file, line) || line != recording_header) {
+		LogError("\"%s\" is not an input recording.", path.c_str());
+		return false;
+	}
+
+	input.keys.clear();
+	while (std::getline(file, line)) {
+		for (auto const c : line) {
+			if (c >= '0' && c <= '9')
+				input.keys.push_back(static_cast<std::uint8_t>(c - '0'));
+			else if (c >= 'a' && c <= 'f')
+				input.keys.push_back(static_cast<std::uint8_t>(c - 'a' + 10));
+			else if (c != '\r') {
+				LogError("Invalid character in the input recording \"%s\".", path.c_str());
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+replay::StageClock::StageClock() :
+	_last(std::chrono::high_resolution_clock::now())
+{
+}
+
+double
+replay::StageClock::lap_ms()
+{
+	auto const now = std::chrono::high_resolution_clock::now();
+	auto const lap = std::chrono::duration<double, std::milli>(now - _last);
+	_last = now;
+	return lap.count();
+}
+
+bool
+replay::write_timings(std::vector<frame_timing> const& timings, std::string const& path)
+{
+	std::FILE* file = std::fopen(path.c_str(), "w");
+	if (file == nullptr) {
+		LogError("Failed to open \"%s\" to write the frame timings.", path.c_str());
+		return false;
+	}
+
+	if (ends_with(path, ".json")) {
+		std::fprintf(file, "{\n  \"frames\": [\n");
+		for (std::size_t i = 0u; i < timings.size(); ++i) {
+			auto const& t = timings[i];
+			std::fprintf(file, "    { \"frame\": %zu, \"ticks\": %u, \"simulation_ms\": %.6f, \"culling_ms\": %.6f, "
+			                   "\"submission_ms\": %.6f, \"swap_ms\": %.6f }%s\n",
+			             i, t.ticks_nb, t.simulation_ms, t.culling_ms, t.submission_ms, t.swap_ms,
+			             i + 1u < timings.size() ? "," : "");
+		}
+		std::fprintf(file, "  ]\n}\n");
+	} else {
+		std::fprintf(file, "frame,ticks,simulation_ms,culling_ms,submission_ms,swap_ms\n");
+		for (std::size_t i = 0u; i < timings.size(); ++i) {
+			auto const& t = timings[i];
+			std::fprintf(file, "%zu,%u,%.6f,%.6f,%.6f,%.6f\n",
+			             i, t.ticks_nb, t.simulation_ms, t.culling_ms, t.submission_ms, t.swap_ms);
+		}
+	}
+
+	auto const is_written = std::ferror(file) == 0;
+	std::fclose(file);
+	return is_written;
+}
+
+void
+replay::print_summary(std::vector<frame_timing> const& timings)
+{
+	struct stage {
+		char const* name;
+		std::function<double (frame_timing const&)> get;
+	};
+	auto const stages = std::vector<stage>{
+		{ "simulation", [](frame_timing const& t){ return t.simulation_ms; } },
+		{ "culling",    [](frame_timing const& t){ return t.culling_ms; } },
+		{ "submission", [](frame_timing const& t){ return t.submission_ms; } },
+		{ "swap",       [](frame_timing const& t){ return t.swap_ms; } }
+	};
+
+	std::printf("%zu frames, in ms:          mean     median        p95        max\n", timings.size());
+	for (auto const& s : stages) {
+		auto values = std::vector<double>();
+		values.reserve(timings.size());
+		auto total = 0.0;
+		for (auto const& t : timings) {
+			values.push_back(s.get(t));
+			total += values.back();
+		}
+		auto const mean = values.empty() ? 0.0 : total / static_cast<double>(values.size());
+		std::printf("  %-20s %10.4f %10.4f %10.4f %10.4f\n", s.name, mean,
+		            get_percentile(values, 0.5), get_percentile(values, 0.95), get_percentile(values, 1.0));
+	}
+}
+
+bool
+replay::run_headless(recording const& input, std::string const& timings_path)
+{
+	auto stream = CourseStream(flight::ship_state().position);
+	auto simulation = FlightSimulation(stream.make_course(), flight::ship_state());
+	auto const slots_nb = stream.get_parameters().pool_size;
+
+	// Same course streaming, camera and levels of detail as in
+	// Assignment5::run().
+	auto const view_to_clip = glm::perspective(0.5f * glm::half_pi<float>(),
+	                                           static_cast<float>(config::resolution_x) / static_cast<float>(config::resolution_y),
+	                                           0.01f, 1000.0f);
+	auto const thresholds = lod::make_thresholds(lod::default_levels_nb, 400.0f);
+	auto selectors = std::vector<LodSelector>(slots_nb);
+	auto ring_transforms = std::vector<glm::mat4>(slots_nb);
+	auto ring_radii = std::vector<float>(slots_nb);
+	auto const place_ring = [&](std::size_t const index) {
+		auto const& ring = simulation.get_course().get_ring(index);
+		auto const slot = stream.get_slot(index);
+		selectors[slot] = LodSelector(thresholds);
+		ring_transforms[slot] = course_stream::get_model_to_world(ring);
+		ring_radii[slot] = ring_collision::get_bounding_radius(ring);
+	};
+	for (auto i = simulation.get_course().get_first_ring(); i < simulation.get_course().get_rings_nb(); ++i)
+		place_ring(i);
+	auto levels = std::vector<unsigned int>(slots_nb);
+	auto instances = std::vector<std::vector<glm::mat4>>(lod::default_levels_nb);
+
+	auto timings = std::vector<frame_timing>();
+	timings.reserve(input.keys.size());
+	for (auto const keys : input.keys) {
+		if (simulation.is_over())
+			break;
+
+		frame_timing timing;
+		StageClock clock;
+
+		simulation.tick(to_controls(keys));
+		auto const appended_nb = stream.update(simulation.get_course());
+		for (auto i = simulation.get_course().get_rings_nb() - appended_nb; i < simulation.get_course().get_rings_nb(); ++i)
+			place_ring(i);
+		auto const state = simulation.get_interpolated_state();
+		auto const camera_position = state.position - state.get_front() * 0.015f;
+		timing.ticks_nb = 1u;
+		timing.simulation_ms = clock.lap_ms();
+
+		for (std::size_t i = 0u; i < slots_nb; ++i) {
+			auto const size = lod::screen_size(glm::vec3(ring_transforms[i][3]), ring_radii[i],
+			                                   camera_position, view_to_clip,
+			                                   static_cast<float>(config::resolution_y));
+			levels[i] = std::min(selectors[i].select(size), lod::default_levels_nb - 1u);
+		}
+		timing.culling_ms = clock.lap_ms();
+
+		for (auto& level : instances)
+			level.clear();
+		for (std::size_t i = 0u; i < slots_nb; ++i)
+			instances[levels[i]].push_back(ring_transforms[i]);
+		timing.submission_ms = clock.lap_ms();
+
+		timing.swap_ms = 0.0;
+		timings.push_back(timing);
+	}
+
+	auto const& state = simulation.get_state();
+	auto const& last_event = simulation.get_last_event();
+	std::printf("Replayed %llu of %zu ticks; ship at (%.6f, %.6f, %.6f)",
+	            static_cast<unsigned long long>(simulation.get_ticks_nb()), input.keys.size(),
+	            state.position.x, state.position.y, state.position.z);
+	if (simulation.is_over())
+		std::printf(", %s ring %zu\n", last_event.type == RingCourse::event::hit ? "hit" : "missed", last_event.ring);
+	else
+		std::printf(", next ring %zu\n", simulation.get_course().get_next_ring());
+	print_summary(timings);
+
+	if (timings_path.empty())
+		return true;
+	return write_timings(timings, timings_path);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "flight_simulation.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! \brief Recording and replaying the inputs of a run, and timing the
+//!        frames of a replay.
+//!
+//! A recording holds the state of the arrow keys at every simulation
+//! tick; since the simulation only depends on those, replaying it runs
+//! the exact same course, whatever the machine and its frame rate.
+namespace replay
+{
+	//! \brief Bits of the arrow keys in a recording.
+	enum key : std::uint8_t {
+		key_up    = 1u << 0,
+		key_down  = 1u << 1,
+		key_left  = 1u << 2,
+		key_right = 1u << 3
+	};
+
+	//! \brief Controls the keys of `keys` correspond to.
+	flight::controls to_controls(std::uint8_t keys);
+
+	struct recording {
+		std::vector<std::uint8_t> keys; //!< one entry per tick
+	};
+
+	//! \brief Write a recording as text, one hexadecimal digit per tick.
+	//!
+	//! @return whether the file could be written
+	bool save(recording const& input, std::string const& path);
+
+	//! \brief Read a recording written by save().
+	//!
+	//! @return whether the file could be read and was valid
+	bool load(std::string const& path, recording& input);
+
+	//! \brief Wall-clock time of each stage of a frame, in milliseconds.
+	struct frame_timing {
+		unsigned int ticks_nb{0u};
+		double       simulation_ms{0.0};
+		double       culling_ms{0.0};
+		double       submission_ms{0.0};
+		double       swap_ms{0.0};
+	};
+
+	//! \brief Times consecutive stages of a frame.
+	class StageClock {
+	public:
+		StageClock();
+
+		//! \brief Time since the previous call, or since the construction.
+		double lap_ms();
+
+	private:
+		std::chrono::high_resolution_clock::time_point _last;
+	};
+
+	//! \brief Write per-frame timings, as JSON if `path` ends in ".json"
+	//!        and as CSV otherwise.
+	//!
+	//! @return whether the file could be written
+	bool write_timings(std::vector<frame_timing> const& timings, std::string const& path);
+
+	//! \brief Print the mean, median, 95th percentile and maximum of each
+	//!        stage to the standard output.
+	void print_summary(std::vector<frame_timing> const& timings);
+
+	//! \brief Replay a recording on the default course without a window
+	//!        nor an OpenGL context: the rendering stages only do their
+	//!        CPU side, i.e. picking the levels of detail and gathering
+	//!        the instances to draw, and nothing gets swapped.
+	//!
+	//! One frame runs one tick. The final state is printed so that two
+	//! runs can be compared.
+	//!
+	//! @param [in] input the recording to replay
+	//! @param [in] timings_path where to write the timings; nothing is
+	//!             written if empty
+	//! @return whether the timings could be written
+	bool run_headless(recording const& input, std::string const& timings_path);
+}
@@ -0,0 +1,313 @@
+#include "ring_collision.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+float
+ring_collision::get_hole_radius(ring const& r)
+{
+	return r.major_radius - r.minor_radius;
+}
+
+float
+ring_collision::get_bounding_radius(ring const& r)
+{
+	return r.major_radius + r.minor_radius;
+}
+
+bool
+ring_collision::overlaps_tube(ring const& r, glm::vec3 const& center, float const radius)
+{
+	return get_tube_distance(r, center, radius) < 0.0f;
+}
+
+float
+ring_collision::get_tube_distance(ring const& r, glm::vec3 const& center, float const radius)
+{
+	// Distance to the circle running through the middle of the tube,
+	// from the height above the plane of the ring and the distance to
+	// its axis.
+	auto const offset = center - r.center;
+	auto const height = glm::dot(offset, r.axis);
+	auto const distance_to_axis = glm::length(offset - height * r.axis);
+	auto const radial_gap = distance_to_axis - r.major_radius;
+	return std::sqrt(radial_gap * radial_gap + height * height) - r.minor_radius - radius;
+}
+
+bool
+ring_collision::sweep_tube(ring const& r, glm::vec3 const& from, glm::vec3 const& to, float const radius,
+                           float* const time)
+{
+	// A sphere skimming the tube gets advanced by tiny steps; past this
+	// many, the rest of the move is bisected instead.
+	constexpr unsigned int max_steps_nb = 1024u;
+
+	auto const length = glm::length(to - from);
+	auto const report = [time](float const t) {
+		if (time != nullptr)
+			*time = t;
+		return true;
+	};
+
+	auto t = 0.0f;
+	auto distance = 0.0f;
+	for (unsigned int step = 0u; step < max_steps_nb; ++step) {
+		distance = get_tube_distance(r, glm::mix(from, to, t), radius);
+		if (distance < contact_tolerance)
+			return report(t);
+		if (length == 0.0f)
+			return false;
+		// The tube is at least `distance` away from the sphere, so it can
+		// move that far without touching it.
+		t += distance / length;
+		if (t > 1.0f)
+			return false;
+	}
+	distance = get_tube_distance(r, glm::mix(from, to, t), radius);
+	if (distance < contact_tolerance)
+		return report(t);
+
+	// The distance changes at most as fast as the sphere moves, which
+	// bounds it from below over an interval from its value at both ends.
+	// Intervals where that bound leaves room for an overlap get split,
+	// earliest first; once shorter than the tolerance, they can only be
+	// left if one of their ends is within it.
+	struct interval {
+		float from_t, from_distance;
+		float to_t, to_distance;
+	};
+	constexpr unsigned int max_intervals_nb = 16u * max_steps_nb;
+	auto intervals = std::vector<interval>();
+	intervals.push_back({ t, distance, 1.0f, get_tube_distance(r, to, radius) });
+	for (unsigned int i = 0u; !intervals.empty(); ++i) {
+		auto const current = intervals.back();
+		intervals.pop_back();
+		// Past the budget, assume a contact rather than miss one.
+		if (current.from_distance < contact_tolerance || i >= max_intervals_nb)
+			return report(current.from_t);
+
+		auto const span = (current.to_t - current.from_t) * length;
+		if (current.from_distance + current.to_distance > span)
+			continue;
+
+		auto const middle_t = 0.5f * (current.from_t + current.to_t);
+		auto const middle_distance = get_tube_distance(r, glm::mix(from, to, middle_t), radius);
+		intervals.push_back({ middle_t, middle_distance, current.to_t, current.to_distance });
+		intervals.push_back({ current.from_t, current.from_distance, middle_t, middle_distance });
+	}
+	return false;
+}
+
+RingCourse::RingCourse(std::vector<ring_collision::ring> rings, float const cell_size) :
+	_rings(std::move(rings)), _cell_size(cell_size)
+{
+	orient_axes(0u);
+
+	if (_cell_size <= 0.0f) {
+		for (auto const& r : _rings)
+			_cell_size = std::max(_cell_size, 2.0f * ring_collision::get_bounding_radius(r));
+		if (_cell_size <= 0.0f)
+			_cell_size = 1.0f;
+	}
+
+	add_cells(0u);
+}
+
+void
+RingCourse::append(std::vector<ring_collision::ring> const& rings)
+{
+	if (rings.empty())
+		return;
+
+	auto const first = _rings.size();
+	_rings.insert(_rings.end(), rings.begin(), rings.end());
+	orient_axes(first > 0u ? first - 1u : 0u);
+	add_cells(first);
+}
+
+void
+RingCourse::drop_rings_before(std::size_t const index)
+{
+	assert(index <= _first_ring + _next_ring);
+	if (index <= _first_ring)
+		return;
+
+	auto const dropped_nb = index - _first_ring;
+	_rings.erase(_rings.begin(), _rings.begin() + static_cast<std::ptrdiff_t>(dropped_nb));
+	_first_ring = index;
+	_next_ring -= dropped_nb;
+
+	// Every kept ring changes position in _rings, so the grid is rebuilt;
+	// this only happens once per batch of dropped rings.
+	_cells.clear();
+	add_cells(0u);
+}
+
+void
+RingCourse::reset(glm::vec3 const& position)
+{
+	_next_ring = 0u;
+	while (_next_ring < _rings.size()
+	       && glm::dot(position - _rings[_next_ring].center, _rings[_next_ring].axis) >= 0.0f)
+		++_next_ring;
+}
+
+RingCourse::result
+RingCourse::update(glm::vec3 const& previous_position, glm::vec3 const& position, float const radius)
+{
+	auto hit_time = 0.0f;
+	auto const hit_ring = find_first_contact(previous_position, position, radius, &hit_time);
+
+	auto last_passed = result();
+	while (_next_ring < _rings.size()) {
+		auto const& next = _rings[_next_ring];
+		auto const height = glm::dot(position - next.center, next.axis);
+		if (height < 0.0f)
+			break;
+
+		// When the move went through the plane of the ring.
+		auto crossing_time = 0.0f;
+		auto const previous_height = glm::dot(previous_position - next.center, next.axis);
+		if (previous_height < 0.0f)
+			crossing_time = previous_height / (previous_height - height);
+		if (hit_ring != npos && hit_time <= crossing_time)
+			break;
+
+		auto const offset = glm::mix(previous_position, position, crossing_time) - next.center;
+		auto const distance_to_axis = glm::length(offset - glm::dot(offset, next.axis) * next.axis);
+
+		auto const crossed_ring = _first_ring + _next_ring++;
+		if (distance_to_axis + radius >= ring_collision::get_hole_radius(next))
+			return { event::missed, crossed_ring };
+		last_passed = { event::passed, crossed_ring };
+	}
+
+	if (hit_ring != npos)
+		return { event::hit, hit_ring };
+	return last_passed;
+}
+
+std::size_t
+RingCourse::find_first_contact(glm::vec3 const& from, glm::vec3 const& to, float const radius,
+                               float* const time, std::size_t* const candidates_nb) const
+{
+	auto const min_cell = get_cell(glm::min(from, to) - glm::vec3(radius));
+	auto const max_cell = get_cell(glm::max(from, to) + glm::vec3(radius));
+
+	std::size_t tested_nb = 0u;
+	auto found = npos;
+	auto found_time = 0.0f;
+	for (int x = min_cell.x; x <= max_cell.x; ++x)
+		for (int y = min_cell.y; y <= max_cell.y; ++y)
+			for (int z = min_cell.z; z <= max_cell.z; ++z) {
+				auto const cell = glm::ivec3(x, y, z);
+				auto const key = get_cell_key(cell);
+				auto entry = std::lower_bound(_cells.begin(), _cells.end(), std::make_pair(key, std::uint32_t(0u)));
+				for (; entry != _cells.end() && entry->first == key; ++entry) {
+					// A ring overlapping several of the visited cells is
+					// only tested in the first of them; this also skips
+					// rings that only share the key of the cell.
+					auto const index = static_cast<std::size_t>(entry->second);
+					auto const& r = _rings[index];
+					auto const bounding_radius = ring_collision::get_bounding_radius(r);
+					auto const first_cell = glm::max(get_cell(r.center - glm::vec3(bounding_radius)), min_cell);
+					if (first_cell != cell)
+						continue;
+
+					++tested_nb;
+					auto contact_time = 0.0f;
+					if (!ring_collision::sweep_tube(r, from, to, radius, &contact_time))
+						continue;
+					if (found == npos || contact_time < found_time
+					    || (contact_time == found_time && index < found)) {
+						found = index;
+						found_time = contact_time;
+					}
+				}
+			}
+
+	if (time != nullptr && found != npos)
+		*time = found_time;
+	if (candidates_nb != nullptr)
+		*candidates_nb = tested_nb;
+	return found != npos ? _first_ring + found : npos;
+}
+
+std::size_t
+RingCourse::find_overlapping_ring(glm::vec3 const& center, float const radius,
+                                  std::size_t* const candidates_nb) const
+{
+	return find_first_contact(center, center, radius, nullptr, candidates_nb);
+}
+
+std::size_t
+RingCourse::get_next_ring() const
+{
+	return _next_ring < _rings.size() ? _first_ring + _next_ring : npos;
+}
+
+std::size_t
+RingCourse::get_first_ring() const
+{
+	return _first_ring;
+}
+
+std::size_t
+RingCourse::get_rings_nb() const
+{
+	return _first_ring + _rings.size();
+}
+
+ring_collision::ring const&
+RingCourse::get_ring(std::size_t const index) const
+{
+	assert(index >= _first_ring && index < get_rings_nb());
+	return _rings[index - _first_ring];
+}
+
+void
+RingCourse::orient_axes(std::size_t const first)
+{
+	for (std::size_t i = first; i < _rings.size(); ++i) {
+		auto& r = _rings[i];
+		r.axis = glm::normalize(r.axis);
+		if (_rings.size() < 2u)
+			continue;
+		auto const direction = i + 1u < _rings.size() ? _rings[i + 1u].center - r.center
+		                                              : r.center - _rings[i - 1u].center;
+		if (glm::dot(r.axis, direction) < 0.0f)
+			r.axis = -r.axis;
+	}
+}
+
+void
+RingCourse::add_cells(std::size_t const first)
+{
+	for (std::size_t i = first; i < _rings.size(); ++i) {
+		auto const bounding_radius = ring_collision::get_bounding_radius(_rings[i]);
+		auto const min_cell = get_cell(_rings[i].center - glm::vec3(bounding_radius));
+		auto const max_cell = get_cell(_rings[i].center + glm::vec3(bounding_radius));
+		for (int x = min_cell.x; x <= max_cell.x; ++x)
+			for (int y = min_cell.y; y <= max_cell.y; ++y)
+				for (int z = min_cell.z; z <= max_cell.z; ++z)
+					_cells.emplace_back(get_cell_key(glm::ivec3(x, y, z)), static_cast<std::uint32_t>(i));
+	}
+	std::sort(_cells.begin(), _cells.end());
+}
+
+std::uint64_t
+RingCourse::get_cell_key(glm::ivec3 const& cell) const
+{
+	constexpr std::uint64_t mask = (std::uint64_t(1u) << 21u) - 1u;
+	return ((static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.x)) & mask) << 42u)
+	     | ((static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.y)) & mask) << 21u)
+	     |  (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.z)) & mask);
+}
+
+glm::ivec3
+RingCourse::get_cell(glm::vec3 const& position) const
+{
+	return glm::ivec3(glm::floor(position / _cell_size));
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+//! \brief Geometry of the rings the ship has to fly through.
+namespace ring_collision
+{
+	//! \brief A torus as created by buildTorus(), placed in the world.
+	struct ring {
+		glm::vec3 center{0.0f};
+		glm::vec3 axis{0.0f, 1.0f, 0.0f}; //!< unit normal to the plane of the ring
+		float     major_radius{2.0f};     //!< from the centre to the middle of the tube
+		float     minor_radius{1.0f};     //!< radius of the tube
+	};
+
+	//! \brief Radius of the hole in the middle of a ring.
+	float get_hole_radius(ring const& r);
+
+	//! \brief Radius of a sphere around the centre containing the ring.
+	float get_bounding_radius(ring const& r);
+
+	//! \brief Whether a sphere overlaps the tube of a ring.
+	bool overlaps_tube(ring const& r, glm::vec3 const& center, float radius);
+
+	//! \brief Signed distance from a sphere to the tube of a ring:
+	//!        negative when they overlap.
+	float get_tube_distance(ring const& r, glm::vec3 const& center, float radius);
+
+	//! \brief First contact between the tube of a ring and a sphere
+	//!        moving in a straight line.
+	//!
+	//! The sphere is advanced by the distance to the tube, which never
+	//! goes past the first contact; it stops once it is within
+	//! `contact_tolerance` of the tube, which counts as a contact. A
+	//! sphere skimming the tube only advances by tiny steps: after a
+	//! thousand of them, the rest of the move is bisected, skipping the
+	//! parts the tube cannot reach, so a long graze is not mistaken for a
+	//! contact.
+	//!
+	//! @param [in] r the ring
+	//! @param [in] from the centre of the sphere at time 0
+	//! @param [in] to the centre of the sphere at time 1
+	//! @param [in] radius the radius of the sphere
+	//! @param [out] time if not null, receives the time of the contact,
+	//!              between 0 and 1
+	//! @return whether there is a contact between time 0 and time 1
+	bool sweep_tube(ring const& r, glm::vec3 const& from, glm::vec3 const& to, float radius,
+	                float* time = nullptr);
+
+	//! \brief Distance to the tube under which a sweep stops.
+	constexpr float contact_tolerance = 1.0e-4f;
+}
+
+//! \brief The rings of a course, in the order they have to be flown
+//!        through, indexed for collision queries.
+//!
+//! Two things end a run: touching the tube of any ring, and crossing the
+//! plane of the next ring outside of its hole.
+//!
+//! Tube contacts are looked up in a uniform grid: each ring is listed in
+//! every cell its bounding box overlaps, so a query only tests the rings
+//! listed in the few cells around the ship. The cells are kept as a
+//! sorted array of (cell, ring) pairs rather than a hash map, and cell
+//! coordinates are wrapped to 21 bits each; two cells sharing a key only
+//! cost extra candidates, never a missed contact.
+//!
+//! Ring crossings only look at the next rings along the course, which
+//! are advanced as the ship goes through them, so they cost O(1) per ring
+//! passed.
+//!
+//! A course can be streamed: rings get appended ahead of the ship, and
+//! the passed ones dropped, with append() and drop_rings_before(). Rings
+//! keep the index they were added with, so the kept ones are those in
+//! [get_first_ring(), get_rings_nb()).
+class RingCourse {
+public:
+	//! \brief Value standing for "no ring".
+	static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+	enum class event {
+		none,   //!< nothing happened
+		passed, //!< went through the hole of the next ring
+		missed, //!< crossed the plane of the next ring outside of its hole
+		hit     //!< touched the tube of a ring
+	};
+
+	struct result {
+		event       type{event::none};
+		std::size_t ring{npos};
+	};
+
+	//! @param [in] rings the rings, in course order; their axis gets
+	//!             flipped if needed to point towards the next ring
+	//! @param [in] cell_size the size of the grid cells; 0 picks the
+	//!             diameter of the largest ring
+	explicit RingCourse(std::vector<ring_collision::ring> rings = std::vector<ring_collision::ring>(),
+	                    float cell_size = 0.0f);
+
+	//! \brief Add rings at the end of the course; the cell size stays the
+	//!        one picked at construction.
+	//!
+	//! The axis of the previous last ring is flipped if needed to point
+	//! towards the first added one, as for the rings given at
+	//! construction.
+	void append(std::vector<ring_collision::ring> const& rings);
+
+	//! \brief Forget the rings before `index`: they no longer collide nor
+	//!        take any memory. Only rings already passed can be dropped.
+	void drop_rings_before(std::size_t index);
+
+	//! \brief Restart the course from `position`: rings that are already
+	//!        behind it are skipped.
+	void reset(glm::vec3 const& position);
+
+	//! \brief Check a move of the ship, a sphere of radius `radius`, from
+	//!        `previous_position` to `position`.
+	//!
+	//! The whole move is checked, however long it is, so the outcome does
+	//! not depend on how it is split into frames. Several rings can be
+	//! passed in one call; the first event ending the run is returned if
+	//! there is one, the last ring passed otherwise.
+	result update(glm::vec3 const& previous_position, glm::vec3 const& position, float radius);
+
+	//! \brief First ring whose tube is touched by a sphere moving in a
+	//!        straight line.
+	//!
+	//! @param [in] from the centre of the sphere at time 0
+	//! @param [in] to the centre of the sphere at time 1
+	//! @param [in] radius the radius of the sphere
+	//! @param [out] time if not null, receives the time of the contact
+	//! @param [out] candidates_nb if not null, receives the number of
+	//!              rings that were tested
+	//! @return the index of the ring touched first, or npos
+	std::size_t find_first_contact(glm::vec3 const& from, glm::vec3 const& to, float radius,
+	                               float* time = nullptr, std::size_t* candidates_nb = nullptr) const;
+
+	//! \brief First ring whose tube overlaps the given sphere.
+	//!
+	//! @param [in] center the centre of the sphere
+	//! @param [in] radius the radius of the sphere
+	//! @param [out] candidates_nb if not null, receives the number of
+	//!              rings that were tested
+	//! @return the index of the ring, or npos
+	std::size_t find_overlapping_ring(glm::vec3 const& center, float radius,
+	                                  std::size_t* candidates_nb = nullptr) const;
+
+	//! \brief Index of the next ring to fly through, or npos once all of
+	//!        them were passed.
+	std::size_t get_next_ring() const;
+
+	//! \brief Index of the first ring kept, 0 unless rings were dropped.
+	std::size_t get_first_ring() const;
+
+	//! \brief Number of rings added so far, dropped ones included.
+	std::size_t get_rings_nb() const;
+
+	//! @param [in] index between get_first_ring() and get_rings_nb()
+	ring_collision::ring const& get_ring(std::size_t index) const;
+
+private:
+	// Normalise the axes from `first` on, and flip those pointing away
+	// from the next ring.
+	void orient_axes(std::size_t first);
+	// List the rings from `first` on in the grid.
+	void add_cells(std::size_t first);
+	std::uint64_t get_cell_key(glm::ivec3 const& cell) const;
+	glm::ivec3 get_cell(glm::vec3 const& position) const;
+
+	// Indices in _rings, _cells and _next_ring start at _first_ring.
+	std::vector<ring_collision::ring>                   _rings;
+	float                                               _cell_size;
+	std::vector<std::pair<std::uint64_t, std::uint32_t>> _cells; // sorted by key, then ring
+	std::size_t                                         _first_ring{0u};
+	std::size_t                                         _next_ring{0u};
+};
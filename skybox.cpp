@@ -0,0 +1,59 @@
+#include "skybox.hpp"
+
+#include "frame_constants.hpp"
+#include "mesh_upload.hpp"
+
+#include <string>
+
+namespace
+{
+	// The camera comes from the per-frame uniform buffer.
+	std::string const vertex_source = std::string("#version 410\n") + frame_constants::glsl_declaration + R"glsl(
+uniform mat4 vertex_model_to_world;
+
+out VS_OUT {
+	vec3 direction;
+} vs_out;
+
+void main()
+{
+	// (-1, -1), (3, -1) and (-1, 3): the screen is the part of the
+	// triangle inside the clip volume.
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+
+	// z equal to w puts every fragment at a depth of 1.
+	gl_Position = vec4(corner, 1.0, 1.0);
+
+	// The model space is centred on the camera, so the point of the far
+	// plane behind the corner is also the direction to it. Its w is
+	// positive, so dividing by it does not change the direction, and the
+	// direction stays linear across the screen for the interpolation.
+	vs_out.direction = (inverse(vertex_world_to_clip * vertex_model_to_world) * gl_Position).xyz;
+}
+)glsl";
+}
+
+char const* const skybox::vertex_shader = vertex_source.c_str();
+
+char const* const skybox::fragment_shader = R"glsl(
+#version 410
+
+uniform samplerCube skybox_cube_map;
+
+in VS_OUT {
+	vec3 direction;
+} fs_in;
+
+out vec4 frag_color;
+
+void main()
+{
+	frag_color = texture(skybox_cube_map, normalize(fs_in.direction));
+}
+)glsl";
+
+bonobo::mesh_data
+skybox::make_mesh()
+{
+	return mesh_upload::make_empty_mesh(3u, GL_TRIANGLES);
+}
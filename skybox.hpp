@@ -0,0 +1,29 @@
+#pragma once
+
+#include "core/helpers.hpp"
+
+//! \brief Skybox drawn as a single triangle covering the screen, on the
+//!        far plane.
+//!
+//! The triangle replaces a sphere around the camera: it has three
+//! vertices, generated by the vertex shader from gl_VertexID, and no
+//! vertex buffer. Drawn in RenderItem::pass::background, after every
+//! opaque item, only the pixels nothing else covers pass the depth test
+//! and get shaded.
+//!
+//! The vertex shader reads `vertex_world_to_clip` from the
+//! frame_constants block, and the usual `vertex_model_to_world` uniform;
+//! the model transform has to be a translation to the camera position, as for a sphere centred on the
+//! camera. The direction looked up in the cube map `skybox_cube_map` is
+//! then that of the point of the far plane seen through each pixel.
+namespace skybox
+{
+	extern char const* const vertex_shader;
+	extern char const* const fragment_shader;
+
+	//! \brief Mesh drawing the triangle: an empty VAO and three vertices.
+	//!
+	//! Requires a current OpenGL context; delete the VAO with
+	//! glDeleteVertexArrays() once done.
+	bonobo::mesh_data make_mesh();
+}
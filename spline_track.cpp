@@ -0,0 +1,421 @@
+#include "spline_track.hpp"
+
+#include "fast_trig.hpp"
+#include "interpolation.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// How far a hinted lookup walks the table before searching it.
+	constexpr std::size_t max_walked_samples_nb = 8u;
+
+	float get_squared_distance(glm::vec3 const& position, glm::vec3 const& min, glm::vec3 const& max)
+	{
+		auto const offset = glm::max(glm::max(min - position, position - max), glm::vec3(0.0f));
+		return glm::dot(offset, offset);
+	}
+}
+
+SplineTrack::SplineTrack(float const tension, unsigned int const samples_per_segment) :
+	_tension(tension), _samples_per_segment(std::max(samples_per_segment, 1u))
+{
+}
+
+SplineTrack::SplineTrack(std::vector<glm::vec3> const& control_points, float const tension,
+                         unsigned int const samples_per_segment) :
+	SplineTrack(tension, samples_per_segment)
+{
+	for (auto const& control_point : control_points) {
+		_control_points.push_back(control_point);
+		if (_control_points.size() >= 4u)
+			add_segment();
+	}
+	build_hierarchy();
+}
+
+void
+SplineTrack::append(glm::vec3 const& control_point)
+{
+	_control_points.push_back(control_point);
+	if (_control_points.size() < 4u)
+		return;
+	add_segment();
+	build_hierarchy();
+}
+
+void
+SplineTrack::drop_segments_before(float const distance)
+{
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	std::size_t dropped_nb = 0u;
+	while (dropped_nb < _segments.size()
+	       && _sample_distances[dropped_nb * entries_nb + _samples_per_segment] < distance)
+		++dropped_nb;
+	if (dropped_nb == 0u)
+		return;
+
+	auto const dropped_entries = static_cast<std::ptrdiff_t>(dropped_nb * entries_nb);
+	_segments.erase(_segments.begin(), _segments.begin() + static_cast<std::ptrdiff_t>(dropped_nb));
+	_control_points.erase(_control_points.begin(), _control_points.begin() + static_cast<std::ptrdiff_t>(dropped_nb));
+	_sample_distances.erase(_sample_distances.begin(), _sample_distances.begin() + dropped_entries);
+	_sample_positions.erase(_sample_positions.begin(), _sample_positions.begin() + dropped_entries);
+	_first_segment += dropped_nb;
+	build_hierarchy();
+}
+
+void
+SplineTrack::set_control_point(std::size_t const index, glm::vec3 const& position)
+{
+	assert(index >= _first_segment && index - _first_segment < _control_points.size());
+	auto const local = index - _first_segment;
+	_control_points[local] = position;
+
+	auto const first = local >= 3u ? local - 3u : 0u;
+	auto const end = std::min(local + 1u, _segments.size());
+	if (first >= end)
+		return;
+
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	auto const previous_end = _sample_distances[end * entries_nb - 1u];
+	auto distance = _sample_distances[first * entries_nb];
+	for (auto i = first; i < end; ++i) {
+		_segments[i] = make_segment(i);
+		distance = sample_segment(i, distance);
+	}
+
+	// The segments after the ones changed keep their shape, only their
+	// distances shift.
+	auto const shift = distance - previous_end;
+	for (auto i = end * entries_nb; i < _sample_distances.size(); ++i)
+		_sample_distances[i] += shift;
+	_end = _sample_distances.back();
+	build_hierarchy();
+}
+
+glm::vec3 const&
+SplineTrack::get_control_point(std::size_t const index) const
+{
+	assert(index >= _first_segment && index - _first_segment < _control_points.size());
+	return _control_points[index - _first_segment];
+}
+
+std::size_t
+SplineTrack::get_first_segment() const
+{
+	return _first_segment;
+}
+
+std::size_t
+SplineTrack::get_segments_nb() const
+{
+	return _segments.size();
+}
+
+float
+SplineTrack::get_segment_start(std::size_t const segment) const
+{
+	assert(segment >= _first_segment && segment - _first_segment < _segments.size());
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	return _sample_distances[(segment - _first_segment) * entries_nb];
+}
+
+float
+SplineTrack::get_segment_end(std::size_t const segment) const
+{
+	assert(segment >= _first_segment && segment - _first_segment < _segments.size());
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	return _sample_distances[(segment - _first_segment) * entries_nb + _samples_per_segment];
+}
+
+float
+SplineTrack::get_start() const
+{
+	return _sample_distances.empty() ? _end : _sample_distances.front();
+}
+
+float
+SplineTrack::get_end() const
+{
+	return _end;
+}
+
+spline_track::point
+SplineTrack::get_point(float const distance) const
+{
+	spline_track::point p;
+	if (_segments.empty())
+		return p;
+
+	auto const l = locate(distance);
+	auto const& s = _segments[l.segment];
+	p.position = evaluate(s, l.x);
+	auto const derivative = s.b + l.x * (2.0f * s.c + l.x * (3.0f * s.d));
+	auto const length = glm::length(derivative);
+	if (length > 0.0f)
+		p.tangent = derivative / length;
+	return p;
+}
+
+glm::vec3
+SplineTrack::get_position(float const distance) const
+{
+	if (_segments.empty())
+		return glm::vec3(0.0f);
+	auto const l = locate(distance);
+	return evaluate(_segments[l.segment], l.x);
+}
+
+spline_track::nearest_point
+SplineTrack::find_nearest(glm::vec3 const& position) const
+{
+	spline_track::nearest_point nearest;
+	nearest.distance = get_start();
+	nearest.squared_distance = std::numeric_limits<float>::infinity();
+	if (_segments.empty())
+		return nearest;
+
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	auto const first_leaf = _leaves_nb - 1u;
+
+	// Depth first, nearer child first, skipping the boxes farther than the
+	// best chord found so far.
+	std::size_t stack[64];
+	std::size_t stack_size = 0u;
+	stack[stack_size++] = 0u;
+	while (stack_size > 0u) {
+		auto const node = stack[--stack_size];
+		auto const& b = _hierarchy[node];
+		if (get_squared_distance(position, b.min, b.max) >= nearest.squared_distance)
+			continue;
+
+		if (node < first_leaf) {
+			auto const left = 2u * node + 1u, right = 2u * node + 2u;
+			auto const left_distance = get_squared_distance(position, _hierarchy[left].min, _hierarchy[left].max);
+			auto const right_distance = get_squared_distance(position, _hierarchy[right].min, _hierarchy[right].max);
+			stack[stack_size++] = left_distance < right_distance ? right : left;
+			stack[stack_size++] = left_distance < right_distance ? left : right;
+			continue;
+		}
+
+		auto const first = (node - first_leaf) * entries_nb;
+		for (std::size_t i = first; i < first + _samples_per_segment; ++i) {
+			auto const& from = _sample_positions[i];
+			auto const chord = _sample_positions[i + 1u] - from;
+			auto const chord_squared_length = glm::dot(chord, chord);
+			auto const t = chord_squared_length > 0.0f
+			             ? glm::clamp(glm::dot(position - from, chord) / chord_squared_length, 0.0f, 1.0f)
+			             : 0.0f;
+			auto const offset = from + t * chord - position;
+			auto const squared_distance = glm::dot(offset, offset);
+			if (squared_distance < nearest.squared_distance) {
+				nearest.squared_distance = squared_distance;
+				nearest.distance = glm::mix(_sample_distances[i], _sample_distances[i + 1u], t);
+			}
+		}
+	}
+
+	nearest.position = get_position(nearest.distance);
+	auto const offset = nearest.position - position;
+	nearest.squared_distance = glm::dot(offset, offset);
+	return nearest;
+}
+
+void
+SplineTrack::get_positions_scalar(float const* const distances, std::size_t const count, glm::vec3* const positions) const
+{
+	for (std::size_t i = 0u; i < count; ++i)
+		positions[i] = get_position(distances[i]);
+}
+
+#if defined(FAST_TRIG_USE_SSE2)
+
+void
+SplineTrack::get_positions(float const* const distances, std::size_t const count, glm::vec3* const positions) const
+{
+	if (_segments.empty()) {
+		std::fill(positions, positions + count, glm::vec3(0.0f));
+		return;
+	}
+
+	constexpr std::size_t lanes = 4u;
+
+	std::size_t hint = 0u;
+	auto const vectorised_end = count / lanes * lanes;
+	for (std::size_t i = 0u; i < vectorised_end; i += lanes) {
+		segment const* s[lanes];
+		float x[lanes];
+		for (std::size_t l = 0u; l < lanes; ++l) {
+			auto const found = locate(distances[i + l], hint);
+			s[l] = &_segments[found.segment];
+			x[l] = found.x;
+			hint = found.sample;
+		}
+
+		// Horner's scheme on four points at once, one coordinate at a
+		// time.
+		auto const parameter = _mm_loadu_ps(x);
+		float coordinates[3][lanes];
+		for (int c = 0; c < 3; ++c) {
+			auto const a = _mm_setr_ps(s[0]->a[c], s[1]->a[c], s[2]->a[c], s[3]->a[c]);
+			auto const b = _mm_setr_ps(s[0]->b[c], s[1]->b[c], s[2]->b[c], s[3]->b[c]);
+			auto const cc = _mm_setr_ps(s[0]->c[c], s[1]->c[c], s[2]->c[c], s[3]->c[c]);
+			auto const d = _mm_setr_ps(s[0]->d[c], s[1]->d[c], s[2]->d[c], s[3]->d[c]);
+			auto value = _mm_add_ps(cc, _mm_mul_ps(parameter, d));
+			value = _mm_add_ps(b, _mm_mul_ps(parameter, value));
+			value = _mm_add_ps(a, _mm_mul_ps(parameter, value));
+			_mm_storeu_ps(coordinates[c], value);
+		}
+		for (std::size_t l = 0u; l < lanes; ++l)
+			positions[i + l] = glm::vec3(coordinates[0][l], coordinates[1][l], coordinates[2][l]);
+	}
+	for (std::size_t i = vectorised_end; i < count; ++i) {
+		auto const found = locate(distances[i], hint);
+		positions[i] = evaluate(_segments[found.segment], found.x);
+		hint = found.sample;
+	}
+}
+
+#else
+
+void
+SplineTrack::get_positions(float const* const distances, std::size_t const count, glm::vec3* const positions) const
+{
+	if (_segments.empty()) {
+		std::fill(positions, positions + count, glm::vec3(0.0f));
+		return;
+	}
+
+	std::size_t hint = 0u;
+	for (std::size_t i = 0u; i < count; ++i) {
+		auto const found = locate(distances[i], hint);
+		positions[i] = evaluate(_segments[found.segment], found.x);
+		hint = found.sample;
+	}
+}
+
+#endif
+
+SplineTrack::location
+SplineTrack::locate(float const distance, std::size_t const hint) const
+{
+	assert(!_segments.empty());
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	auto const& table = _sample_distances;
+	auto const clamped = glm::clamp(distance, table.front(), table.back());
+
+	// First entry past the distance; ties go to the first entry of the
+	// next segment rather than the last one of the previous segment.
+	auto first = table.begin();
+	if (hint < table.size() && table[hint] <= clamped) {
+		first = table.begin() + static_cast<std::ptrdiff_t>(hint);
+		auto const walk_end = table.begin() + static_cast<std::ptrdiff_t>(std::min(hint + max_walked_samples_nb, table.size()));
+		while (first != walk_end && *first <= clamped)
+			++first;
+		if (first == walk_end)
+			first = std::upper_bound(first, table.end(), clamped);
+	} else {
+		first = std::upper_bound(table.begin(), table.end(), clamped);
+	}
+	auto entry = static_cast<std::size_t>(first - table.begin());
+	entry = entry > 0u ? entry - 1u : 0u;
+
+	location l;
+	l.segment = std::min(entry / entries_nb, _segments.size() - 1u);
+	auto sample = entry - l.segment * entries_nb;
+	if (sample == _samples_per_segment)
+		--sample;
+	l.sample = l.segment * entries_nb + sample;
+
+	auto const from = table[l.sample], to = table[l.sample + 1u];
+	auto const fraction = to > from ? glm::clamp((clamped - from) / (to - from), 0.0f, 1.0f) : 0.0f;
+	l.x = (static_cast<float>(sample) + fraction) / static_cast<float>(_samples_per_segment);
+	return l;
+}
+
+glm::vec3
+SplineTrack::evaluate(segment const& s, float const x)
+{
+	return s.a + x * (s.b + x * (s.c + x * s.d));
+}
+
+SplineTrack::segment
+SplineTrack::make_segment(std::size_t const first) const
+{
+	assert(first + 3u < _control_points.size());
+	auto const& p = _control_points;
+	auto const evaluate_spline = [this, &p, first](float const x) {
+		return interpolation::evalCatmullRom(p[first], p[first + 1u], p[first + 2u], p[first + 3u], _tension, x);
+	};
+
+	// The cubic is recovered from four evaluations, at 0, 1/3, 2/3 and 1,
+	// so that it matches evalCatmullRom() whatever its conventions. It is
+	// solved for offsets from the first one, which stay accurate far from
+	// the origin.
+	auto const f0 = evaluate_spline(0.0f);
+	auto const f1 = evaluate_spline(1.0f / 3.0f) - f0;
+	auto const f2 = evaluate_spline(2.0f / 3.0f) - f0;
+	auto const f3 = evaluate_spline(1.0f) - f0;
+	segment s;
+	s.a = f0;
+	s.b = 0.5f * (18.0f * f1 - 9.0f * f2 + 2.0f * f3);
+	s.c = 0.5f * (-45.0f * f1 + 36.0f * f2 - 9.0f * f3);
+	s.d = 4.5f * (3.0f * f1 - 3.0f * f2 + f3);
+	return s;
+}
+
+float
+SplineTrack::sample_segment(std::size_t const index, float distance)
+{
+	auto const& s = _segments[index];
+	auto const first = index * (static_cast<std::size_t>(_samples_per_segment) + 1u);
+	auto previous = evaluate(s, 0.0f);
+	for (unsigned int i = 0u; i <= _samples_per_segment; ++i) {
+		auto const position = evaluate(s, static_cast<float>(i) / static_cast<float>(_samples_per_segment));
+		distance += glm::length(position - previous);
+		_sample_distances[first + i] = distance;
+		_sample_positions[first + i] = position;
+		previous = position;
+	}
+	return distance;
+}
+
+void
+SplineTrack::add_segment()
+{
+	auto const index = _segments.size();
+	_segments.push_back(make_segment(index));
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	_sample_distances.resize(_sample_distances.size() + entries_nb);
+	_sample_positions.resize(_sample_positions.size() + entries_nb);
+	_end = sample_segment(index, _end);
+}
+
+void
+SplineTrack::build_hierarchy()
+{
+	_leaves_nb = 1u;
+	while (_leaves_nb < _segments.size())
+		_leaves_nb *= 2u;
+
+	auto const empty = box{ glm::vec3(std::numeric_limits<float>::infinity()),
+	                        glm::vec3(-std::numeric_limits<float>::infinity()) };
+	_hierarchy.assign(2u * _leaves_nb - 1u, empty);
+
+	auto const entries_nb = static_cast<std::size_t>(_samples_per_segment) + 1u;
+	auto const first_leaf = _leaves_nb - 1u;
+	for (std::size_t i = 0u; i < _segments.size(); ++i) {
+		auto& b = _hierarchy[first_leaf + i];
+		for (std::size_t j = i * entries_nb; j < (i + 1u) * entries_nb; ++j) {
+			b.min = glm::min(b.min, _sample_positions[j]);
+			b.max = glm::max(b.max, _sample_positions[j]);
+		}
+	}
+	for (auto node = first_leaf; node-- > 0u;) {
+		_hierarchy[node].min = glm::min(_hierarchy[2u * node + 1u].min, _hierarchy[2u * node + 2u].min);
+		_hierarchy[node].max = glm::max(_hierarchy[2u * node + 1u].max, _hierarchy[2u * node + 2u].max);
+	}
+}
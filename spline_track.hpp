@@ -0,0 +1,148 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+//! \brief Catmull-Rom splines parameterised by arc length.
+namespace spline_track
+{
+	//! \brief A point of a track and the unit tangent there.
+	struct point {
+		glm::vec3 position{0.0f};
+		glm::vec3 tangent{0.0f, 0.0f, -1.0f};
+	};
+
+	//! \brief Result of SplineTrack::find_nearest().
+	struct nearest_point {
+		float     distance{0.0f};         //!< along the track
+		glm::vec3 position{0.0f};
+		float     squared_distance{0.0f}; //!< from the queried point
+	};
+}
+
+//! \brief A Catmull-Rom spline through a sequence of control points,
+//!        addressed by the distance travelled along it.
+//!
+//! Segment `i` runs from control point `i + 1` to control point `i + 2`,
+//! as evaluated by interpolation::evalCatmullRom(); the first and last
+//! control points only shape the ends. Each segment is sampled uniformly
+//! in its parameter into a table of cumulative lengths, so a distance is
+//! mapped to a parameter by a binary search and a linear interpolation
+//! between two samples, instead of integrating the curve again. The
+//! points returned are on the actual curve; only the mapping from
+//! distance to parameter is approximated.
+//!
+//! Nearest-point queries walk a bounding box hierarchy over the segments
+//! and then test the chords between the samples of the closest ones.
+//!
+//! Control points can be appended and dropped from the front, for tracks
+//! streamed along with the course; distances keep counting from the
+//! start of the first segment ever added. They are floats: 100000 units
+//! along the track, they only resolve about 0.01.
+class SplineTrack {
+public:
+	//! @param [in] tension the tension given to evalCatmullRom()
+	//! @param [in] samples_per_segment the number of length samples of
+	//!             each segment
+	explicit SplineTrack(float tension = 0.5f, unsigned int samples_per_segment = 32u);
+
+	SplineTrack(std::vector<glm::vec3> const& control_points, float tension = 0.5f,
+	            unsigned int samples_per_segment = 32u);
+
+	//! \brief Add a control point at the end; once there are four, each
+	//!        new one adds a segment.
+	void append(glm::vec3 const& control_point);
+
+	//! \brief Drop the segments ending before `distance`, and the control
+	//!        points only they used.
+	void drop_segments_before(float distance);
+
+	//! \brief Move control point `index`, counted from the first one ever
+	//!        added; segments `index - 3` to `index` change, and the
+	//!        distances of the following ones shift by the difference in
+	//!        length.
+	void set_control_point(std::size_t index, glm::vec3 const& position);
+	glm::vec3 const& get_control_point(std::size_t index) const;
+
+	//! \brief Index of the first segment kept, counted from the first one
+	//!        ever added; it is also the index of the first control point
+	//!        kept.
+	std::size_t get_first_segment() const;
+
+	std::size_t get_segments_nb() const;
+
+	//! \brief Distances of the ends of segment `segment`, counted from the
+	//!        first one ever added.
+	float get_segment_start(std::size_t segment) const;
+	float get_segment_end(std::size_t segment) const;
+
+	//! \brief Distance of the start of the first segment kept.
+	float get_start() const;
+
+	//! \brief Distance of the end of the last segment.
+	float get_end() const;
+
+	//! \brief Point at a distance along the track, clamped to
+	//!        [get_start(), get_end()].
+	spline_track::point get_point(float distance) const;
+	glm::vec3 get_position(float distance) const;
+
+	//! \brief Point of the track closest to `position`, up to the
+	//!        sampling of the segments.
+	spline_track::nearest_point find_nearest(glm::vec3 const& position) const;
+
+	//! \brief Positions at many distances at once, vectorised when
+	//!        possible; increasing distances are looked up by walking the
+	//!        table rather than searching it.
+	void get_positions(float const* distances, std::size_t count, glm::vec3* positions) const;
+
+	//! \brief Same as get_positions(), one distance at a time with a full
+	//!        search each; for comparison.
+	void get_positions_scalar(float const* distances, std::size_t count, glm::vec3* positions) const;
+
+private:
+	// Cubic of a segment, a + b x + c x^2 + d x^3.
+	struct segment {
+		glm::vec3 a, b, c, d;
+	};
+	struct box {
+		glm::vec3 min{0.0f};
+		glm::vec3 max{0.0f};
+	};
+	struct location {
+		std::size_t segment{0u};
+		float       x{0.0f};      //!< parameter in the segment, in [0, 1]
+		std::size_t sample{0u};   //!< table entry at or before the distance
+	};
+
+	// Where a distance falls; the table is searched from `hint` on when
+	// the distance is not before that entry, from the start otherwise.
+	location locate(float distance, std::size_t hint = 0u) const;
+	static glm::vec3 evaluate(segment const& s, float x);
+	// Cubic of the segment starting at local control point `first`.
+	segment make_segment(std::size_t first) const;
+	// Fill the table entries of local segment `index`, starting from
+	// `distance`; return the distance at its end.
+	float sample_segment(std::size_t index, float distance);
+	void add_segment();
+	void build_hierarchy();
+
+	float                  _tension;
+	unsigned int           _samples_per_segment;
+	std::vector<glm::vec3> _control_points;
+	std::size_t            _first_segment{0u};
+	std::vector<segment>   _segments;
+	// samples_per_segment + 1 entries per segment, the last one of a
+	// segment being repeated as the first one of the next.
+	std::vector<float>     _sample_distances;
+	std::vector<glm::vec3> _sample_positions;
+	// Complete binary tree over the segments, root first; the leaves are
+	// the last _leaves_nb nodes, padded with empty boxes.
+	std::vector<box>       _hierarchy;
+	std::size_t            _leaves_nb{0u};
+	// Distance of the end of the track, kept when every segment is
+	// dropped.
+	float                  _end{0.0f};
+};
@@ -0,0 +1,299 @@
+#include "swept_tube.hpp"
+
+#include "parametric_surface.hpp"
+#include "vertex_format.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	// Below this squared length, two frames are taken to be at the same
+	// point, or to have the same tangent.
+	constexpr float degenerate_squared_length = 1.0e-12f;
+
+	// `normal` made orthogonal to `tangent` again, and of unit length;
+	// reflections and rounding let it drift slightly.
+	glm::vec3 orthonormalize(glm::vec3 const& normal, glm::vec3 const& tangent)
+	{
+		return parametric_surface::safe_normalize(normal - glm::dot(normal, tangent) * tangent);
+	}
+}
+
+mesh_builder::sweep_frame
+swept_tube::make_first_frame(spline_track::point const& p)
+{
+	auto const reference = std::abs(p.tangent.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+
+	mesh_builder::sweep_frame frame;
+	frame.position = p.position;
+	frame.tangent = p.tangent;
+	frame.normal = glm::normalize(glm::cross(reference, p.tangent));
+	return frame;
+}
+
+void
+swept_tube::compute_frames(SplineTrack const& track, std::size_t const first_segment, std::size_t const end_segment,
+                           unsigned int const rows_per_segment, mesh_builder::sweep_frame const& first,
+                           glm::vec3 const* const last_normal, std::vector<mesh_builder::sweep_frame>& frames)
+{
+	assert(first_segment < end_segment && rows_per_segment > 0u);
+	frames.clear();
+
+	auto const add_frame = [&frames](spline_track::point const& p) {
+		auto const& previous = frames.back();
+		mesh_builder::sweep_frame frame;
+		frame.position = p.position;
+		frame.tangent = p.tangent;
+
+		// Reflect the previous frame across the plane bisecting the two
+		// points, then across the one bisecting the reflected tangent and
+		// the actual one.
+		auto const step = frame.position - previous.position;
+		auto const step_squared_length = glm::dot(step, step);
+		if (step_squared_length <= degenerate_squared_length) {
+			frame.normal = orthonormalize(previous.normal, frame.tangent);
+			frames.push_back(frame);
+			return;
+		}
+		auto const reflected_normal = previous.normal - (2.0f / step_squared_length) * glm::dot(step, previous.normal) * step;
+		auto const reflected_tangent = previous.tangent - (2.0f / step_squared_length) * glm::dot(step, previous.tangent) * step;
+		auto const correction = frame.tangent - reflected_tangent;
+		auto const correction_squared_length = glm::dot(correction, correction);
+		frame.normal = correction_squared_length > degenerate_squared_length
+		             ? reflected_normal - (2.0f / correction_squared_length) * glm::dot(correction, reflected_normal) * correction
+		             : reflected_normal;
+		frame.normal = orthonormalize(frame.normal, frame.tangent);
+		frames.push_back(frame);
+	};
+
+	for (auto segment = first_segment; segment < end_segment; ++segment) {
+		auto const start = track.get_segment_start(segment);
+		auto const end = track.get_segment_end(segment);
+		auto const rows_nb = segment + 1u == end_segment ? rows_per_segment + 1u : rows_per_segment;
+		for (unsigned int row = 0u; row < rows_nb; ++row) {
+			// The ends are looked up exactly, so that segments computed
+			// separately share their joints.
+			auto const distance = row == rows_per_segment ? end
+			                    : start + (end - start) * static_cast<float>(row) / static_cast<float>(rows_per_segment);
+			auto const p = track.get_point(distance);
+			if (frames.empty()) {
+				mesh_builder::sweep_frame frame;
+				frame.position = p.position;
+				frame.tangent = p.tangent;
+				frame.normal = orthonormalize(first.normal, p.tangent);
+				frames.push_back(frame);
+			} else {
+				add_frame(p);
+			}
+		}
+	}
+
+	if (last_normal == nullptr)
+		return;
+
+	// Turn every frame by its share of the angle left between the last
+	// normal and the one requested.
+	auto const& last = frames.back();
+	auto const target = orthonormalize(*last_normal, last.tangent);
+	auto const angle = std::atan2(glm::dot(glm::cross(last.normal, target), last.tangent), glm::dot(last.normal, target));
+	auto length = 0.0f;
+	for (std::size_t i = 1u; i < frames.size(); ++i)
+		length += glm::length(frames[i].position - frames[i - 1u].position);
+	if (length <= 0.0f)
+		return;
+
+	auto distance = 0.0f;
+	for (std::size_t i = 1u; i < frames.size(); ++i) {
+		distance += glm::length(frames[i].position - frames[i - 1u].position);
+		auto const turn = angle * distance / length;
+		auto& frame = frames[i];
+		frame.normal = std::cos(turn) * frame.normal + std::sin(turn) * glm::cross(frame.tangent, frame.normal);
+	}
+}
+
+mesh_builder::cpu_mesh
+swept_tube::build(SplineTrack const& track, parameters const& parameters)
+{
+	if (track.get_segments_nb() == 0u)
+		return mesh_builder::cpu_mesh();
+
+	auto const first_segment = track.get_first_segment();
+	auto const end_segment = first_segment + track.get_segments_nb();
+	auto frames = std::vector<mesh_builder::sweep_frame>();
+	compute_frames(track, first_segment, end_segment, parameters.rows_per_segment,
+	               make_first_frame(track.get_point(track.get_start())), nullptr, frames);
+	return mesh_builder::buildSweptTube(frames, parameters.radius, parameters.circle_split_count);
+}
+
+SweptTube::SweptTube(swept_tube::parameters const& parameters) :
+	_parameters(parameters), _slots(parameters.segments_capacity)
+{
+	assert(_parameters.segments_capacity > 0u && _parameters.rows_per_segment > 0u);
+
+	// As laid out by mesh_builder::buildSweptTube(), a split adding one
+	// cell to the single one of an unsplit circle.
+	auto const columns = _parameters.circle_split_count + 2u;
+	auto const rows = _parameters.rows_per_segment + 1u;
+	auto const slot_index_sets = parametric_surface::build_grid_index_sets(columns, rows);
+	_vertices_per_slot = static_cast<std::size_t>(columns) * rows;
+	_indices_per_slot = 3u * slot_index_sets.size();
+
+	// Slot k of the index buffer draws slot k % segments_capacity of the
+	// vertex buffer.
+	auto indices = std::vector<GLuint>();
+	indices.reserve(2u * _parameters.segments_capacity * _indices_per_slot);
+	for (std::size_t k = 0u; k < 2u * _parameters.segments_capacity; ++k) {
+		auto const base = static_cast<GLuint>((k % _parameters.segments_capacity) * _vertices_per_slot);
+		for (auto const& triangle : slot_index_sets) {
+			indices.push_back(base + triangle.x);
+			indices.push_back(base + triangle.y);
+			indices.push_back(base + triangle.z);
+		}
+	}
+
+	glGenVertexArrays(1, &_mesh.vao);
+	assert(_mesh.vao != 0u);
+	glBindVertexArray(_mesh.vao);
+
+	glGenBuffers(1, &_mesh.bo);
+	assert(_mesh.bo != 0u);
+	glBindBuffer(GL_ARRAY_BUFFER, _mesh.bo);
+	auto const vertex_bytes = _parameters.segments_capacity * _vertices_per_slot * sizeof(vertex_format::packed_vertex);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertex_bytes), nullptr, GL_DYNAMIC_DRAW);
+	mesh_upload::set_packed_attributes();
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+
+	glGenBuffers(1, &_mesh.ibo);
+	assert(_mesh.ibo != 0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _mesh.ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data(), GL_STATIC_DRAW);
+
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+	_mesh.drawing_mode = GL_TRIANGLES;
+	_mesh.vertices_nb = 0u;
+	_mesh.indices_nb = 0u;
+	_format.layout = vertex_format::vertex_layout::interleaved_packed;
+	_format.primitive = index_format::primitive_mode::triangles;
+	_format.index_type = GL_UNSIGNED_INT;
+	_format.vertex_bytes = vertex_bytes;
+	_format.index_bytes = indices.size() * sizeof(GLuint);
+}
+
+SweptTube::~SweptTube()
+{
+	glDeleteBuffers(1, &_mesh.ibo);
+	glDeleteBuffers(1, &_mesh.bo);
+	glDeleteVertexArrays(1, &_mesh.vao);
+}
+
+std::size_t
+SweptTube::update(SplineTrack const& track)
+{
+	auto const first = track.get_first_segment();
+	auto const end = first + std::min(track.get_segments_nb(), _parameters.segments_capacity);
+
+	// Consecutive segments to upload are done together, so that their
+	// frames are computed in one go.
+	_uploaded_bytes = 0u;
+	std::size_t uploaded_nb = 0u;
+	auto segment = first;
+	while (segment < end) {
+		if (is_held(segment)) {
+			++segment;
+			continue;
+		}
+		auto run_end = segment + 1u;
+		while (run_end < end && !is_held(run_end))
+			++run_end;
+		upload_run(track, segment, run_end);
+		uploaded_nb += run_end - segment;
+		segment = run_end;
+	}
+
+	auto const capacity = _parameters.segments_capacity;
+	_format.first_index = (first % capacity) * _indices_per_slot;
+	_mesh.indices_nb = (end - first) * _indices_per_slot;
+	_mesh.vertices_nb = (end - first) * _vertices_per_slot;
+	return uploaded_nb;
+}
+
+void
+SweptTube::invalidate_control_point(std::size_t const index)
+{
+	for (auto segment = index >= 3u ? index - 3u : 0u; segment <= index; ++segment) {
+		auto& s = _slots[segment % _parameters.segments_capacity];
+		if (s.segment == segment)
+			s.is_changed = true;
+	}
+}
+
+bonobo::mesh_data const&
+SweptTube::get_mesh() const
+{
+	return _mesh;
+}
+
+mesh_upload::mesh_format const&
+SweptTube::get_format() const
+{
+	return _format;
+}
+
+std::size_t
+SweptTube::get_uploaded_bytes() const
+{
+	return _uploaded_bytes;
+}
+
+bool
+SweptTube::is_held(std::size_t const segment) const
+{
+	auto const& s = _slots[segment % _parameters.segments_capacity];
+	return s.segment == segment && !s.is_changed;
+}
+
+void
+SweptTube::upload_run(SplineTrack const& track, std::size_t const first, std::size_t const end)
+{
+	auto const capacity = _parameters.segments_capacity;
+	auto const rows = _parameters.rows_per_segment;
+
+	// Continue the frames of the segment before, even if it was dropped
+	// from the track since; a segment only changed starts where it did.
+	auto start = swept_tube::make_first_frame(track.get_point(track.get_segment_start(first)));
+	auto const& first_slot = _slots[first % capacity];
+	auto const& previous_slot = _slots[(first + capacity - 1u) % capacity];
+	if (first > 0u && previous_slot.segment == first - 1u)
+		start = previous_slot.last;
+	else if (first_slot.segment == first)
+		start = first_slot.first;
+
+	auto const& next_slot = _slots[end % capacity];
+	auto const* const last_normal = next_slot.segment == end && !next_slot.is_changed ? &next_slot.first.normal : nullptr;
+	swept_tube::compute_frames(track, first, end, rows, start, last_normal, _frames);
+
+	glBindBuffer(GL_ARRAY_BUFFER, _mesh.bo);
+	for (auto segment = first; segment < end; ++segment) {
+		auto const offset = static_cast<std::ptrdiff_t>((segment - first) * rows);
+		_segment_frames.assign(_frames.begin() + offset, _frames.begin() + offset + rows + 1);
+		auto const vertices = vertex_format::pack_interleaved(mesh_builder::buildSweptTube(_segment_frames, _parameters.radius,
+		                                                                                   _parameters.circle_split_count));
+		assert(vertices.size() == _vertices_per_slot);
+
+		auto const bytes = vertices.size() * sizeof(vertex_format::packed_vertex);
+		glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>((segment % capacity) * bytes),
+		                static_cast<GLsizeiptr>(bytes), vertices.data());
+		_uploaded_bytes += bytes;
+
+		auto& s = _slots[segment % capacity];
+		s.segment = segment;
+		s.is_changed = false;
+		s.first = _segment_frames.front();
+		s.last = _segment_frames.back();
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "mesh_builder.hpp"
+#include "mesh_upload.hpp"
+#include "spline_track.hpp"
+
+#include "core/helpers.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+//! \brief Tubes swept along a SplineTrack, to show the course as a
+//!        tunnel or a guide line.
+namespace swept_tube
+{
+	struct parameters {
+		float        radius{0.1f};
+		unsigned int circle_split_count{8u};
+		//! Rows of vertices each segment of the track is sampled with.
+		unsigned int rows_per_segment{16u};
+		//! Segments a SweptTube holds at most; its buffers are sized for
+		//! that many.
+		std::size_t  segments_capacity{16u};
+	};
+
+	//! \brief Frame at a point of a track, its third axis as close to the
+	//!        world Y-axis as the tangent allows; used where a tube starts.
+	mesh_builder::sweep_frame make_first_frame(spline_track::point const& p);
+
+	//! \brief Rotation-minimising frames along segments
+	//!        [first_segment, end_segment) of a track, computed by double
+	//!        reflection (Wang et al., 2008).
+	//!
+	//! Each segment gets `rows_per_segment` frames evenly spaced along its
+	//! length, and the last one also gets the frame at its end; the frames
+	//! of segment `first_segment + k` therefore start at index
+	//! `k * rows_per_segment`. The first frame takes its normal from
+	//! `first`, which should be the frame the tube already has at that
+	//! point, if any.
+	//!
+	//! If `last_normal` is not null, the frames are turned around the
+	//! track, in proportion to the distance covered, so that the last one
+	//! ends up with that normal; a piece of tube regenerated between two
+	//! existing ones then joins both without a visible twist.
+	void compute_frames(SplineTrack const& track, std::size_t first_segment, std::size_t end_segment,
+	                    unsigned int rows_per_segment, mesh_builder::sweep_frame const& first,
+	                    glm::vec3 const* last_normal, std::vector<mesh_builder::sweep_frame>& frames);
+
+	//! \brief Tube along the whole of a track, in one piece; empty if the
+	//!        track has no segments.
+	mesh_builder::cpu_mesh build(SplineTrack const& track, parameters const& parameters = swept_tube::parameters());
+}
+
+//! \brief Tube along a streamed SplineTrack, kept on the GPU and updated
+//!        one segment at a time.
+//!
+//! The vertex buffer is allocated once, with a slot per segment held:
+//! segment `i` of the track goes into slot `i % segments_capacity`, in
+//! the packed layout. update() only regenerates and uploads, with
+//! glBufferSubData(), the segments appended since the last call and the
+//! ones marked by invalidate_control_point(); dropped segments are
+//! simply no longer drawn. The index buffer, also built once, covers the
+//! slots twice in a row, so that the segments held are always drawn by a
+//! single range of it, whether they wrap around the end of the vertex
+//! buffer or not.
+//!
+//! Frames carry over from one segment to the next, so the tube does not
+//! twist at the joints; segments regenerated in between others get their
+//! twist spread so that they join both sides. The normals point into the
+//! tube, as for buildTorus().
+//!
+//! All functions require a current OpenGL context.
+class SweptTube {
+public:
+	explicit SweptTube(swept_tube::parameters const& parameters = swept_tube::parameters());
+	~SweptTube();
+
+	SweptTube(SweptTube const&) = delete;
+	SweptTube& operator=(SweptTube const&) = delete;
+
+	//! \brief Upload the segments of `track` that are new or changed.
+	//!
+	//! At most segments_capacity segments are held, the first ones of the
+	//! track; the following ones wait for those to be dropped.
+	//!
+	//! @return the number of segments uploaded
+	std::size_t update(SplineTrack const& track);
+
+	//! \brief Mark the segments using control point `index` as changed,
+	//!        after SplineTrack::set_control_point(); they get uploaded by
+	//!        the next update().
+	void invalidate_control_point(std::size_t index);
+
+	//! \brief Mesh and format drawing the segments held, e.g. through
+	//!        RenderItem::set_geometry(); their index range changes with
+	//!        every update().
+	bonobo::mesh_data const& get_mesh() const;
+	mesh_upload::mesh_format const& get_format() const;
+
+	//! \brief Bytes sent to the vertex buffer by the last update().
+	std::size_t get_uploaded_bytes() const;
+
+private:
+	static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+	struct slot {
+		std::size_t               segment{npos};
+		bool                      is_changed{false};
+		mesh_builder::sweep_frame first;
+		mesh_builder::sweep_frame last;
+	};
+
+	bool is_held(std::size_t segment) const;
+	// Regenerate and upload segments [first, end), all in the track.
+	void upload_run(SplineTrack const& track, std::size_t first, std::size_t end);
+
+	swept_tube::parameters                 _parameters;
+	bonobo::mesh_data                      _mesh;
+	mesh_upload::mesh_format               _format;
+	std::size_t                            _vertices_per_slot{0u};
+	std::size_t                            _indices_per_slot{0u};
+	std::vector<slot>                      _slots;
+	std::vector<mesh_builder::sweep_frame> _frames;
+	std::vector<mesh_builder::sweep_frame> _segment_frames;
+	std::size_t                            _uploaded_bytes{0u};
+};
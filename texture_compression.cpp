@@ -0,0 +1,689 @@
+#include "texture_compression.hpp"
+
+#include "core/Log.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#if !defined(GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+#	define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+namespace
+{
+	constexpr std::size_t texel_size = 4u; // RGBA8
+	constexpr std::uint32_t block_side = 4u;
+
+	constexpr std::uint8_t ktx_identifier[12] = {
+		0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+	};
+	constexpr std::uint32_t ktx_endianness = 0x04030201u;
+
+	// Fields of a KTX header following the identifier, in file order.
+	struct ktx_header {
+		std::uint32_t endianness;
+		std::uint32_t gl_type;
+		std::uint32_t gl_type_size;
+		std::uint32_t gl_format;
+		std::uint32_t gl_internal_format;
+		std::uint32_t gl_base_internal_format;
+		std::uint32_t pixel_width;
+		std::uint32_t pixel_height;
+		std::uint32_t pixel_depth;
+		std::uint32_t array_elements_nb;
+		std::uint32_t faces_nb;
+		std::uint32_t mipmap_levels_nb;
+		std::uint32_t key_value_data_size;
+	};
+	static_assert(sizeof(ktx_header) == 13u * sizeof(std::uint32_t), "KTX headers are 13 words");
+
+	// Levels of a complete mipmap chain, floor(log2(max(width, height))) + 1.
+	std::uint32_t get_full_levels_nb(std::uint32_t const width, std::uint32_t const height)
+	{
+		std::uint32_t levels_nb = 0u;
+		for (auto side = std::max(width, height); side > 0u; side >>= 1u)
+			++levels_nb;
+		return levels_nb;
+	}
+
+	using block_texels = std::array<std::array<float, 4>, 16>;
+
+	// Texels of the block at (`block_x`, `block_y`), repeating the last
+	// row and column past the edges of the image.
+	block_texels fetch_block(texture_compression::image const& source,
+	                         std::uint32_t const block_x, std::uint32_t const block_y)
+	{
+		block_texels texels;
+		for (std::uint32_t y = 0u; y < block_side; ++y) {
+			auto const source_y = std::min(block_y * block_side + y, source.height - 1u);
+			for (std::uint32_t x = 0u; x < block_side; ++x) {
+				auto const source_x = std::min(block_x * block_side + x, source.width - 1u);
+				auto const* const texel = source.texels.data() + (static_cast<std::size_t>(source_y) * source.width + source_x) * texel_size;
+				for (std::size_t c = 0u; c < 4u; ++c)
+					texels[y * block_side + x][c] = static_cast<float>(texel[c]);
+			}
+		}
+		return texels;
+	}
+
+	void store_block(texture_compression::image& destination, std::uint32_t const block_x, std::uint32_t const block_y,
+	                 std::array<std::array<std::uint8_t, 4>, 16> const& texels)
+	{
+		for (std::uint32_t y = 0u; y < block_side; ++y) {
+			auto const destination_y = block_y * block_side + y;
+			if (destination_y >= destination.height)
+				break;
+			for (std::uint32_t x = 0u; x < block_side; ++x) {
+				auto const destination_x = block_x * block_side + x;
+				if (destination_x >= destination.width)
+					break;
+				std::memcpy(destination.texels.data() + (static_cast<std::size_t>(destination_y) * destination.width + destination_x) * texel_size,
+				            texels[y * block_side + x].data(), texel_size);
+			}
+		}
+	}
+
+	//
+	// BC1
+	//
+
+	std::uint16_t pack_565(std::array<float, 3> const& colour)
+	{
+		auto const quantise = [](float const value, float const max) {
+			return static_cast<std::uint16_t>(std::min(std::max(value, 0.0f), 255.0f) * max / 255.0f + 0.5f);
+		};
+		return static_cast<std::uint16_t>((quantise(colour[0], 31.0f) << 11) | (quantise(colour[1], 63.0f) << 5) | quantise(colour[2], 31.0f));
+	}
+
+	std::array<int, 3> unpack_565(std::uint16_t const packed)
+	{
+		auto const r = (packed >> 11) & 0x1f;
+		auto const g = (packed >> 5) & 0x3f;
+		auto const b = packed & 0x1f;
+		return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+	}
+
+	std::array<std::array<int, 3>, 4> get_bc1_palette(std::uint16_t const c0, std::uint16_t const c1)
+	{
+		std::array<std::array<int, 3>, 4> palette;
+		palette[0] = unpack_565(c0);
+		palette[1] = unpack_565(c1);
+		for (std::size_t c = 0u; c < 3u; ++c) {
+			if (c0 > c1) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			} else {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		return palette;
+	}
+
+	// Pick the closest palette entry for every texel.
+	std::uint32_t get_bc1_indices(block_texels const& texels, std::array<std::array<int, 3>, 4> const& palette, float* error)
+	{
+		std::uint32_t indices = 0u;
+		float total = 0.0f;
+		for (std::size_t i = 0u; i < texels.size(); ++i) {
+			auto best_distance = std::numeric_limits<float>::max();
+			std::uint32_t best = 0u;
+			for (std::uint32_t p = 0u; p < 4u; ++p) {
+				float distance = 0.0f;
+				for (std::size_t c = 0u; c < 3u; ++c) {
+					auto const difference = texels[i][c] - static_cast<float>(palette[p][c]);
+					distance += difference * difference;
+				}
+				if (distance < best_distance) {
+					best_distance = distance;
+					best = p;
+				}
+			}
+			indices |= best << (2u * i);
+			total += best_distance;
+		}
+		*error = total;
+		return indices;
+	}
+
+	void write_bc1_block(std::uint8_t* const block, std::uint16_t const c0, std::uint16_t const c1, std::uint32_t const indices)
+	{
+		block[0] = static_cast<std::uint8_t>(c0 & 0xffu);
+		block[1] = static_cast<std::uint8_t>(c0 >> 8);
+		block[2] = static_cast<std::uint8_t>(c1 & 0xffu);
+		block[3] = static_cast<std::uint8_t>(c1 >> 8);
+		for (std::size_t i = 0u; i < 4u; ++i)
+			block[4u + i] = static_cast<std::uint8_t>((indices >> (8u * i)) & 0xffu);
+	}
+
+	// Fit the endpoints to the principal axis of the colours, then refine
+	// them once by least squares given the indices picked.
+	void encode_bc1_block(block_texels const& texels, std::uint8_t* const block)
+	{
+		std::array<float, 3> mean = { 0.0f, 0.0f, 0.0f };
+		for (auto const& texel : texels)
+			for (std::size_t c = 0u; c < 3u; ++c)
+				mean[c] += texel[c] / 16.0f;
+
+		float covariance[3][3] = {};
+		for (auto const& texel : texels)
+			for (std::size_t i = 0u; i < 3u; ++i)
+				for (std::size_t j = 0u; j < 3u; ++j)
+					covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+
+		std::array<float, 3> axis = { 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			std::array<float, 3> next = { 0.0f, 0.0f, 0.0f };
+			for (std::size_t i = 0u; i < 3u; ++i)
+				for (std::size_t j = 0u; j < 3u; ++j)
+					next[i] += covariance[i][j] * axis[j];
+			auto const length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+			if (length < 1.0e-6f)
+				break;
+			for (std::size_t c = 0u; c < 3u; ++c)
+				axis[c] = next[c] / length;
+		}
+
+		auto min_projection = std::numeric_limits<float>::max();
+		auto max_projection = std::numeric_limits<float>::lowest();
+		for (auto const& texel : texels) {
+			auto const projection = (texel[0] - mean[0]) * axis[0] + (texel[1] - mean[1]) * axis[1] + (texel[2] - mean[2]) * axis[2];
+			min_projection = std::min(min_projection, projection);
+			max_projection = std::max(max_projection, projection);
+		}
+		std::array<float, 3> end0, end1;
+		for (std::size_t c = 0u; c < 3u; ++c) {
+			end0[c] = mean[c] + axis[c] * max_projection;
+			end1[c] = mean[c] + axis[c] * min_projection;
+		}
+
+		// Endpoints in the order of the four colour mode, c0 > c1, and
+		// the indices and error they give; equal endpoints give a single
+		// colour, which index 0 always maps to.
+		auto const evaluate = [&texels](std::uint16_t c0, std::uint16_t c1, std::uint32_t* indices, float* error) {
+			if (c0 < c1)
+				std::swap(c0, c1);
+			auto palette = get_bc1_palette(c0, c1);
+			if (c0 == c1)
+				palette.fill(palette[0]);
+			*indices = get_bc1_indices(texels, palette, error);
+			return std::make_pair(c0, c1);
+		};
+
+		std::uint32_t indices = 0u;
+		float error = 0.0f;
+		auto endpoints = evaluate(pack_565(end0), pack_565(end1), &indices, &error);
+
+		// Least squares: each texel is a0 * c0 + a1 * c1 for the weights of
+		// its index.
+		if (endpoints.first != endpoints.second) {
+			static float const weights0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+			float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+			std::array<float, 3> ax = { 0.0f, 0.0f, 0.0f }, bx = { 0.0f, 0.0f, 0.0f };
+			for (std::size_t i = 0u; i < texels.size(); ++i) {
+				auto const a = weights0[(indices >> (2u * i)) & 3u];
+				auto const b = 1.0f - a;
+				aa += a * a;
+				ab += a * b;
+				bb += b * b;
+				for (std::size_t c = 0u; c < 3u; ++c) {
+					ax[c] += a * texels[i][c];
+					bx[c] += b * texels[i][c];
+				}
+			}
+			auto const determinant = aa * bb - ab * ab;
+			if (std::abs(determinant) > 1.0e-6f) {
+				std::array<float, 3> fitted0, fitted1;
+				for (std::size_t c = 0u; c < 3u; ++c) {
+					fitted0[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+					fitted1[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+				}
+				std::uint32_t fitted_indices = 0u;
+				float fitted_error = 0.0f;
+				auto const fitted = evaluate(pack_565(fitted0), pack_565(fitted1), &fitted_indices, &fitted_error);
+				if (fitted_error < error) {
+					endpoints = fitted;
+					indices = fitted_indices;
+				}
+			}
+		}
+
+		write_bc1_block(block, endpoints.first, endpoints.second, indices);
+	}
+
+	void decode_bc1_block(std::uint8_t const* const block, std::array<std::array<std::uint8_t, 4>, 16>& texels)
+	{
+		auto const c0 = static_cast<std::uint16_t>(block[0] | (block[1] << 8));
+		auto const c1 = static_cast<std::uint16_t>(block[2] | (block[3] << 8));
+		auto const indices = static_cast<std::uint32_t>(block[4]) | (static_cast<std::uint32_t>(block[5]) << 8)
+		                   | (static_cast<std::uint32_t>(block[6]) << 16) | (static_cast<std::uint32_t>(block[7]) << 24);
+		auto const palette = get_bc1_palette(c0, c1);
+		for (std::size_t i = 0u; i < texels.size(); ++i) {
+			auto const& colour = palette[(indices >> (2u * i)) & 3u];
+			texels[i] = { static_cast<std::uint8_t>(colour[0]), static_cast<std::uint8_t>(colour[1]),
+			              static_cast<std::uint8_t>(colour[2]), 255u };
+		}
+	}
+
+	//
+	// BC4, and BC5 as two of them
+	//
+
+	// Value of every index for the endpoints, in the eight value mode
+	// when e0 > e1 and the six value one otherwise.
+	std::array<int, 8> get_bc4_palette(int const e0, int const e1)
+	{
+		std::array<int, 8> palette = { e0, e1, 0, 0, 0, 0, 0, 0 };
+		if (e0 > e1) {
+			for (int i = 2; i < 8; ++i)
+				palette[i] = ((8 - i) * e0 + (i - 1) * e1 + 3) / 7;
+		} else {
+			for (int i = 2; i < 6; ++i)
+				palette[i] = ((6 - i) * e0 + (i - 1) * e1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		return palette;
+	}
+
+	void encode_bc4_block(block_texels const& texels, std::size_t const channel, std::uint8_t* const block)
+	{
+		auto low = 255.0f;
+		auto high = 0.0f;
+		for (auto const& texel : texels) {
+			low = std::min(low, texel[channel]);
+			high = std::max(high, texel[channel]);
+		}
+		auto const e0 = static_cast<int>(high + 0.5f);
+		auto const e1 = static_cast<int>(low + 0.5f);
+		auto const palette = get_bc4_palette(e0, e1);
+
+		std::uint64_t indices = 0u;
+		if (e0 != e1) {
+			for (std::size_t i = 0u; i < texels.size(); ++i) {
+				auto best_distance = std::numeric_limits<float>::max();
+				std::uint64_t best = 0u;
+				for (std::uint64_t p = 0u; p < 8u; ++p) {
+					auto const distance = std::abs(texels[i][channel] - static_cast<float>(palette[p]));
+					if (distance < best_distance) {
+						best_distance = distance;
+						best = p;
+					}
+				}
+				indices |= best << (3u * i);
+			}
+		}
+
+		block[0] = static_cast<std::uint8_t>(e0);
+		block[1] = static_cast<std::uint8_t>(e1);
+		for (std::size_t i = 0u; i < 6u; ++i)
+			block[2u + i] = static_cast<std::uint8_t>((indices >> (8u * i)) & 0xffu);
+	}
+
+	void decode_bc4_block(std::uint8_t const* const block, std::size_t const channel,
+	                      std::array<std::array<std::uint8_t, 4>, 16>& texels)
+	{
+		auto const palette = get_bc4_palette(block[0], block[1]);
+		std::uint64_t indices = 0u;
+		for (std::size_t i = 0u; i < 6u; ++i)
+			indices |= static_cast<std::uint64_t>(block[2u + i]) << (8u * i);
+		for (std::size_t i = 0u; i < texels.size(); ++i)
+			texels[i][channel] = static_cast<std::uint8_t>(palette[(indices >> (3u * i)) & 7u]);
+	}
+
+	std::size_t get_block_size(texture_compression::format const block_format)
+	{
+		return block_format == texture_compression::format::bc5 ? 16u : 8u;
+	}
+
+	char const* get_format_name(texture_compression::format const block_format)
+	{
+		switch (block_format) {
+		case texture_compression::format::bc1: return "BC1";
+		case texture_compression::format::bc4: return "BC4";
+		case texture_compression::format::bc5: return "BC5";
+		}
+		return "?";
+	}
+
+	std::size_t get_mipmaps_size(std::vector<std::vector<std::uint8_t>> const& levels)
+	{
+		std::size_t size = 0u;
+		for (auto const& level : levels)
+			size += level.size();
+		return size;
+	}
+}
+
+GLenum
+texture_compression::get_internal_format(format const block_format)
+{
+	switch (block_format) {
+	case format::bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case format::bc4: return GL_COMPRESSED_RED_RGTC1;
+	case format::bc5: return GL_COMPRESSED_RG_RGTC2;
+	}
+	return GL_NONE;
+}
+
+unsigned int
+texture_compression::get_channels_nb(format const block_format)
+{
+	switch (block_format) {
+	case format::bc1: return 3u;
+	case format::bc4: return 1u;
+	case format::bc5: return 2u;
+	}
+	return 0u;
+}
+
+std::size_t
+texture_compression::get_compressed_size(format const block_format, std::uint32_t const width, std::uint32_t const height)
+{
+	auto const blocks_x = (width + block_side - 1u) / block_side;
+	auto const blocks_y = (height + block_side - 1u) / block_side;
+	return static_cast<std::size_t>(blocks_x) * blocks_y * get_block_size(block_format);
+}
+
+bool
+texture_compression::load_image(std::string const& path, bool const flip, image& decoded)
+{
+	int width = 0, height = 0, channels_nb = 0;
+	auto* const data = stbi_load(path.c_str(), &width, &height, &channels_nb, static_cast<int>(texel_size));
+	if (data == nullptr) {
+		LogError("Failed to load \"%s\": %s", path.c_str(), stbi_failure_reason());
+		return false;
+	}
+
+	decoded.width = static_cast<std::uint32_t>(width);
+	decoded.height = static_cast<std::uint32_t>(height);
+	auto const row_size = static_cast<std::size_t>(decoded.width) * texel_size;
+	decoded.texels.resize(row_size * decoded.height);
+	for (std::uint32_t y = 0u; y < decoded.height; ++y) {
+		auto const source_y = flip ? decoded.height - 1u - y : y;
+		std::memcpy(decoded.texels.data() + y * row_size, data + source_y * row_size, row_size);
+	}
+	stbi_image_free(data);
+	return true;
+}
+
+std::vector<texture_compression::image>
+texture_compression::make_mipmaps(image const& source)
+{
+	auto levels = std::vector<image>{ source };
+	while (levels.back().width > 1u || levels.back().height > 1u) {
+		auto const& previous = levels.back();
+		image next;
+		next.width = std::max(previous.width / 2u, 1u);
+		next.height = std::max(previous.height / 2u, 1u);
+		next.texels.resize(static_cast<std::size_t>(next.width) * next.height * texel_size);
+		for (std::uint32_t y = 0u; y < next.height; ++y) {
+			auto const y0 = std::min(2u * y, previous.height - 1u);
+			auto const y1 = std::min(2u * y + 1u, previous.height - 1u);
+			for (std::uint32_t x = 0u; x < next.width; ++x) {
+				auto const x0 = std::min(2u * x, previous.width - 1u);
+				auto const x1 = std::min(2u * x + 1u, previous.width - 1u);
+				auto const at = [&previous](std::uint32_t const sx, std::uint32_t const sy) {
+					return previous.texels.data() + (static_cast<std::size_t>(sy) * previous.width + sx) * texel_size;
+				};
+				auto* const texel = next.texels.data() + (static_cast<std::size_t>(y) * next.width + x) * texel_size;
+				for (std::size_t c = 0u; c < texel_size; ++c)
+					texel[c] = static_cast<std::uint8_t>((at(x0, y0)[c] + at(x1, y0)[c] + at(x0, y1)[c] + at(x1, y1)[c] + 2u) / 4u);
+			}
+		}
+		levels.push_back(std::move(next));
+	}
+	return levels;
+}
+
+std::vector<std::uint8_t>
+texture_compression::encode(image const& source, format const block_format)
+{
+	auto blocks = std::vector<std::uint8_t>(get_compressed_size(block_format, source.width, source.height));
+	auto const blocks_x = (source.width + block_side - 1u) / block_side;
+	auto const blocks_y = (source.height + block_side - 1u) / block_side;
+	auto const block_size = get_block_size(block_format);
+	for (std::uint32_t by = 0u; by < blocks_y; ++by) {
+		for (std::uint32_t bx = 0u; bx < blocks_x; ++bx) {
+			auto* const block = blocks.data() + (static_cast<std::size_t>(by) * blocks_x + bx) * block_size;
+			auto const texels = fetch_block(source, bx, by);
+			switch (block_format) {
+			case format::bc1:
+				encode_bc1_block(texels, block);
+				break;
+			case format::bc4:
+				encode_bc4_block(texels, 0u, block);
+				break;
+			case format::bc5:
+				encode_bc4_block(texels, 0u, block);
+				encode_bc4_block(texels, 1u, block + 8u);
+				break;
+			}
+		}
+	}
+	return blocks;
+}
+
+texture_compression::image
+texture_compression::decode(std::vector<std::uint8_t> const& blocks, format const block_format,
+                            std::uint32_t const width, std::uint32_t const height)
+{
+	image decoded;
+	decoded.width = width;
+	decoded.height = height;
+	decoded.texels.resize(static_cast<std::size_t>(width) * height * texel_size);
+	if (blocks.size() < get_compressed_size(block_format, width, height))
+		return decoded;
+
+	auto const blocks_x = (width + block_side - 1u) / block_side;
+	auto const blocks_y = (height + block_side - 1u) / block_side;
+	auto const block_size = get_block_size(block_format);
+	for (std::uint32_t by = 0u; by < blocks_y; ++by) {
+		for (std::uint32_t bx = 0u; bx < blocks_x; ++bx) {
+			auto const* const block = blocks.data() + (static_cast<std::size_t>(by) * blocks_x + bx) * block_size;
+			std::array<std::array<std::uint8_t, 4>, 16> texels;
+			texels.fill({ 0u, 0u, 0u, 255u });
+			switch (block_format) {
+			case format::bc1:
+				decode_bc1_block(block, texels);
+				break;
+			case format::bc4:
+				decode_bc4_block(block, 0u, texels);
+				break;
+			case format::bc5:
+				decode_bc4_block(block, 0u, texels);
+				decode_bc4_block(block + 8u, 1u, texels);
+				break;
+			}
+			store_block(decoded, bx, by, texels);
+		}
+	}
+	return decoded;
+}
+
+texture_compression::compressed_image
+texture_compression::compress(image const& source, format const block_format, bool const with_mipmaps)
+{
+	compressed_image compressed;
+	compressed.block_format = block_format;
+	compressed.width = source.width;
+	compressed.height = source.height;
+	if (with_mipmaps) {
+		for (auto const& level : make_mipmaps(source))
+			compressed.levels.push_back(encode(level, block_format));
+	} else {
+		compressed.levels.push_back(encode(source, block_format));
+	}
+	return compressed;
+}
+
+double
+texture_compression::get_psnr(image const& reference, image const& compared, unsigned int const channels_nb)
+{
+	if (reference.width != compared.width || reference.height != compared.height || channels_nb == 0u)
+		return 0.0;
+
+	double squared_error = 0.0;
+	auto const texels_nb = static_cast<std::size_t>(reference.width) * reference.height;
+	for (std::size_t i = 0u; i < texels_nb; ++i) {
+		for (std::size_t c = 0u; c < channels_nb; ++c) {
+			auto const difference = static_cast<double>(reference.texels[i * texel_size + c]) - compared.texels[i * texel_size + c];
+			squared_error += difference * difference;
+		}
+	}
+	if (squared_error == 0.0)
+		return std::numeric_limits<double>::infinity();
+	auto const mean_squared_error = squared_error / static_cast<double>(texels_nb * channels_nb);
+	return 10.0 * std::log10(255.0 * 255.0 / mean_squared_error);
+}
+
+bool
+texture_compression::write_ktx(compressed_image const& compressed, std::string const& path)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		LogError("Failed to open \"%s\" to write a compressed texture.", path.c_str());
+		return false;
+	}
+
+	ktx_header header = {};
+	header.endianness = ktx_endianness;
+	header.gl_type_size = 1u;
+	header.gl_internal_format = get_internal_format(compressed.block_format);
+	header.gl_base_internal_format = compressed.block_format == format::bc1 ? GL_RGB
+	                               : compressed.block_format == format::bc4 ? GL_RED : GL_RG;
+	header.pixel_width = compressed.width;
+	header.pixel_height = compressed.height;
+	header.faces_nb = 1u;
+	header.mipmap_levels_nb = static_cast<std::uint32_t>(compressed.levels.size());
+
+	file.write(reinterpret_cast<char const*>(ktx_identifier), sizeof(ktx_identifier));
+	file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	// Block sizes are multiples of 4 bytes, so levels need no padding.
+	for (auto const& level : compressed.levels) {
+		auto const size = static_cast<std::uint32_t>(level.size());
+		file.write(reinterpret_cast<char const*>(&size), sizeof(size));
+		file.write(reinterpret_cast<char const*>(level.data()), static_cast<std::streamsize>(level.size()));
+	}
+	return static_cast<bool>(file);
+}
+
+bool
+texture_compression::read_ktx(std::string const& path, compressed_image& compressed)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		LogError("Failed to open the compressed texture \"%s\".", path.c_str());
+		return false;
+	}
+
+	std::uint8_t identifier[sizeof(ktx_identifier)];
+	ktx_header header = {};
+	file.read(reinterpret_cast<char*>(identifier), sizeof(identifier));
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || std::memcmp(identifier, ktx_identifier, sizeof(ktx_identifier)) != 0 || header.endianness != ktx_endianness) {
+		LogError("\"%s\" is not a little-endian KTX file.", path.c_str());
+		return false;
+	}
+
+	auto block_format = format::bc1;
+	switch (header.gl_internal_format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: block_format = format::bc1; break;
+	case GL_COMPRESSED_RED_RGTC1:         block_format = format::bc4; break;
+	case GL_COMPRESSED_RG_RGTC2:          block_format = format::bc5; break;
+	default:
+		LogError("\"%s\" uses an unsupported internal format, 0x%04x.", path.c_str(), header.gl_internal_format);
+		return false;
+	}
+	if (header.pixel_width == 0u || header.pixel_height == 0u || header.pixel_depth != 0u
+	 || header.array_elements_nb != 0u || header.faces_nb != 1u || header.mipmap_levels_nb == 0u) {
+		LogError("\"%s\" does not hold a single 2D texture.", path.c_str());
+		return false;
+	}
+	// Files found next to the images may come from anywhere: nothing
+	// gets allocated from the header before it is known to be sane.
+	if (header.mipmap_levels_nb > get_full_levels_nb(header.pixel_width, header.pixel_height)) {
+		LogError("\"%s\" claims %u mipmap levels, more than a %ux%u texture has.", path.c_str(),
+		         header.mipmap_levels_nb, header.pixel_width, header.pixel_height);
+		return false;
+	}
+	auto const data_start = file.tellg();
+	file.seekg(0, std::ios::end);
+	auto const data_size = static_cast<std::uint64_t>(file.tellg() - data_start);
+	if (header.key_value_data_size > data_size) {
+		LogError("The key-value data of \"%s\" runs past the end of the file.", path.c_str());
+		return false;
+	}
+	file.seekg(data_start + static_cast<std::streamoff>(header.key_value_data_size));
+
+	compressed.block_format = block_format;
+	compressed.width = header.pixel_width;
+	compressed.height = header.pixel_height;
+	compressed.levels.resize(header.mipmap_levels_nb);
+	for (std::uint32_t level = 0u; level < header.mipmap_levels_nb; ++level) {
+		auto const width = std::max(header.pixel_width >> level, 1u);
+		auto const height = std::max(header.pixel_height >> level, 1u);
+		std::uint32_t size = 0u;
+		file.read(reinterpret_cast<char*>(&size), sizeof(size));
+		if (!file || size != get_compressed_size(block_format, width, height)) {
+			LogError("Level %u of \"%s\" is truncated or of the wrong size.", level, path.c_str());
+			return false;
+		}
+		compressed.levels[level].resize(size);
+		file.read(reinterpret_cast<char*>(compressed.levels[level].data()), size);
+		if (!file) {
+			LogError("Level %u of \"%s\" is truncated or of the wrong size.", level, path.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+bool
+texture_compression::is_ktx(std::string const& path)
+{
+	auto const extension = std::string(".ktx");
+	return path.size() >= extension.size()
+	    && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+std::string
+texture_compression::find_compressed(std::string const& path)
+{
+	auto const dot = path.find_last_of('.');
+	auto const compressed = (dot == std::string::npos ? path : path.substr(0u, dot)) + ".ktx";
+	return std::ifstream(compressed).good() ? compressed : path;
+}
+
+bool
+texture_compression::convert(std::string const& source, std::string const& destination, format const block_format, bool const flip)
+{
+	auto const start = std::chrono::high_resolution_clock::now();
+
+	image decoded;
+	if (!load_image(source, flip, decoded))
+		return false;
+	auto const compressed = compress(decoded, block_format);
+	if (!write_ktx(compressed, destination))
+		return false;
+
+	auto const elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start);
+	auto const psnr = get_psnr(decoded, decode(compressed.levels.front(), block_format, decoded.width, decoded.height),
+	                           get_channels_nb(block_format));
+	// Uncompressed, the mipmap chain adds a third to the size.
+	auto const uncompressed_size = static_cast<double>(decoded.texels.size()) * 4.0 / 3.0;
+	auto const compressed_size = static_cast<double>(get_mipmaps_size(compressed.levels));
+	std::printf("  %s: %ux%u, %zu levels, %s, %.2f MiB instead of %.2f MiB (%.1fx), %.2f dB, %.0f ms\n",
+	            destination.c_str(), decoded.width, decoded.height, compressed.levels.size(), get_format_name(block_format),
+	            compressed_size / (1024.0 * 1024.0), uncompressed_size / (1024.0 * 1024.0),
+	            uncompressed_size / compressed_size, psnr, elapsed.count());
+	return true;
+}
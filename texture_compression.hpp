@@ -0,0 +1,117 @@
+#pragma once
+
+#include "core/helpers.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! \brief Block compression of textures, and the KTX files storing them
+//!        with their whole mipmap chain.
+//!
+//! Images are converted offline, see convert(), so that loading them is
+//! reading the blocks and handing them to glCompressedTexImage2D(). The
+//! decoders are only there to check the encoders on the CPU.
+//!
+//! Supported formats:
+//! * BC1 (DXT1), RGB in 4 bits per texel; for colour maps;
+//! * BC4 (RGTC1), one channel in 4 bits per texel; shaders only get red;
+//! * BC5 (RGTC2), two channels in 8 bits per texel; for normal maps whose
+//!   shader rebuilds z from x and y.
+namespace texture_compression
+{
+	enum class format : std::uint8_t {
+		bc1,
+		bc4,
+		bc5
+	};
+
+	//! \brief An RGBA8 image, rows stored bottom first when it is meant
+	//!        for OpenGL.
+	struct image {
+		std::vector<std::uint8_t> texels;
+		std::uint32_t             width{0u};
+		std::uint32_t             height{0u};
+	};
+
+	//! \brief A compressed image and its mipmap levels, the first one
+	//!        being the full-size image.
+	struct compressed_image {
+		format                                 block_format{format::bc1};
+		std::uint32_t                          width{0u};
+		std::uint32_t                          height{0u};
+		std::vector<std::vector<std::uint8_t>> levels;
+	};
+
+	//! \brief Sized internal format to give to glCompressedTexImage2D().
+	GLenum get_internal_format(format block_format);
+
+	//! \brief Number of channels of the texels a format stores.
+	unsigned int get_channels_nb(format block_format);
+
+	//! \brief Size in bytes of the blocks covering a `width` x `height`
+	//!        image.
+	std::size_t get_compressed_size(format block_format, std::uint32_t width, std::uint32_t height);
+
+	//! \brief Decode an image file as RGBA8.
+	//!
+	//! @param [in] path the image to decode, in any format stb_image reads
+	//! @param [in] flip whether to store the bottom row first, as OpenGL
+	//!             expects for 2D textures
+	//! @param [out] decoded the image
+	//! @return whether the file could be decoded
+	bool load_image(std::string const& path, bool flip, image& decoded);
+
+	//! \brief Halve the image until it is 1x1, averaging 2x2 texels.
+	//!
+	//! @return every level, the first one being `source` itself
+	std::vector<image> make_mipmaps(image const& source);
+
+	//! \brief Compress an image, whose width and height need not be
+	//!        multiples of 4.
+	std::vector<std::uint8_t> encode(image const& source, format block_format);
+
+	//! \brief Decompress blocks back to RGBA8; the channels the format
+	//!        does not store are set like OpenGL does, to 0 for colours and
+	//!        255 for alpha.
+	image decode(std::vector<std::uint8_t> const& blocks, format block_format,
+	             std::uint32_t width, std::uint32_t height);
+
+	//! \brief Compress an image and, if asked, all its mipmap levels.
+	compressed_image compress(image const& source, format block_format, bool with_mipmaps = true);
+
+	//! \brief Peak signal-to-noise ratio between two images of the same
+	//!        size, over their first `channels_nb` channels.
+	//!
+	//! @return the ratio in decibels, infinite for identical images
+	double get_psnr(image const& reference, image const& compared, unsigned int channels_nb);
+
+	//! \brief Write a KTX 1.1 file holding one 2D texture and its levels.
+	//!
+	//! @return whether the file could be written
+	bool write_ktx(compressed_image const& compressed, std::string const& path);
+
+	//! \brief Read a KTX file written by write_ktx().
+	//!
+	//! @return whether the file could be read and holds a 2D texture in
+	//!         one of the supported formats, with consistent level sizes
+	bool read_ktx(std::string const& path, compressed_image& compressed);
+
+	//! \brief Whether `path` names a KTX file, going by its extension.
+	bool is_ktx(std::string const& path);
+
+	//! \brief The KTX file converted from `path`, if it exists, or `path`
+	//!        otherwise.
+	std::string find_compressed(std::string const& path);
+
+	//! \brief Convert an image file to a KTX file with all its mipmap
+	//!        levels, and report the compression ratio and the error of
+	//!        the full-size level on the standard output.
+	//!
+	//! @param [in] source the image to convert
+	//! @param [in] flip whether to store the bottom row first, as done for
+	//!             2D textures but not cube map faces
+	//! @return whether the file could be converted
+	bool convert(std::string const& source, std::string const& destination, format block_format, bool flip);
+}
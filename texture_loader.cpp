@@ -0,0 +1,243 @@
+#include "texture_loader.hpp"
+
+#include "thread_pool.hpp"
+
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	std::uint8_t to_unorm8(float const value)
+	{
+		return static_cast<std::uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	GLenum get_face_target(GLenum const target, std::size_t const face)
+	{
+		return target == GL_TEXTURE_CUBE_MAP ? static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face) : target;
+	}
+}
+
+TextureLoader::TextureLoader(ThreadPool* const pool, bool const use_pixel_buffers) :
+	_pool(pool), _use_pixel_buffers(use_pixel_buffers)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+	// The decodes reference the requests and the mutex.
+	for (auto& decode : _decodes)
+		decode.wait();
+
+	if (_pixel_buffer != 0u)
+		glDeleteBuffers(1, &_pixel_buffer);
+}
+
+GLuint
+TextureLoader::load_2d(std::string const& path, glm::vec4 const& placeholder, bool const generate_mipmap)
+{
+	return create_request(GL_TEXTURE_2D, { path }, placeholder, generate_mipmap);
+}
+
+GLuint
+TextureLoader::load_cube_map(std::string const& posx, std::string const& negx,
+                             std::string const& posy, std::string const& negy,
+                             std::string const& posz, std::string const& negz,
+                             glm::vec4 const& placeholder, bool const generate_mipmap)
+{
+	return create_request(GL_TEXTURE_CUBE_MAP, { posx, negx, posy, negy, posz, negz }, placeholder, generate_mipmap);
+}
+
+std::size_t
+TextureLoader::update(std::size_t const max_uploads_nb)
+{
+	auto ready = std::vector<request*>();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto const count = std::min(max_uploads_nb, _ready.size());
+		ready.assign(_ready.begin(), _ready.begin() + count);
+		_ready.erase(_ready.begin(), _ready.begin() + count);
+	}
+
+	for (auto* r : ready) {
+		upload(*r);
+		_requests.erase(std::find_if(_requests.begin(), _requests.end(),
+		                             [r](std::unique_ptr<request> const& p){ return p.get() == r; }));
+	}
+
+	_decodes.erase(std::remove_if(_decodes.begin(), _decodes.end(), [](std::future<void> const& decode) {
+		return decode.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}), _decodes.end());
+
+	return ready.size();
+}
+
+bool
+TextureLoader::is_done() const
+{
+	return _requests.empty();
+}
+
+std::size_t
+TextureLoader::get_pending_nb() const
+{
+	return _requests.size();
+}
+
+GLuint
+TextureLoader::create_request(GLenum const target, std::vector<std::string> paths,
+                              glm::vec4 const& placeholder, bool const generate_mipmap)
+{
+	auto r = std::make_unique<request>();
+	r->target = target;
+	r->generate_mipmap = generate_mipmap;
+	r->faces.resize(paths.size());
+	r->compressed_faces.resize(paths.size());
+	r->faces_left = paths.size();
+	r->paths = std::move(paths);
+	r->requested = std::chrono::high_resolution_clock::now();
+
+	glGenTextures(1, &r->texture);
+	glBindTexture(target, r->texture);
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, generate_mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	if (target == GL_TEXTURE_CUBE_MAP) {
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	}
+	// A single level is a complete mipmap chain, whatever the filter.
+	std::uint8_t const texel[] = { to_unorm8(placeholder.x), to_unorm8(placeholder.y),
+	                               to_unorm8(placeholder.z), to_unorm8(placeholder.w) };
+	for (std::size_t face = 0u; face < r->faces.size(); ++face)
+		glTexImage2D(get_face_target(target, face), 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+	glBindTexture(target, 0u);
+
+	auto const texture = r->texture;
+	if (_pool == nullptr) {
+		for (std::size_t face = 0u; face < r->faces.size(); ++face)
+			r->failed = !decode(*r, face) || r->failed;
+		upload(*r);
+		return texture;
+	}
+
+	auto* const pending = r.get();
+	_requests.push_back(std::move(r));
+	for (std::size_t face = 0u; face < pending->faces.size(); ++face)
+		_decodes.push_back(_pool->submit([this, pending, face](){
+			auto const is_decoded = decode(*pending, face);
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			pending->failed = !is_decoded || pending->failed;
+			if (--pending->faces_left == 0u)
+				_ready.push_back(pending);
+		}));
+
+	return texture;
+}
+
+bool
+TextureLoader::decode(request& r, std::size_t const face)
+{
+	auto const& path = r.paths[face];
+	if (texture_compression::is_ktx(path))
+		return texture_compression::read_ktx(path, r.compressed_faces[face]);
+	return texture_compression::load_image(path, r.target == GL_TEXTURE_2D, r.faces[face]);
+}
+
+void const*
+TextureLoader::stage(void const* const data, std::size_t const size)
+{
+	if (!_use_pixel_buffers)
+		return data;
+
+	if (_pixel_buffer == 0u)
+		glGenBuffers(1, &_pixel_buffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixel_buffer);
+	// Orphan the previous storage, which the driver may still be copying
+	// from, rather than waiting for it.
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+	auto* const mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+	                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped == nullptr) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
+		return data;
+	}
+	std::memcpy(mapped, data, size);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	return nullptr; // offset 0 in the pixel buffer
+}
+
+void
+TextureLoader::upload(request& r)
+{
+	auto const elapsed = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - r.requested);
+	auto const is_compressed = !r.compressed_faces.front().levels.empty();
+	for (auto const& compressed : r.compressed_faces) {
+		if (!r.failed && compressed.levels.empty() == is_compressed) {
+			LogError("The faces of \"%s\" mix compressed and uncompressed images", r.paths.front().c_str());
+			r.failed = true;
+		}
+	}
+	// A cube map is only complete if its faces share their size, format
+	// and levels; the levels set below come from the first face.
+	if (is_compressed && !r.failed) {
+		auto const& first = r.compressed_faces.front();
+		for (auto const& compressed : r.compressed_faces) {
+			if (compressed.width != first.width || compressed.height != first.height
+			 || compressed.block_format != first.block_format || compressed.levels.size() != first.levels.size()) {
+				LogError("The compressed faces of \"%s\" differ in size, format or levels", r.paths.front().c_str());
+				r.failed = true;
+				break;
+			}
+		}
+	}
+	if (r.failed) {
+		LogWarning("Keeping the placeholder of \"%s\"", r.paths.front().c_str());
+		return;
+	}
+
+	glBindTexture(r.target, r.texture);
+	if (is_compressed) {
+		// The levels come from the file, down to 1x1 unless it was
+		// converted without them.
+		auto const levels_nb = r.compressed_faces.front().levels.size();
+		glTexParameteri(r.target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels_nb - 1u));
+		if (levels_nb == 1u)
+			glTexParameteri(r.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		for (std::size_t face = 0u; face < r.compressed_faces.size(); ++face) {
+			auto& compressed = r.compressed_faces[face];
+			auto const internal_format = texture_compression::get_internal_format(compressed.block_format);
+			for (std::size_t level = 0u; level < compressed.levels.size(); ++level) {
+				auto const& blocks = compressed.levels[level];
+				auto const width = std::max(compressed.width >> level, 1u);
+				auto const height = std::max(compressed.height >> level, 1u);
+				glCompressedTexImage2D(get_face_target(r.target, face), static_cast<GLint>(level), internal_format,
+				                       static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0,
+				                       static_cast<GLsizei>(blocks.size()), stage(blocks.data(), blocks.size()));
+			}
+			compressed.levels = std::vector<std::vector<std::uint8_t>>();
+		}
+	} else {
+		for (std::size_t face = 0u; face < r.faces.size(); ++face) {
+			auto& img = r.faces[face];
+			glTexImage2D(get_face_target(r.target, face), 0, GL_RGBA,
+			             static_cast<GLsizei>(img.width), static_cast<GLsizei>(img.height), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+			             stage(img.texels.data(), img.texels.size()));
+			img.texels = std::vector<std::uint8_t>();
+		}
+		if (r.generate_mipmap)
+			glGenerateMipmap(r.target);
+	}
+
+	if (_use_pixel_buffers)
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0u);
+	glBindTexture(r.target, 0u);
+
+	LogInfo("Loaded \"%s\"%s %.3f ms after the request",
+	        r.paths.front().c_str(), r.target == GL_TEXTURE_CUBE_MAP ? " and the other cube map faces" : "",
+	        elapsed.count());
+}
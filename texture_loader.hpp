@@ -0,0 +1,119 @@
+#pragma once
+
+#include "texture_compression.hpp"
+
+#include "core/helpers.hpp"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+//! \brief Loads 2D textures and cube maps from image files, decoding them
+//!        on a ThreadPool.
+//!
+//! The load functions create the texture right away, filled with a single
+//! texel of a placeholder colour, and return its name; the images are then
+//! decoded in parallel on the pool, and update() uploads the finished ones
+//! into that same texture, on the thread owning the OpenGL context. Since
+//! the name never changes, whatever the texture got bound to shows the
+//! placeholder until the upload, and the actual image afterwards.
+//!
+//! Without a pool, everything is done synchronously by the load functions,
+//! as bonobo::loadTexture2D() and bonobo::loadTextureCubeMap() would.
+//!
+//! Images are uploaded as RGBA8, 2D textures flipped vertically and cube
+//! map faces as they are, like the bonobo loaders do. KTX files written
+//! by texture_compression::convert() are uploaded as they are, blocks
+//! and mipmap levels included; a cube map takes one such file per face.
+class TextureLoader {
+public:
+	//! @param [in] pool the pool decoding the images, or nullptr to load
+	//!             them synchronously; it must outlive the loader
+	//! @param [in] use_pixel_buffers whether uploads go through a pixel
+	//!             buffer object, letting the driver copy the texels to the
+	//!             texture asynchronously
+	explicit TextureLoader(ThreadPool* pool = nullptr, bool use_pixel_buffers = true);
+
+	//! \brief Wait for the decodes still running; textures not uploaded
+	//!        yet keep their placeholder.
+	~TextureLoader();
+
+	TextureLoader(TextureLoader const&) = delete;
+	TextureLoader& operator=(TextureLoader const&) = delete;
+
+	//! \brief Start loading a 2D texture.
+	//!
+	//! @param [in] path the image to load
+	//! @param [in] placeholder the colour of the texture until it is loaded
+	//! @param [in] generate_mipmap whether to generate the mipmap chain
+	//!             once loaded
+	//! @return the name of the texture
+	GLuint load_2d(std::string const& path, glm::vec4 const& placeholder = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f),
+	               bool generate_mipmap = true);
+
+	//! \brief Start loading a cube map, its six faces being decoded in
+	//!        parallel.
+	//!
+	//! @return the name of the texture
+	GLuint load_cube_map(std::string const& posx, std::string const& negx,
+	                     std::string const& posy, std::string const& negy,
+	                     std::string const& posz, std::string const& negz,
+	                     glm::vec4 const& placeholder = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f),
+	                     bool generate_mipmap = true);
+
+	//! \brief Upload textures whose images are decoded; must be called on
+	//!        the thread owning the OpenGL context, e.g. once per frame.
+	//!
+	//! @param [in] max_uploads_nb how many textures to upload at most, to
+	//!             spread the uploads over several frames
+	//! @return the number of textures uploaded
+	std::size_t update(std::size_t max_uploads_nb = 1u);
+
+	//! \brief Whether every texture requested so far is uploaded, or failed
+	//!        to load.
+	bool is_done() const;
+
+	//! \brief Number of textures requested and not uploaded yet.
+	std::size_t get_pending_nb() const;
+
+private:
+	struct request {
+		GLuint                                         texture{0u};
+		GLenum                                         target{GL_TEXTURE_2D};
+		bool                                           generate_mipmap{true};
+		std::vector<std::string>                       paths;
+		std::vector<texture_compression::image>        faces;
+		std::vector<texture_compression::compressed_image> compressed_faces;
+		std::size_t                                    faces_left{0u}; //!< guarded by _mutex
+		bool                                           failed{false};  //!< guarded by _mutex
+		std::chrono::high_resolution_clock::time_point requested;
+	};
+
+	GLuint create_request(GLenum target, std::vector<std::string> paths,
+	                      glm::vec4 const& placeholder, bool generate_mipmap);
+	//! \brief Decode one image of `r`; safe to run concurrently for
+	//!        different faces, as it only writes that face.
+	bool decode(request& r, std::size_t face);
+	//! \brief Copy `data` to the pixel buffer, if used, and leave it bound.
+	//!
+	//! @return the pointer to give to the glTexImage functions
+	void const* stage(void const* data, std::size_t size);
+	void upload(request& r);
+
+	ThreadPool*                           _pool;
+	bool                                  _use_pixel_buffers;
+	GLuint                                _pixel_buffer{0u};
+	std::vector<std::unique_ptr<request>> _requests;   //!< not uploaded yet
+	std::vector<request*>                 _ready;      //!< decoded, guarded by _mutex
+	std::vector<std::future<void>>        _decodes;
+	mutable std::mutex                    _mutex;
+};
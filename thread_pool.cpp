@@ -0,0 +1,114 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+ThreadPool::ThreadPool(unsigned int threads_nb)
+{
+	if (threads_nb == 0u)
+		threads_nb = std::max(std::thread::hardware_concurrency(), 1u);
+
+	_workers.reserve(threads_nb);
+	for (unsigned int i = 0u; i < threads_nb; ++i)
+		_workers.emplace_back([this](){ work(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_condition.notify_all();
+
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+unsigned int
+ThreadPool::get_threads_nb() const
+{
+	return static_cast<unsigned int>(_workers.size());
+}
+
+std::future<void>
+ThreadPool::submit(std::function<void ()> task)
+{
+	auto packaged = std::packaged_task<void ()>(std::move(task));
+	auto future = packaged.get_future();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_tasks.push_back(std::move(packaged));
+	}
+	_condition.notify_one();
+
+	return future;
+}
+
+void
+ThreadPool::parallel_for(std::size_t const begin, std::size_t const end,
+                         std::function<void (std::size_t, std::size_t)> const& body)
+{
+	if (end <= begin)
+		return;
+
+	auto const count = end - begin;
+	auto const chunks_nb = std::min<std::size_t>(count, get_threads_nb());
+	if (chunks_nb <= 1u) {
+		body(begin, end);
+		return;
+	}
+
+	// Spread the remainder over the first chunks, so that they differ by
+	// at most one index.
+	auto const chunk_size = count / chunks_nb;
+	auto const remainder = count % chunks_nb;
+	auto chunk_begin = [&](std::size_t const chunk) {
+		return begin + chunk * chunk_size + std::min(chunk, remainder);
+	};
+
+	auto futures = std::vector<std::future<void>>();
+	futures.reserve(chunks_nb - 1u);
+	for (std::size_t chunk = 0u; chunk + 1u < chunks_nb; ++chunk) {
+		auto const first = chunk_begin(chunk);
+		auto const last = chunk_begin(chunk + 1u);
+		futures.push_back(submit([&body, first, last](){ body(first, last); }));
+	}
+
+	// Wait for every chunk even if one throws, since they all reference
+	// `body`.
+	std::exception_ptr error;
+	try {
+		body(chunk_begin(chunks_nb - 1u), end);
+	} catch (...) {
+		error = std::current_exception();
+	}
+	for (auto& future : futures) {
+		try {
+			future.get();
+		} catch (...) {
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void
+ThreadPool::work()
+{
+	for (;;) {
+		std::packaged_task<void ()> task;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this](){ return _stopping || !_tasks.empty(); });
+			if (_stopping && _tasks.empty())
+				return;
+
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+		task();
+	}
+}
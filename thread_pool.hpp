@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \brief Fixed-size pool of worker threads.
+//!
+//! Tasks are run in submission order by whichever worker is free first.
+//! parallel_for() splits a range into one contiguous chunk per thread,
+//! always the same way for a given range and pool size, so bodies that
+//! write to disjoint slots produce the same output as a serial loop.
+class ThreadPool {
+public:
+	//! \brief Start the workers.
+	//!
+	//! @param [in] threads_nb the number of worker threads; 0 picks one
+	//!             per hardware thread
+	explicit ThreadPool(unsigned int threads_nb = 0u);
+
+	//! \brief Finish the tasks already submitted, then join the workers.
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	//! \brief Number of worker threads.
+	unsigned int get_threads_nb() const;
+
+	//! \brief Queue a task to run on one of the workers.
+	//!
+	//! @param [in] task the function to run
+	//! @return a future becoming ready once the task has run, and
+	//!         rethrowing anything it threw
+	std::future<void> submit(std::function<void ()> task);
+
+	//! \brief Run `body(first, last)` over contiguous chunks covering
+	//!        [begin, end), and wait for all of them.
+	//!
+	//! The calling thread runs the last chunk itself. It must not be a
+	//! worker of this pool, as it could end up waiting on itself.
+	//!
+	//! @param [in] begin the first index of the range
+	//! @param [in] end one past the last index of the range
+	//! @param [in] body the function processing the indices [first, last)
+	void parallel_for(std::size_t begin, std::size_t end,
+	                  std::function<void (std::size_t, std::size_t)> const& body);
+
+private:
+	void work();
+
+	std::vector<std::thread>                   _workers;
+	std::deque<std::packaged_task<void ()>>    _tasks;
+	std::mutex                                 _mutex;
+	std::condition_variable                    _condition;
+	bool                                       _stopping{false};
+};
@@ -0,0 +1,87 @@
+#include "uniform_cache.hpp"
+
+#include <cassert>
+#include <utility>
+
+UniformCache::uniform_id
+UniformCache::declare(std::string name)
+{
+	auto const it = _ids.find(name);
+	if (it != _ids.end())
+		return it->second;
+
+	_ids.emplace(name, _names.size());
+	_names.push_back(std::move(name));
+	return _names.size() - 1u;
+}
+
+UniformCache::block_id
+UniformCache::declare_block(std::string name, GLuint const binding)
+{
+	_block_names.push_back(std::move(name));
+	_block_bindings.push_back(binding);
+	return _block_names.size() - 1u;
+}
+
+GLint
+UniformCache::get_location(GLuint const program, uniform_id const id)
+{
+	assert(id < _names.size());
+	return get_entry(program).locations[id];
+}
+
+bool
+UniformCache::bind_block(GLuint const program, block_id const id)
+{
+	assert(id < _block_names.size());
+	return get_entry(program).has_blocks[id];
+}
+
+void
+UniformCache::invalidate()
+{
+	_programs.clear();
+}
+
+UniformCache::program_entry&
+UniformCache::get_entry(GLuint const program)
+{
+	auto& entry = _programs[program];
+
+	// Resolve whatever was declared since the last lookup.
+	for (auto i = entry.locations.size(); i < _names.size(); ++i)
+		entry.locations.push_back(glGetUniformLocation(program, _names[i].c_str()));
+
+	for (auto i = entry.has_blocks.size(); i < _block_names.size(); ++i) {
+		auto const index = glGetUniformBlockIndex(program, _block_names[i].c_str());
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(program, index, _block_bindings[i]);
+		entry.has_blocks.push_back(index != GL_INVALID_INDEX);
+	}
+
+	return entry;
+}
+
+UniformBuffer::UniformBuffer(GLuint const binding, std::size_t const size) :
+	_binding(binding), _size(size)
+{
+	glGenBuffers(1, &_buffer);
+	assert(_buffer != 0u);
+	glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(_size), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0u);
+	glBindBufferBase(GL_UNIFORM_BUFFER, _binding, _buffer);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	glDeleteBuffers(1, &_buffer);
+}
+
+void
+UniformBuffer::update(void const* data)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(_size), data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0u);
+}
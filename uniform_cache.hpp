@@ -0,0 +1,88 @@
+#pragma once
+
+#include "core/helpers.hpp"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Uniform locations and uniform block bindings, resolved once
+//!        per program rather than on every draw.
+//!
+//! Names are declared once and referred to afterwards by the returned
+//! identifier; declaring a name twice returns the same identifier. The
+//! first lookup for a program resolves every name declared so far for
+//! it, and names declared later get resolved on their first lookup.
+//! Reloading shaders gives programs new names, and old names may be
+//! reused by the driver, so invalidate() has to be called after
+//! ShaderProgramManager::ReloadAllPrograms().
+class UniformCache {
+public:
+	using uniform_id = std::size_t;
+	using block_id = std::size_t;
+
+	//! \brief Declare a uniform to look up.
+	uniform_id declare(std::string name);
+
+	//! \brief Declare a uniform block, and the binding point of the
+	//!        buffer backing it.
+	block_id declare_block(std::string name, GLuint binding);
+
+	//! \brief Location of a uniform in `program`, or -1 if the program
+	//!        does not use it.
+	GLint get_location(GLuint program, uniform_id id);
+
+	//! \brief Bind a block of `program` to its binding point, the first
+	//!        time it is asked for that program.
+	//!
+	//! @return whether `program` declares that block
+	bool bind_block(GLuint program, block_id id);
+
+	//! \brief Forget everything resolved so far.
+	void invalidate();
+
+private:
+	struct program_entry {
+		std::vector<GLint> locations;
+		std::vector<bool>  has_blocks;
+	};
+
+	program_entry& get_entry(GLuint program);
+
+	std::vector<std::string>                    _names;
+	std::unordered_map<std::string, uniform_id> _ids;
+	std::vector<std::string>                    _block_names;
+	std::vector<GLuint>                         _block_bindings;
+	std::unordered_map<GLuint, program_entry>   _programs;
+};
+
+//! \brief Uniform buffer holding a std140 block, updated once per frame
+//!        and shared by every program declaring that block.
+class UniformBuffer {
+public:
+	//! @param [in] binding the binding point to attach the buffer to
+	//! @param [in] size the size of the block, in bytes
+	UniformBuffer(GLuint binding, std::size_t size);
+	~UniformBuffer();
+
+	UniformBuffer(UniformBuffer const&) = delete;
+	UniformBuffer& operator=(UniformBuffer const&) = delete;
+
+	//! \brief Replace the content of the block.
+	void update(void const* data);
+
+	//! \brief Replace the content of the block with a struct laid out
+	//!        following std140.
+	template<typename T>
+	void update(T const& block)
+	{
+		static_assert(sizeof(T) % 16u == 0u, "std140 blocks are padded to a multiple of 16 bytes");
+		update(static_cast<void const*>(&block));
+	}
+
+private:
+	GLuint      _buffer{0u};
+	GLuint      _binding;
+	std::size_t _size;
+};
@@ -0,0 +1,113 @@
+#include "vertex_format.hpp"
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	std::uint32_t pack_snorm(float const value, unsigned int const bits)
+	{
+		auto const max_value = static_cast<float>((1 << (bits - 1u)) - 1);
+		auto const clamped = std::min(std::max(value, -1.0f), 1.0f);
+		auto const quantised = static_cast<std::int32_t>(std::round(clamped * max_value));
+		return static_cast<std::uint32_t>(quantised) & ((1u << bits) - 1u);
+	}
+
+	float unpack_snorm(std::uint32_t const value, unsigned int const bits)
+	{
+		auto const shift = 32u - bits;
+		auto const sign_extended = static_cast<std::int32_t>(value << shift) >> shift;
+		auto const max_value = static_cast<float>((1 << (bits - 1u)) - 1);
+		return std::max(static_cast<float>(sign_extended) / max_value, -1.0f);
+	}
+
+	std::uint16_t pack_unorm16(float const value)
+	{
+		auto const clamped = std::min(std::max(value, 0.0f), 1.0f);
+		return static_cast<std::uint16_t>(std::round(clamped * 65535.0f));
+	}
+
+	glm::vec3 safe_normalize(glm::vec3 const& v)
+	{
+		auto const length = glm::length(v);
+		return length > 0.0f ? v / length : glm::vec3(0.0f);
+	}
+}
+
+std::uint32_t
+vertex_format::pack_snorm_2_10_10_10(glm::vec4 const& v)
+{
+	return (pack_snorm(v.x, 10u) <<  0u)
+	     | (pack_snorm(v.y, 10u) << 10u)
+	     | (pack_snorm(v.z, 10u) << 20u)
+	     | (pack_snorm(v.w,  2u) << 30u);
+}
+
+glm::vec4
+vertex_format::unpack_snorm_2_10_10_10(std::uint32_t const packed)
+{
+	return glm::vec4(unpack_snorm((packed >>  0u) & 0x3ffu, 10u),
+	                 unpack_snorm((packed >> 10u) & 0x3ffu, 10u),
+	                 unpack_snorm((packed >> 20u) & 0x3ffu, 10u),
+	                 unpack_snorm((packed >> 30u) & 0x3u,    2u));
+}
+
+std::vector<vertex_format::packed_vertex>
+vertex_format::pack_interleaved(mesh_builder::cpu_mesh const& mesh)
+{
+	auto packed = std::vector<packed_vertex>(mesh.vertices.size());
+	for (size_t i = 0u; i < packed.size(); ++i) {
+		auto const normal = safe_normalize(mesh.normals[i]);
+		auto const tangent = safe_normalize(mesh.tangents[i]);
+
+		// The handedness tells whether cross(normal, tangent) points
+		// along the binormal or away from it.
+		auto const handedness = glm::dot(glm::cross(normal, tangent), mesh.binormals[i]) < 0.0f ? -1.0f : 1.0f;
+
+		auto& vertex = packed[i];
+		vertex.position = mesh.vertices[i];
+		vertex.texcoord[0] = pack_unorm16(mesh.texcoords[i].x);
+		vertex.texcoord[1] = pack_unorm16(mesh.texcoords[i].y);
+		vertex.normal = pack_snorm_2_10_10_10(glm::vec4(normal, 0.0f));
+		vertex.tangent = pack_snorm_2_10_10_10(glm::vec4(tangent, handedness));
+	}
+
+	return packed;
+}
+
+std::size_t
+vertex_format::vertex_size(vertex_layout const layout)
+{
+	switch (layout) {
+		case vertex_layout::interleaved_packed:
+			return sizeof(packed_vertex);
+		case vertex_layout::planar:
+		default:
+			return 5u * sizeof(glm::vec3);
+	}
+}
+
+vertex_format::memory_report
+vertex_format::compute_memory_report(mesh_builder::cpu_mesh const& mesh)
+{
+	memory_report report;
+	report.vertices_nb = mesh.vertices.size();
+	report.planar_vertex_bytes = report.vertices_nb * vertex_size(vertex_layout::planar);
+	report.packed_vertex_bytes = report.vertices_nb * vertex_size(vertex_layout::interleaved_packed);
+	report.index_bytes = mesh.index_sets.size() * sizeof(glm::uvec3);
+	return report;
+}
+
+void
+vertex_format::log_memory_report(char const* name, mesh_builder::cpu_mesh const& mesh)
+{
+	auto const report = compute_memory_report(mesh);
+	auto const planar_total = report.planar_vertex_bytes + report.index_bytes;
+	auto const packed_total = report.packed_vertex_bytes + report.index_bytes;
+	LogInfo("%s: %zu vertices, vertex data %zu -> %zu bytes (%.1f%% saved), with indices %zu -> %zu bytes",
+	        name, report.vertices_nb,
+	        report.planar_vertex_bytes, report.packed_vertex_bytes,
+	        report.planar_vertex_bytes > 0u ? 100.0 * (1.0 - static_cast<double>(report.packed_vertex_bytes) / static_cast<double>(report.planar_vertex_bytes)) : 0.0,
+	        planar_total, packed_total);
+}
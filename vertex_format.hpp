@@ -0,0 +1,70 @@
+#pragma once
+
+#include "mesh_builder.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! \brief CPU-side vertex layouts that a cpu_mesh can be converted to
+//!        before being uploaded.
+namespace vertex_format
+{
+	//! \brief How the vertex attributes are laid out in the buffer.
+	enum class vertex_layout : unsigned int {
+		planar = 0u,        //!< five float3 arrays stored one after the other
+		interleaved_packed  //!< one packed_vertex per vertex, see below
+	};
+
+	//! \brief Interleaved vertex, 24 bytes instead of the 60 bytes used
+	//!        by the planar layout.
+	//!
+	//! Normals and tangents are stored as signed normalised
+	//! 2_10_10_10 integers, and the texture coordinates as unsigned
+	//! normalised 16-bit integers, so they have to lie in [0, 1].
+	//! The binormal is not stored: the w component of the tangent holds
+	//! the handedness, and shaders should rebuild it as
+	//! `cross(normal, tangent.xyz) * tangent.w`.
+	struct packed_vertex {
+		glm::vec3     position;
+		std::uint16_t texcoord[2];
+		std::uint32_t normal;
+		std::uint32_t tangent;
+	};
+	static_assert(sizeof(packed_vertex) == 24u, "packed_vertex should not contain any padding");
+
+	//! \brief Pack a vector with components in [-1, 1] into a
+	//!        GL_INT_2_10_10_10_REV word.
+	std::uint32_t pack_snorm_2_10_10_10(glm::vec4 const& v);
+
+	//! \brief Inverse of pack_snorm_2_10_10_10(), mostly useful to check
+	//!        the precision of the packed layout.
+	glm::vec4 unpack_snorm_2_10_10_10(std::uint32_t packed);
+
+	//! \brief Convert the planar attributes of a mesh into packed
+	//!        interleaved vertices.
+	std::vector<packed_vertex> pack_interleaved(mesh_builder::cpu_mesh const& mesh);
+
+	//! \brief Size in bytes of a single vertex for the given layout.
+	std::size_t vertex_size(vertex_layout layout);
+
+	//! \brief Size of the vertex and index data of a mesh, once uploaded
+	//!        with the planar layout and with the packed one.
+	struct memory_report {
+		std::size_t vertices_nb{0u};
+		std::size_t planar_vertex_bytes{0u};
+		std::size_t packed_vertex_bytes{0u};
+		std::size_t index_bytes{0u};
+	};
+
+	//! \brief Compute the memory used by a mesh in both layouts.
+	memory_report compute_memory_report(mesh_builder::cpu_mesh const& mesh);
+
+	//! \brief Print a before/after memory report of a mesh to the log.
+	//!
+	//! @param [in] name name to identify the mesh in the log
+	//! @param [in] mesh the mesh to report on
+	void log_memory_report(char const* name, mesh_builder::cpu_mesh const& mesh);
+}